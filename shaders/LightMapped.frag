@@ -0,0 +1,34 @@
+#version 140
+
+out vec4 outColor;
+
+in vec3 outVecTexCoord;
+in vec3 outVecLightmapCoord;
+
+uniform sampler2DArray tex;
+uniform sampler2DArray lightmap;
+
+#if defined( RENDERMODE_TEXTURE ) || defined( RENDERMODE_ADDITIVE )
+uniform float renderAmount;
+#endif
+
+void main()
+{
+	vec4 texColor = texture( tex, outVecTexCoord );
+	
+#ifdef ALPHA_TEST
+	if( texColor.a <= 0.5 )
+	{
+		discard;
+	}
+#endif
+	
+	outColor = texColor * texture( lightmap, outVecLightmapCoord );
+	
+#if defined( RENDERMODE_TEXTURE )
+	outColor.a *= renderAmount;
+#elif defined( RENDERMODE_ADDITIVE )
+	//Blended with GL_ONE, GL_ONE.
+	outColor.rgb *= outColor.a * renderAmount;
+#endif
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include <SDL.h>
 
@@ -14,17 +17,34 @@
 #include "ui/CWindowArgs.h"
 #include "ui/CWindowManager.h"
 
+#include "gl/CGLDiagnostics.h"
+#include "gl/CGPUProfiler.h"
+#include "gl/CGLStateCache.h"
 #include "gl/CShaderManager.h"
 
 #include "gl/CShaderInstance.h"
+#include "gl/CTextureCache.h"
+#include "gl/ShaderFeatures.h"
 
 #include "gl/GLUtil.h"
 
 #include "bsp/BSPIO.h"
 #include "bsp/BSPRenderIO.h"
+#include "bsp/BSPRefrag.h"
+#include "bsp/BSPVis.h"
 
 #include "wad/CWadManager.h"
 
+#include "utility/CFrustum.h"
+#include "utility/CLogger.h"
+#include "utility/CProfiler.h"
+#include "utility/CThreadPool.h"
+
+#include "filesystem/CAsyncFileReader.h"
+#include "filesystem/CFileSystem.h"
+
+#include "bundle/BundleIO.h"
+
 #include "entity/CEntityList.h"
 #include "entity/CBaseEntity.h"
 #include "entity/EntityIO.h"
@@ -34,31 +54,108 @@
 const float CApp::ROTATE_SPEED = 120.0f;
 const float CApp::MOVE_SPEED = 100.0f;
 
+/**
+*	Distance to the far clipping plane.
+*/
+static const float FAR_PLANE = 10000.0f;
+
+/**
+*	Binding that never matches a real texture, used to force the first bind of a frame.
+*/
+static const GLuint INVALID_TEXTURE_BINDING = ~0U;
+
 int CApp::Run( int iArgc, char* pszArgV[] )
 {
+	//Bundle tool: -bundle <map> <output> [-lz4]
+	if( iArgc >= 4 && strcmp( pszArgV[ 1 ], "-bundle" ) == 0 )
+	{
+		return RunBundleTool( pszArgV[ 2 ], pszArgV[ 3 ], iArgc >= 5 && strcmp( pszArgV[ 4 ], "-lz4" ) == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	const char* pszMapName = "hldemo2.bsp";
+
+	//Chrome trace JSON file to write profiling zones to, if any.
+	const char* pszProfileFileName = nullptr;
+
+	//Everything is written from the logger's thread from here on; per frame statistics are verbose messages.
+	g_Logger.Initialize();
+
+	//Idle viewers shouldn't use any CPU, so frames are rendered on demand unless -continuous is given.
+	m_Scheduler.SetOnDemand( true );
+
+	for( int iArg = 1; iArg < iArgc; ++iArg )
+	{
+		if( strcmp( pszArgV[ iArg ], "-map" ) == 0 && iArg + 1 < iArgc )
+			pszMapName = pszArgV[ ++iArg ];
+		else if( strcmp( pszArgV[ iArg ], "-fps" ) == 0 && iArg + 1 < iArgc )
+			m_Scheduler.SetFrameCap( atof( pszArgV[ ++iArg ] ) );
+		else if( strcmp( pszArgV[ iArg ], "-continuous" ) == 0 )
+			m_Scheduler.SetOnDemand( false );
+		else if( strcmp( pszArgV[ iArg ], "-profile" ) == 0 && iArg + 1 < iArgc )
+			pszProfileFileName = pszArgV[ ++iArg ];
+		else if( strcmp( pszArgV[ iArg ], "-log" ) == 0 && iArg + 2 < iArgc )
+		{
+			//-log <category|all> <level>
+			const char* const pszCategory = pszArgV[ ++iArg ];
+			const LogLevel level = CLogger::GetLevelByName( pszArgV[ ++iArg ] );
+
+			if( level == LogLevel::NUM )
+			{
+				g_Logger.Warning( LogCategory::APP, "Unknown log level \"%s\"\n", pszArgV[ iArg ] );
+			}
+			else if( strcasecmp( pszCategory, "all" ) == 0 )
+			{
+				g_Logger.SetLevel( level );
+			}
+			else
+			{
+				const LogCategory category = CLogger::GetCategoryByName( pszCategory );
+
+				if( category != LogCategory::NUM )
+					g_Logger.SetLevel( category, level );
+				else
+					g_Logger.Warning( LogCategory::APP, "Unknown log category \"%s\"\n", pszCategory );
+			}
+		}
+	}
+
+	PROFILE_THREAD_NAME( "Main" );
+
+	if( pszProfileFileName )
+	{
+#ifdef ENABLE_PROFILER
+		//Record from the start so loading is included.
+		g_Profiler.Start();
+#else
+		g_Logger.Warning( LogCategory::APP, "The profiler was compiled out, \"-profile\" is ignored\n" );
+		pszProfileFileName = nullptr;
+#endif
+	}
+
 	bool bSuccess = Initialize();
 
 	if( bSuccess )
 	{
-		printf( "CApp::Initialize succeeded\n" );
+		g_Logger.Info( LogCategory::APP, "CApp::Initialize succeeded\n" );
 
-		g_WadManager.SetBasePath( "external" );
+		g_FileSystem.AddSearchPath( "external" );
 
 		{
-			auto header = LoadBSPFile( "external/hldemo2.bsp" );
+			PROFILE_SCOPE( "Load map" );
+
+			auto data = LoadMapData( pszMapName );
 
-			memset( BSP::mod_known, 0, sizeof( BSP::mod_known ) );
+			BSP::Mod_ClearAll();
 
-			m_pModel = &BSP::mod_known[ 0 ];
-			BSP::mod_numknown = 1;
+			m_pModel = BSP::Mod_FindName( "external/test.bsp" );
 
-			strcpy( m_pModel->name, "external/test.bsp" );
+			m_pViewLeaf = nullptr;
 
-			bSuccess = BSP::LoadBrushModel( m_pModel, header.get() );
+			bSuccess = data.IsValid() && BSP::LoadBrushModel( m_pModel, reinterpret_cast<dheader_t*>( data.GetData() ) );
 
 			if( bSuccess )
 			{
-				printf( "Loaded BSP\n" );
+				g_Logger.Info( LogCategory::APP, "Loaded BSP\n" );
 
 				if( ED_LoadFromFile( m_pModel->entities ) )
 				{
@@ -68,14 +165,14 @@ int CApp::Run( int iArgc, char* pszArgV[] )
 				}
 				else
 				{
-					printf( "Failed to parse entity data\n" );
+					g_Logger.Error( LogCategory::APP, "Failed to parse entity data\n" );
 					bSuccess = false;
 					g_EntList.Clear();
 				}
 			}
 			else
 			{
-				printf( "Couldn't load BSP\n" );
+				g_Logger.Error( LogCategory::APP, "Couldn't load BSP\n" );
 			}
 		}
 
@@ -85,7 +182,10 @@ int CApp::Run( int iArgc, char* pszArgV[] )
 		{
 			m_Camera.RotateYaw( -90.0f );
 
-			printf( "Ready to begin\n" );
+			g_Logger.Info( LogCategory::APP, "Ready to begin\n" );
+
+			//Make sure the prompt is visible before waiting for input.
+			g_Logger.Flush();
 			getchar();
 
 			bSuccess = RunApp();
@@ -94,6 +194,10 @@ int CApp::Run( int iArgc, char* pszArgV[] )
 		}
 
 		BSP::FreeModel( m_pModel );
+
+		//Free cached resources while the context is still around.
+		g_TextureCache.Clear();
+		g_WadManager.Clear();
 	}
 
 	//Fetch any remaining errors.
@@ -101,11 +205,74 @@ int CApp::Run( int iArgc, char* pszArgV[] )
 
 	Shutdown();
 
+	if( pszProfileFileName )
+	{
+		g_Profiler.Stop();
+		g_Profiler.WriteChromeTrace( pszProfileFileName );
+	}
+
+	//Writes all remaining messages.
+	g_Logger.Shutdown();
+
 	getchar();
 
 	return bSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+bool CApp::RunBundleTool( const char* const pszMapName, const char* const pszOutFileName, const bool bCompress )
+{
+	g_FileSystem.AddSearchPath( "external" );
+
+	const bool bSuccess = WriteMapBundle( pszMapName, pszOutFileName, bCompress );
+
+	if( bSuccess )
+		g_Logger.Info( LogCategory::APP, "Wrote bundle \"%s\"\n", pszOutFileName );
+	else
+		g_Logger.Error( LogCategory::APP, "Couldn't write bundle \"%s\"\n", pszOutFileName );
+
+	g_WadManager.Clear();
+	g_FileSystem.Shutdown();
+
+	return bSuccess;
+}
+
+CFileData CApp::LoadMapData( const char* const pszMapName )
+{
+	const size_t uiLength = strlen( pszMapName );
+	const size_t uiExtLength = strlen( BUNDLE_FILE_EXT );
+
+	if( uiLength > uiExtLength && strcasecmp( pszMapName + uiLength - uiExtLength, BUNDLE_FILE_EXT ) == 0 )
+	{
+		CFileData data;
+
+		LoadMapBundle( pszMapName, data );
+
+		return data;
+	}
+
+	//Start reading the BSP, then find out which wads it needs and start reading those as well, so all reads happen at the same time.
+	auto bspData = g_AsyncFileReader.Read( pszMapName );
+
+	{
+		auto entities = LoadBSPEntities( pszMapName );
+
+		char* pszWadList;
+
+		if( entities && BSP::FindWadList( entities.get(), pszWadList ) )
+		{
+			std::vector<std::string> wadNames;
+
+			BSP::GetWadNames( pszWadList, wadNames );
+
+			delete[] pszWadList;
+
+			g_WadManager.PrefetchWads( wadNames );
+		}
+	}
+
+	return LoadBSPFile( pszMapName, bspData.get() );
+}
+
 bool CApp::Initialize()
 {
 	bool bSuccess = g_WindowManager.Initialize();
@@ -121,14 +288,42 @@ bool CApp::Initialize()
 	{
 		g_WindowManager.MakeGLCurrent( m_pWindow );
 
+		//Not fatal; errors just won't be reported.
+		g_GLDiagnostics.Initialize();
+
+		//Not fatal either; GPU time just won't be measured.
+		g_GPUProfiler.Initialize();
+
 		bSuccess = g_ShaderManager.LoadShaders();
 	}
 
+	if( bSuccess )
+	{
+		bSuccess = g_AsyncFileReader.Initialize();
+	}
+
+	if( bSuccess )
+	{
+		bSuccess = g_ThreadPool.Initialize();
+	}
+
 	return bSuccess;
 }
 
 void CApp::Shutdown()
 {
+	g_ShaderManager.Shutdown();
+
+	g_ThreadPool.Shutdown();
+
+	g_AsyncFileReader.Shutdown();
+
+	g_FileSystem.Shutdown();
+
+	g_GPUProfiler.Shutdown();
+
+	g_GLDiagnostics.Shutdown();
+
 	g_WindowManager.DestroyWindow( m_pWindow );
 	m_pWindow = nullptr;
 
@@ -150,11 +345,24 @@ bool CApp::RunApp()
 
 	check_gl_error();
 
+	SetupScheduler();
+
+	m_Scheduler.Start();
+
 	//While application is running
 	while( !quit )
 	{
+		//Sleep until an event arrives or the next frame or update is due.
+		const int iTimeout = m_Scheduler.GetWaitTimeout();
+
+		bool bHasEvent = ( iTimeout == CFrameScheduler::WAIT_FOREVER ? SDL_WaitEvent( &e ) : SDL_WaitEventTimeout( &e, iTimeout ) ) != 0;
+
+		//Nothing moved while idle; catching up would apply input that arrives now to the whole idle period.
+		if( iTimeout == CFrameScheduler::WAIT_FOREVER )
+			m_Scheduler.Resume();
+
 		//Handle events on queue
-		while( SDL_PollEvent( &e ) != 0 )
+		for( ; bHasEvent; bHasEvent = SDL_PollEvent( &e ) != 0 )
 		{
 			if( e.type == SDL_WINDOWEVENT )
 			{
@@ -174,54 +382,101 @@ bool CApp::RunApp()
 				quit = true;
 			}
 
+			//A key that is pressed and released before the next update would have no effect, so update once before releasing it.
+			if( e.type == SDL_KEYUP && m_bKeyPressedSinceUpdate )
+			{
+				m_Scheduler.BorrowTick();
+
+				Update( static_cast<float>( m_Scheduler.GetTickInterval() ) );
+			}
+
+			if( e.type == SDL_KEYDOWN )
+				m_bKeyPressedSinceUpdate = true;
+
 			Event( e );
-		}
 
-		std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now().time_since_epoch() );
+			//Mouse motion isn't used.
+			if( e.type != SDL_MOUSEMOTION )
+				m_Scheduler.RequestRender();
+		}
 
-		const auto diff = ( now - m_LastTick ).count();
+		for( size_t uiTick = m_Scheduler.BeginFrame(); uiTick > 0; --uiTick )
+		{
+			Update( static_cast<float>( m_Scheduler.GetTickInterval() ) );
+		}
 
-		//Frame limit
-		if( diff >= ( 1 / 60.0f ) )
+		if( !quit && m_Scheduler.ShouldRender() )
 		{
-			m_flDeltaTime = diff / 1000.0f;
+			const bool bAnimated = Render();
 
-			printf( "delta: %f\n", m_flDeltaTime );
+			m_Scheduler.FrameRendered();
 
-			if( m_flDeltaTime > 1.0f )
-				m_flDeltaTime = 0.0f;
+			//Keep rendering while the scene or the camera moves.
+			m_Scheduler.SetAnimating( bAnimated || m_flYawVel || m_flPitchVel );
+		}
+	}
 
-			printf( "delta: %f\n", m_flDeltaTime );
+	return true;
+}
 
-			m_LastTick = now;
+void CApp::SetupScheduler()
+{
+	int iRefreshRate = 0;
 
-			if( m_flYawVel )
-				m_Camera.RotateYaw( m_flDeltaTime * m_flYawVel );
+	const int iDisplay = SDL_GetWindowDisplayIndex( m_pWindow->GetSDLWindow() );
 
-			if( m_flPitchVel )
-				m_Camera.RotatePitch( m_flDeltaTime * m_flPitchVel );
+	SDL_DisplayMode mode;
 
-			Render();
-		}
+	if( iDisplay >= 0 && SDL_GetCurrentDisplayMode( iDisplay, &mode ) == 0 )
+		iRefreshRate = mode.refresh_rate;
+
+	const bool bVSync = SDL_GL_GetSwapInterval() != 0;
+
+	m_Scheduler.SetVSync( bVSync, iRefreshRate );
+
+	//Without vsync nothing else keeps an uncapped loop from using an entire core.
+	if( !bVSync && m_Scheduler.GetFrameCap() <= 0 )
+	{
+		g_Logger.Warning( LogCategory::APP, "VSync is not active, capping frames to %.0f per second\n", m_Scheduler.GetTickRate() );
+
+		m_Scheduler.SetFrameCap( m_Scheduler.GetTickRate() );
 	}
 
-	return true;
+	g_Logger.Info( LogCategory::APP, "Frame scheduling: %s, %d Hz refresh, vsync %s, frame cap %.0f\n",
+		m_Scheduler.IsOnDemand() ? "on demand" : "continuous", iRefreshRate, bVSync ? "on" : "off", m_Scheduler.GetFrameCap() );
 }
 
-void CApp::Render()
+void CApp::Update( const float flInterval )
 {
-	check_gl_error();
+	m_bKeyPressedSinceUpdate = false;
 
-	//Depth testing prevents objects that are further away from drawing on top of nearer objects
-	glEnable( GL_DEPTH_TEST );
+	if( m_flYawVel )
+		m_Camera.RotateYaw( flInterval * m_flYawVel );
 
-	check_gl_error();
+	if( m_flPitchVel )
+		m_Camera.RotatePitch( flInterval * m_flPitchVel );
+}
 
-	//Cull back faces
-	glEnable( GL_CULL_FACE );
+bool CApp::Render()
+{
+	PROFILE_FUNCTION();
 
 	check_gl_error();
 
+	g_GLState.BeginFrame();
+
+	g_GLDiagnostics.BeginFrame();
+
+	g_GPUProfiler.BeginFrame();
+
+	GLDIAG_GROUP( "Render frame" );
+
+	//Depth testing prevents objects that are further away from drawing on top of nearer objects
+	g_GLState.Enable( GL_DEPTH_TEST );
+
+	//Cull back faces
+	g_GLState.Enable( GL_CULL_FACE );
+
 	glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT );
 
@@ -240,7 +495,7 @@ void CApp::Render()
 
 	const float flAspect = static_cast<float>( width ) / static_cast<float>( height );
 
-	auto projection = glm::perspective( glm::radians( 75.0f ), flAspect, 0.1f, 10000.0f );
+	auto projection = glm::perspective( glm::radians( 75.0f ), flAspect, 0.1f, FAR_PLANE );
 
 	glm::mat4x4 view;
 	
@@ -252,47 +507,128 @@ void CApp::Render()
 
 	view = m_Camera.GetViewMatrix();
 
-	glm::mat4x4 model = glm::mat4x4();
+	g_ShaderManager.SetFrameData( projection, view, static_cast<float>( m_Scheduler.GetTime() ) );
 
-	std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now().time_since_epoch() );
+	CFrustum frustum;
 
-	size_t uiCount = 0;
+	frustum.Update( projection * view );
 
-	size_t uiTriangles = 0;
+	const auto start = std::chrono::steady_clock::now();
 
-	double flTotal = 0;
+	RenderStats_t stats;
 
-	for( CBaseEntity* pEntity = g_EntList.GetFirstEntity(); pEntity; pEntity = g_EntList.GetNextEntity( pEntity ) )
+	m_RenderQueue.Begin( FAR_PLANE );
+
+	//The potentially visible set only changes when the camera enters another leaf.
+	mleaf_t* pViewLeaf = BSP::Mod_PointInLeaf( m_Camera.GetPosition(), m_pModel );
+
+	if( pViewLeaf != m_pViewLeaf )
 	{
-		if( auto pModel = pEntity->GetBrushModel() )
+		PROFILE_SCOPE( "Mark leaves" );
+
+		m_pViewLeaf = pViewLeaf;
+
+		BSP::R_MarkLeaves( pViewLeaf, m_pModel, ++m_iVisFrame );
+	}
+
+	{
+		PROFILE_SCOPE( "Cull entities" );
+
+		for( CBaseEntity* pEntity = g_EntList.GetFirstEntity(); pEntity; pEntity = g_EntList.GetNextEntity( pEntity ) )
 		{
-			//TODO: Should tidy up these parameters. - Solokiller
-			RenderModel( projection, view, model, pEntity, *pModel, uiCount, uiTriangles, flTotal );
+			if( auto pModel = pEntity->GetBrushModel() )
+			{
+				//The world is always drawn; other brush models only if they're in the view and in a visible leaf.
+				if( pModel != m_pModel )
+				{
+					//The radius is measured from the model origin, so it bounds the model in any orientation.
+					if( !frustum.IsSphereInside( pEntity->GetOrigin(), pModel->radius ) )
+					{
+						++stats.uiFrustumCulled;
+						continue;
+					}
+
+					BSP::R_CheckEfrags( pEntity, m_pModel );
+
+					if( !BSP::R_IsEntityVisible( pEntity, m_iVisFrame ) )
+					{
+						++stats.uiPVSCulled;
+						continue;
+					}
+				}
+
+				AddModelSurfaces( pEntity, *pModel );
+			}
 		}
 	}
 
-	std::chrono::milliseconds now2 = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now().time_since_epoch() );
+	DrawRenderQueue( stats );
+
+	//Draw calls only queue commands; this is CPU time. Use -profile for a breakdown.
+	const double flMilliseconds = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	g_Logger.Verbose( LogCategory::RENDER, "CPU time spent rendering frame (%u polygons, %u triangles, %u entities culled (%u frustum, %u PVS)): %.3f msec\n",
+		stats.uiPolygons, stats.uiTriangles, stats.uiFrustumCulled + stats.uiPVSCulled, stats.uiFrustumCulled, stats.uiPVSCulled, flMilliseconds );
+
+	g_Logger.Verbose( LogCategory::RENDER, "State changes (sorted/unsorted): shaders %u/%u, textures %u/%u, lightmaps %u/%u\n",
+		stats.uiShaderChanges, stats.uiUnsortedShaderChanges,
+		stats.uiTextureBinds, stats.uiUnsortedTextureBinds,
+		stats.uiLightmapBinds, stats.uiUnsortedLightmapBinds );
+
+	g_Logger.Verbose( LogCategory::RENDER, "GL state calls: %u issued, %u dropped; %u draw calls; %u GL errors\n",
+		g_GLState.GetIssuedCalls(), g_GLState.GetDroppedCalls(), stats.uiDrawCalls, g_GLDiagnostics.GetFrameErrors() );
+
+	//GPU results are from an earlier frame, so they're only comparable to the CPU time if the scene hasn't changed much.
+	if( g_GPUProfiler.HasResults() )
+	{
+		g_Logger.Verbose( LogCategory::RENDER, "GPU time spent rendering frame (%u frames ago, %u frames without results): %.3f msec\n",
+			CGPUProfiler::NUM_QUERY_FRAMES, g_GPUProfiler.GetNumDroppedFrames(), g_GPUProfiler.GetFrameTime() );
+
+		for( size_t uiIndex = 0; uiIndex < g_GPUProfiler.GetNumZoneResults(); ++uiIndex )
+		{
+			const auto& result = g_GPUProfiler.GetZoneResult( uiIndex );
 
-	printf( "Time spent rendering frame (%u polygons, %u triangles, average (msec): %f): %f\n", uiCount, uiTriangles, flTotal / uiCount, ( now2 - now ).count() / 1000.0f );
+			g_Logger.Verbose( LogCategory::RENDER, "\t%s: %.3f msec\n", result.pszName, result.flMilliseconds );
+		}
+	}
 
 	//Unbind program
 	g_ShaderManager.DeactivateActiveShader();
 
 	check_gl_error();
 
+	g_GPUProfiler.EndFrame();
+
 	//Update screen
-	m_pWindow->SwapGLBuffers();
+	{
+		PROFILE_SCOPE( "Swap buffers" );
+
+		m_pWindow->SwapGLBuffers();
+	}
 
 	check_gl_error();
+
+	return stats.bAnimated;
 }
 
-void CApp::RenderModel( const glm::mat4x4& projection, const glm::mat4x4& view, const glm::mat4x4& model, const CBaseEntity* pEntity, bmodel_t& brushModel, size_t& uiCount, size_t& uiTriangles, double& flTotal )
+void CApp::AddModelSurfaces( CBaseEntity* pEntity, bmodel_t& brushModel )
 {
-	msurface_t* pSurface = brushModel.surfaces + brushModel.firstmodelsurface;
+	const glm::mat4x4& model = pEntity->GetModelMatrix();
+
+	const glm::vec3& vecViewOrigin = m_Camera.GetPosition();
+
+	//Blending render modes are drawn with a permutation of the texture's shader.
+	uint32_t uiRenderModeFeatures = 0;
+
+	if( pEntity->GetRenderMode() == RenderMode::TEXTURE )
+		uiRenderModeFeatures = SHADER_FEATURE_RENDERMODE_TEXTURE;
+	else if( pEntity->GetRenderMode() == RenderMode::ADDITIVE )
+		uiRenderModeFeatures = SHADER_FEATURE_RENDERMODE_ADDITIVE;
 
-	CShaderInstance* pShader;
+	const bool bBlended = uiRenderModeFeatures != 0;
+
+	msurface_t* pSurface = brushModel.surfaces + brushModel.firstmodelsurface;
 
-	//TODO: need to sort transparent surfaces - Solokiller
 	for( int iIndex = 0; iIndex < brushModel.nummodelsurfaces; ++iIndex, ++pSurface )
 	{
 		//Sky, origin, aaatrigger, etc. Don't draw these.
@@ -300,56 +636,197 @@ void CApp::RenderModel( const glm::mat4x4& projection, const glm::mat4x4& view,
 		if( pSurface->texinfo->flags & TEX_SPECIAL )
 			continue;
 
-		pShader = pSurface->texinfo->texture->pShader;
+		const texture_t* pTexture = pSurface->texinfo->texture;
 
-		g_ShaderManager.ActivateShader( pShader, projection, view, model, pEntity );
+		if( !pTexture || !pSurface->polys )
+			continue;
 
-		glActiveTexture( GL_TEXTURE0 + 1 );
+		CShaderInstance* pShader = pTexture->pShader;
 
-		check_gl_error();
+		if( uiRenderModeFeatures )
+			pShader = g_ShaderManager.GetPermutation( pShader->GetShader(), pShader->GetFeatures() | uiRenderModeFeatures );
 
-		//Skies will have no texture here.
-		glBindTexture( GL_TEXTURE_2D, pSurface->lightmaptexturenum );
+		RenderPass pass = RenderPass::NORMAL;
 
-		check_gl_error();
+		if( bBlended )
+			pass = RenderPass::BLENDED;
+		else if( pTexture->name[ 0 ] == '{' )
+			pass = RenderPass::ALPHATEST;
+		else if( pTexture->name[ 0 ] == '!' )
+			pass = RenderPass::WATER;
 
-		glActiveTexture( GL_TEXTURE0 + 0 );
+		//Sort on the distance to the center of the surface's first polygon.
+		const glpoly_t* pPoly = pSurface->polys;
 
-		check_gl_error();
+		glm::vec3 vecCenter( 0.0f );
 
-		for( glpoly_t* pPoly = pSurface->polys; pPoly; pPoly = pPoly->chain )
+		for( int iVert = 0; iVert < pPoly->numverts; ++iVert )
 		{
-			if( pSurface->texinfo->texture )
-				glBindTexture( GL_TEXTURE_2D, pSurface->texinfo->texture->gl_texturenum );
-			else
-				glBindTexture( GL_TEXTURE_2D, 0 );
+			vecCenter += glm::vec3( pPoly->verts[ iVert ][ 0 ], pPoly->verts[ iVert ][ 1 ], pPoly->verts[ iVert ][ 2 ] );
+		}
 
-			check_gl_error();
+		if( pPoly->numverts > 0 )
+			vecCenter *= 1.0f / pPoly->numverts;
 
-			for( glpoly_t* pPoly2 = pPoly; pPoly2; pPoly2 = pPoly2->next )
-			{
-				std::chrono::milliseconds start = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now().time_since_epoch() );
+		vecCenter = glm::vec3( model * glm::vec4( vecCenter, 1.0f ) );
 
-				glBindBuffer( GL_ARRAY_BUFFER, pPoly2->VBO );
+		m_RenderQueue.Add(
+			pass, pShader, pTexture->gl_texturenum, pSurface->lightmaptexturenum,
+			glm::distance( vecViewOrigin, vecCenter ), pSurface, pEntity );
+	}
+}
 
-				check_gl_error();
+void CApp::DrawRenderQueue( RenderStats_t& stats )
+{
+	GLDIAG_GROUP( "Draw render queue" );
 
-				pShader->SetupVertexAttribs();
+	{
+		PROFILE_SCOPE( "Sort render queue" );
+
+		m_RenderQueue.Sort();
+	}
 
-				check_gl_error();
+	PROFILE_SCOPE( "Submit render queue" );
 
-				pShader->Draw( pPoly2->numverts );
+	//Nothing is known to be bound at the start of a frame.
+	CShaderInstance* pBoundShader = nullptr;
+	const CBaseEntity* pBoundEntity = nullptr;
+	GLuint boundTexture = INVALID_TEXTURE_BINDING;
+	GLuint boundLightmap = INVALID_TEXTURE_BINDING;
+	GLuint boundVAO = 0;
 
-				++uiCount;
+	m_BatchFirsts.clear();
+	m_BatchCounts.clear();
 
-				uiTriangles += pPoly2->numverts - 2;
+	bool bDepthWrite = true;
 
-				std::chrono::milliseconds end = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now().time_since_epoch() );
+	RenderPass currentPass = RenderPass::NUM;
 
-				flTotal += ( end - start ).count();
+	for( const auto& item : m_RenderQueue.GetItems() )
+	{
+		msurface_t* pSurface = item.pSurface;
+		CBaseEntity* pEntity = item.pEntity;
+
+		const texture_t* pTexture = pSurface->texinfo->texture;
+
+		CShaderInstance* pShader = item.pShader;
+
+		if( pShader->GetFeatures() & SHADER_FEATURE_WARP )
+			stats.bAnimated = true;
+
+		const RenderPass pass = CRenderQueue::GetPass( item.uiKey );
+
+		//Blended surfaces are sorted back to front and must not occlude each other.
+		const bool bBlended = pass == RenderPass::BLENDED;
+
+		//All polygons share one vertex buffer and the texture layers are vertex data,
+		//so polygons can be batched until any state changes.
+		if( pass != currentPass || bBlended == bDepthWrite ||
+			pShader != pBoundShader || pEntity != pBoundEntity ||
+			pTexture->gl_texturenum != boundTexture ||
+			pSurface->lightmaptexturenum != boundLightmap )
+		{
+			FlushBatch( pBoundShader, stats );
+		}
+
+		if( pass != currentPass )
+		{
+			currentPass = pass;
+
+			GLDIAG_MARKER( GetRenderPassName( pass ) );
+
+			g_GPUProfiler.EndZone();
+			g_GPUProfiler.BeginZone( GetRenderPassName( pass ) );
+		}
+
+		if( bBlended == bDepthWrite )
+		{
+			bDepthWrite = !bBlended;
+
+			g_GLState.DepthMask( bDepthWrite ? GL_TRUE : GL_FALSE );
+		}
+
+		//Render modes are applied when activating the shader for an entity, so switching entities activates it again.
+		if( pShader != pBoundShader || pEntity != pBoundEntity )
+		{
+			g_ShaderManager.ActivateShader( pShader, pEntity->GetModelMatrix(), pEntity );
+
+			if( pShader != pBoundShader )
+				++stats.uiShaderChanges;
+
+			pBoundShader = pShader;
+			pBoundEntity = pEntity;
+		}
+
+		if( pTexture->gl_texturenum != boundTexture )
+		{
+			g_GLState.BindTexture( 0, GL_TEXTURE_2D_ARRAY, pTexture->gl_texturenum );
+
+			boundTexture = pTexture->gl_texturenum;
+
+			++stats.uiTextureBinds;
+		}
+
+		//Skies will have no texture here.
+		if( pSurface->lightmaptexturenum != boundLightmap )
+		{
+			g_GLState.BindTexture( 1, GL_TEXTURE_2D_ARRAY, pSurface->lightmaptexturenum );
+
+			boundLightmap = pSurface->lightmaptexturenum;
+
+			++stats.uiLightmapBinds;
+		}
+
+		++stats.uiUnsortedShaderChanges;
+		++stats.uiUnsortedLightmapBinds;
+
+		for( glpoly_t* pPoly = pSurface->polys; pPoly; pPoly = pPoly->chain )
+		{
+			++stats.uiUnsortedTextureBinds;
+
+			for( glpoly_t* pPoly2 = pPoly; pPoly2; pPoly2 = pPoly2->next )
+			{
+				if( pPoly2->VAO != boundVAO )
+				{
+					FlushBatch( pShader, stats );
+
+					g_GLState.BindVertexArray( pPoly2->VAO );
+
+					boundVAO = pPoly2->VAO;
+				}
+
+				m_BatchFirsts.push_back( pPoly2->firstvert );
+				m_BatchCounts.push_back( pPoly2->numverts );
+
+				++stats.uiPolygons;
+
+				stats.uiTriangles += pPoly2->numverts - 2;
 			}
 		}
 	}
+
+	FlushBatch( pBoundShader, stats );
+
+	g_GPUProfiler.EndZone();
+
+	//Depth writes must be enabled to clear the depth buffer.
+	if( !bDepthWrite )
+	{
+		g_GLState.DepthMask( GL_TRUE );
+	}
+}
+
+void CApp::FlushBatch( CShaderInstance* pShader, RenderStats_t& stats )
+{
+	if( m_BatchFirsts.empty() )
+		return;
+
+	pShader->Draw( m_BatchFirsts.data(), m_BatchCounts.data(), m_BatchFirsts.size() );
+
+	++stats.uiDrawCalls;
+
+	m_BatchFirsts.clear();
+	m_BatchCounts.clear();
 }
 
 void CApp::Event( const SDL_Event& event )
@@ -2,6 +2,7 @@
 #define APP_CAPP_H
 
 #include <chrono>
+#include <vector>
 
 #include <SDL.h>
 
@@ -9,11 +10,53 @@
 
 #include "bsp/BSPRenderDefs.h"
 
+#include "filesystem/CFileData.h"
+
+#include "gl/CRenderQueue.h"
+
 #include "utility/CCamera.h"
 
+#include "CFrameScheduler.h"
+
 class CWindow;
 class CBaseEntity;
 
+/**
+*	Rendering statistics for a single frame.
+*/
+struct RenderStats_t
+{
+	size_t uiPolygons = 0;
+	size_t uiTriangles = 0;
+
+	size_t uiFrustumCulled = 0;
+	size_t uiPVSCulled = 0;
+
+	/**
+	*	State changes made when drawing the sorted render queue.
+	*/
+	size_t uiShaderChanges = 0;
+	size_t uiTextureBinds = 0;
+	size_t uiLightmapBinds = 0;
+
+	/**
+	*	Number of draw calls. Consecutive polygons that share all state are drawn with a single call.
+	*/
+	size_t uiDrawCalls = 0;
+
+	/**
+	*	Whether anything that was drawn animates over time.
+	*/
+	bool bAnimated = false;
+
+	/**
+	*	State changes that would have been made when drawing surfaces in file order, binding everything for every surface.
+	*/
+	size_t uiUnsortedShaderChanges = 0;
+	size_t uiUnsortedTextureBinds = 0;
+	size_t uiUnsortedLightmapBinds = 0;
+};
+
 /**
 *	App class.
 */
@@ -46,6 +89,22 @@ private:
 	*/
 	bool Initialize();
 
+	/**
+	*	Writes a map bundle.
+	*	@param pszMapName Name of the map to bundle.
+	*	@param pszOutFileName Name of the bundle file to write.
+	*	@param bCompress Whether to compress the bundle.
+	*	@return true on success, false otherwise.
+	*/
+	bool RunBundleTool( const char* const pszMapName, const char* const pszOutFileName, const bool bCompress );
+
+	/**
+	*	Loads the data for a map. Maps can be BSP files or bundles.
+	*	@param pszMapName Name of the map.
+	*	@return BSP file data. Not valid if the map could not be loaded.
+	*/
+	CFileData LoadMapData( const char* const pszMapName );
+
 	/**
 	*	Shuts down the app and cleans up resources.
 	*	Should be called even if Initialize returned false.
@@ -58,15 +117,37 @@ private:
 	*/
 	bool RunApp();
 
+	/**
+	*	Configures the frame scheduler for the window's display.
+	*/
+	void SetupScheduler();
+
+	/**
+	*	Runs a single fixed timestep update.
+	*	@param flInterval Length of the update, in seconds.
+	*/
+	void Update( const float flInterval );
+
 	/**
 	*	Renders a frame.
+	*	@return Whether anything that was drawn animates over time.
 	*/
-	void Render();
+	bool Render();
 
 	/**
-	*	Renders a single model.
+	*	Adds the surfaces of an entity's brush model to the render queue.
 	*/
-	void RenderModel( const glm::mat4x4& projection, const glm::mat4x4& view, const glm::mat4x4& model, const CBaseEntity* pEntity, bmodel_t& brushModel, size_t& uiCount, size_t& uiTriangles, double& flTotal );
+	void AddModelSurfaces( CBaseEntity* pEntity, bmodel_t& brushModel );
+
+	/**
+	*	Sorts and draws the render queue. State that is still bound is not bound again.
+	*/
+	void DrawRenderQueue( RenderStats_t& stats );
+
+	/**
+	*	Draws the polygons that have been batched so far with the given shader.
+	*/
+	void FlushBatch( CShaderInstance* pShader, RenderStats_t& stats );
 
 	void Event( const SDL_Event& event );
 
@@ -83,15 +164,36 @@ private:
 
 	bmodel_t* m_pModel;
 
+	/**
+	*	Leaf that the camera was in when the visible leafs were last marked.
+	*/
+	mleaf_t* m_pViewLeaf = nullptr;
+
+	/**
+	*	Incremented every time the visible leafs are marked.
+	*/
+	int m_iVisFrame = 0;
+
+	CRenderQueue m_RenderQueue;
+
+	/**
+	*	Vertex ranges of the polygons in the current batch. Kept around to avoid allocating every frame.
+	*/
+	std::vector<GLint> m_BatchFirsts;
+	std::vector<GLsizei> m_BatchCounts;
+
 	CCamera m_Camera;
 
-	std::chrono::milliseconds m_StartTime = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::high_resolution_clock::now().time_since_epoch() );
-	std::chrono::milliseconds m_LastTick;
-	std::chrono::milliseconds m_LastFPSCheck;
-	float m_flDeltaTime = 0;
+	CFrameScheduler m_Scheduler;
+
 	float m_flYawVel = 0;
 	float m_flPitchVel = 0;
 
+	/**
+	*	Whether a key was pressed since the last update.
+	*/
+	bool m_bKeyPressedSinceUpdate = false;
+
 private:
 	CApp( const CApp& ) = delete;
 	CApp& operator=( const CApp& ) = delete;
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "CFrameScheduler.h"
+
+const double CFrameScheduler::DEFAULT_TICK_RATE = 60.0;
+
+void CFrameScheduler::SetTickRate( const double flTickRate )
+{
+	assert( flTickRate > 0 );
+
+	m_flTickRate = flTickRate;
+}
+
+void CFrameScheduler::SetVSync( const bool bVSync, const double flRefreshRate )
+{
+	m_bVSync = bVSync;
+	m_flRefreshRate = flRefreshRate;
+}
+
+void CFrameScheduler::Start()
+{
+	m_StartTime = Clock_t::now();
+	m_FrameTime = m_StartTime;
+	m_LastRenderTime = m_StartTime - std::chrono::hours( 1 );
+
+	m_flAccumulator = 0;
+	m_uiTicks = 0;
+
+	m_bRenderRequested = true;
+}
+
+double CFrameScheduler::GetTime() const
+{
+	return std::chrono::duration<double>( m_FrameTime - m_StartTime ).count();
+}
+
+int CFrameScheduler::GetWaitTimeout() const
+{
+	const auto nextFrame = m_LastRenderTime + std::chrono::duration_cast<Clock_t::duration>( std::chrono::duration<double>( GetFrameInterval() ) );
+
+	if( !m_bOnDemand || m_bRenderRequested )
+		return GetMillisecondsUntil( nextFrame );
+
+	if( m_bAnimating )
+	{
+		//Wake up for the next update tick, but not before the next frame is allowed.
+		const auto nextTick = m_FrameTime + std::chrono::duration_cast<Clock_t::duration>( std::chrono::duration<double>( GetTickInterval() - m_flAccumulator ) );
+
+		return GetMillisecondsUntil( std::max( nextTick, nextFrame ) );
+	}
+
+	return WAIT_FOREVER;
+}
+
+void CFrameScheduler::Resume()
+{
+	m_FrameTime = Clock_t::now();
+	m_flAccumulator = 0;
+}
+
+void CFrameScheduler::BorrowTick()
+{
+	m_flAccumulator -= GetTickInterval();
+}
+
+size_t CFrameScheduler::BeginFrame()
+{
+	const auto now = Clock_t::now();
+
+	m_flAccumulator += std::chrono::duration<double>( now - m_FrameTime ).count();
+
+	m_FrameTime = now;
+
+	const double flInterval = GetTickInterval();
+
+	m_uiTicks = m_flAccumulator > 0 ? static_cast<size_t>( m_flAccumulator / flInterval ) : 0;
+
+	if( m_uiTicks > MAX_TICKS_PER_FRAME )
+	{
+		m_uiTicks = MAX_TICKS_PER_FRAME;
+		m_flAccumulator = 0;
+	}
+	else
+	{
+		m_flAccumulator -= m_uiTicks * flInterval;
+	}
+
+	return m_uiTicks;
+}
+
+bool CFrameScheduler::ShouldRender() const
+{
+	if( m_bOnDemand && !m_bRenderRequested && !( m_bAnimating && m_uiTicks > 0 ) )
+		return false;
+
+	const double flFrameInterval = GetFrameInterval();
+
+	return flFrameInterval <= 0 || std::chrono::duration<double>( m_FrameTime - m_LastRenderTime ).count() >= flFrameInterval;
+}
+
+void CFrameScheduler::FrameRendered()
+{
+	m_LastRenderTime = m_FrameTime;
+
+	m_bRenderRequested = false;
+}
+
+double CFrameScheduler::GetFrameInterval() const
+{
+	if( m_flFrameCap <= 0 )
+		return 0;
+
+	//Swapping buffers already waits for the refresh; sleeping as well would only miss refreshes.
+	if( m_bVSync && m_flRefreshRate > 0 && m_flFrameCap >= m_flRefreshRate )
+		return 0;
+
+	return 1.0 / m_flFrameCap;
+}
+
+int CFrameScheduler::GetMillisecondsUntil( const Clock_t::time_point& time ) const
+{
+	const double flMilliseconds = std::chrono::duration<double, std::milli>( time - Clock_t::now() ).count();
+
+	if( flMilliseconds <= 0 )
+		return 0;
+
+	return static_cast<int>( std::ceil( flMilliseconds ) );
+}
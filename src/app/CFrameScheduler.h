@@ -0,0 +1,175 @@
+#ifndef APP_CFRAMESCHEDULER_H
+#define APP_CFRAMESCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+
+/**
+*	Decides when the main loop updates, renders and sleeps.
+*	Updates run at a fixed timestep, independent of the frame rate. Frames can be capped, in which case the loop sleeps
+*	until the next frame is due instead of spinning. If vsync paces frames already, the cap is only applied when it is lower
+*	than what vsync allows.
+*	In on demand mode, frames are only rendered after a render request (input) or, while something animates, once per update tick.
+*	When nothing is pending, the loop sleeps until the next event.
+*/
+class CFrameScheduler final
+{
+public:
+	typedef std::chrono::steady_clock Clock_t;
+
+	/**
+	*	Default number of updates per second.
+	*/
+	static const double DEFAULT_TICK_RATE;
+
+	/**
+	*	Maximum number of updates run in one frame. Time beyond that is dropped, so a stall doesn't cause a burst of updates.
+	*/
+	static const size_t MAX_TICKS_PER_FRAME = 5;
+
+	/**
+	*	Returned by GetWaitTimeout if the loop can sleep until the next event.
+	*/
+	static const int WAIT_FOREVER = -1;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CFrameScheduler() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CFrameScheduler() = default;
+
+	double GetTickRate() const { return m_flTickRate; }
+
+	/**
+	*	Sets the number of updates per second.
+	*/
+	void SetTickRate( const double flTickRate );
+
+	/**
+	*	@return Interval between updates, in seconds.
+	*/
+	double GetTickInterval() const { return 1.0 / m_flTickRate; }
+
+	double GetFrameCap() const { return m_flFrameCap; }
+
+	/**
+	*	Sets the maximum number of frames per second. 0 to disable.
+	*/
+	void SetFrameCap( const double flFrameCap ) { m_flFrameCap = flFrameCap; }
+
+	/**
+	*	Tells the scheduler whether buffer swaps wait for vertical sync, and the refresh rate if known (0 if not).
+	*/
+	void SetVSync( const bool bVSync, const double flRefreshRate );
+
+	bool IsOnDemand() const { return m_bOnDemand; }
+
+	void SetOnDemand( const bool bOnDemand ) { m_bOnDemand = bOnDemand; }
+
+	/**
+	*	Sets whether something is animating. In on demand mode, animating scenes are rendered once per update tick.
+	*/
+	void SetAnimating( const bool bAnimating ) { m_bAnimating = bAnimating; }
+
+	/**
+	*	Requests that the next frame is rendered. Used in on demand mode.
+	*/
+	void RequestRender() { m_bRenderRequested = true; }
+
+	/**
+	*	Starts the clock.
+	*/
+	void Start();
+
+	/**
+	*	@return Time since Start was called, in seconds.
+	*/
+	double GetTime() const;
+
+	/**
+	*	@return How long the main loop can wait for events, in milliseconds, or WAIT_FOREVER.
+	*/
+	int GetWaitTimeout() const;
+
+	/**
+	*	Should be called after waiting for an event with WAIT_FOREVER. Nothing was animating, so the idle time is skipped
+	*	instead of being caught up with update ticks.
+	*/
+	void Resume();
+
+	/**
+	*	Accounts for an update that is run immediately, outside of BeginFrame. The time is taken from the following ticks.
+	*/
+	void BorrowTick();
+
+	/**
+	*	Starts a new loop iteration. Advances the clock.
+	*	@return Number of updates to run, each GetTickInterval seconds long.
+	*/
+	size_t BeginFrame();
+
+	/**
+	*	@return Whether a frame should be rendered in this iteration.
+	*/
+	bool ShouldRender() const;
+
+	/**
+	*	Should be called after a frame has been rendered.
+	*/
+	void FrameRendered();
+
+private:
+	/**
+	*	@return Minimum interval between frames, in seconds. 0 if frames are not capped.
+	*/
+	double GetFrameInterval() const;
+
+	/**
+	*	@return Time until the given point, in milliseconds, rounded up. 0 if it has passed.
+	*/
+	int GetMillisecondsUntil( const Clock_t::time_point& time ) const;
+
+private:
+	double m_flTickRate = DEFAULT_TICK_RATE;
+	double m_flFrameCap = 0;
+
+	bool m_bVSync = false;
+	double m_flRefreshRate = 0;
+
+	bool m_bOnDemand = false;
+	bool m_bAnimating = false;
+	bool m_bRenderRequested = true;
+
+	Clock_t::time_point m_StartTime;
+
+	/**
+	*	Time at which the current iteration started.
+	*/
+	Clock_t::time_point m_FrameTime;
+
+	/**
+	*	Time at which the last frame was rendered.
+	*/
+	Clock_t::time_point m_LastRenderTime;
+
+	/**
+	*	Time that has passed but hasn't been consumed by update ticks, in seconds. Negative if ticks were borrowed.
+	*/
+	double m_flAccumulator = 0;
+
+	/**
+	*	Number of update ticks in the current iteration.
+	*/
+	size_t m_uiTicks = 0;
+
+private:
+	CFrameScheduler( const CFrameScheduler& ) = delete;
+	CFrameScheduler& operator=( const CFrameScheduler& ) = delete;
+};
+
+#endif //APP_CFRAMESCHEDULER_H
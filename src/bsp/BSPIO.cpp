@@ -12,6 +12,9 @@
 #include <memory>
 
 #include "utility/ByteSwap.h"
+#include "utility/CLogger.h"
+
+#include "filesystem/CFileSystem.h"
 
 #include "BSPIO.h"
 
@@ -26,14 +29,14 @@ bool CopyLump( const dheader_t* const pHeader, const BSPLump lump, DATA& data )
 
 	if( iLength % sizeof( DATA::Type_t ) )
 	{
-		printf( "Irregular length encountered while loading lump %d (%u byte chunk, alignment is %u)\n", lump, iLength % sizeof( DATA::Type_t ), sizeof( DATA::Type_t ) );
+		g_Logger.Error( LogCategory::BSP, "Irregular length encountered while loading lump %d (%u byte chunk, alignment is %u)\n", lump, iLength % sizeof( DATA::Type_t ), sizeof( DATA::Type_t ) );
 		return false;
 	}
 
 	//Total size exceeds destination size.
 	if( iLength > ( sizeof( DATA::Type_t ) * DATA::MAX_SIZE ) )
 	{
-		printf( "Source data too large while loading lump %d (max: %u, actual: %d)\n", lump, sizeof( DATA::Type_t ) * DATA::MAX_SIZE, iLength );
+		g_Logger.Error( LogCategory::BSP, "Source data too large while loading lump %d (max: %u, actual: %d)\n", lump, sizeof( DATA::Type_t ) * DATA::MAX_SIZE, iLength );
 		return false;
 	}
 
@@ -60,39 +63,58 @@ void FastBSPDataChecksum( DATA& data )
 	data.checksum = FastChecksum( data.data, data.count * sizeof( DATA::Type_t ) );
 }
 
-std::unique_ptr<dheader_t> LoadBSPFile( const char* const pszFileName )
+CFileData LoadBSPFile( const char* const pszFileName )
 {
 	assert( pszFileName );
 
-	FILE* pFile = fopen( pszFileName, "rb" );
+	return LoadBSPFile( pszFileName, g_FileSystem.LoadFile( pszFileName ) );
+}
+
+CFileData LoadBSPFile( const char* const pszFileName, CFileData&& data )
+{
+	assert( pszFileName );
 
-	if( !pFile )
+	if( !data.IsValid() )
 	{
-		printf( "Couldn't open BSP file \"%s\"\n", pszFileName );
-		return nullptr;
+		g_Logger.Error( LogCategory::BSP, "Couldn't open BSP file \"%s\"\n", pszFileName );
+		return CFileData();
 	}
 
-	fseek( pFile, 0, SEEK_END );
+	if( data.GetSize() < sizeof( dheader_t ) )
+	{
+		g_Logger.Error( LogCategory::BSP, "BSP file \"%s\" is too small to be a BSP file\n", pszFileName );
+		return CFileData();
+	}
 
-	const size_t size = ftell( pFile );
+	return std::move( data );
+}
 
-	fseek( pFile, 0, SEEK_SET );
+std::unique_ptr<char[]> LoadBSPEntities( const char* const pszFileName )
+{
+	assert( pszFileName );
 
-	std::unique_ptr<dheader_t> header( reinterpret_cast<dheader_t*>( new byte[ size ] ) );
+	dheader_t header;
 
-	dheader_t* pHeader = header.get();
+	if( !g_FileSystem.ReadFileRange( pszFileName, 0, &header, sizeof( header ) ) )
+		return nullptr;
 
-	const size_t readCount = fread( header.get(), 1, size, pFile );
+	if( LittleValue( header.version ) != BSPVERSION )
+		return nullptr;
 
-	fclose( pFile );
+	const int iOfs = LittleValue( header.lumps[ LUMP_ENTITIES ].fileofs );
+	const int iLength = LittleValue( header.lumps[ LUMP_ENTITIES ].filelen );
 
-	if( readCount != size )
-	{
-		printf( "Error reading BSP file \"%s\": expected %u bytes, read %u\n", pszFileName, size, readCount );
+	if( iOfs < 0 || iLength <= 0 )
 		return nullptr;
-	}
 
-	return header;
+	std::unique_ptr<char[]> entities( new char[ iLength + 1 ] );
+
+	if( !g_FileSystem.ReadFileRange( pszFileName, iOfs, entities.get(), iLength ) )
+		return nullptr;
+
+	entities[ iLength ] = '\0';
+
+	return entities;
 }
 
 bool LoadBSPFile( const char* const pszFileName, CBSPFile& file )
@@ -103,12 +125,12 @@ bool LoadBSPFile( const char* const pszFileName, CBSPFile& file )
 	memset( &file, 0, sizeof( file ) );
 
 	{
-		std::unique_ptr<dheader_t> header( LoadBSPFile( pszFileName ) );
+		CFileData data( LoadBSPFile( pszFileName ) );
 
-		if( !header )
+		if( !data.IsValid() )
 			return false;
 
-		dheader_t* pHeader = header.get();
+		dheader_t* pHeader = reinterpret_cast<dheader_t*>( data.GetData() );
 
 		for( size_t uiIndex = 0; uiIndex < sizeof( dheader_t ) / 4; ++uiIndex )
 		{
@@ -117,7 +139,7 @@ bool LoadBSPFile( const char* const pszFileName, CBSPFile& file )
 
 		if( pHeader->version != BSPVERSION )
 		{
-			printf( "BSP file \"%s\" is version %d, not %d\n", pszFileName, pHeader->version, BSPVERSION );
+			g_Logger.Error( LogCategory::BSP, "BSP file \"%s\" is version %d, not %d\n", pszFileName, pHeader->version, BSPVERSION );
 			return false;
 		}
 
@@ -142,7 +164,7 @@ bool LoadBSPFile( const char* const pszFileName, CBSPFile& file )
 
 		if( !bSuccess )
 		{
-			printf( "Failed to read BSP lump\n" );
+			g_Logger.Error( LogCategory::BSP, "Failed to read BSP lump\n" );
 			return false;
 		}
 	}
@@ -12,10 +12,33 @@
 
 #include <memory>
 
+#include "filesystem/CFileData.h"
+
 #include "BSPConstants.h"
 #include "BSPFile.h"
 
-std::unique_ptr<dheader_t> LoadBSPFile( const char* const pszFileName );
+/**
+*	Loads a BSP file through the filesystem.
+*	@param pszFileName Name of the file to load.
+*	@return BSP data, starting with the header. Not valid if the file could not be loaded.
+*/
+CFileData LoadBSPFile( const char* const pszFileName );
+
+/**
+*	Checks BSP file data that was already read from disk.
+*	@param pszFileName Name of the file the data was read from.
+*	@param data File data.
+*	@return BSP data, starting with the header. Not valid if the data is not valid.
+*/
+CFileData LoadBSPFile( const char* const pszFileName, CFileData&& data );
+
+/**
+*	Reads only the entity data from a BSP file. This is much smaller than the whole file,
+*	so it can be used to find the wads that the map needs while the rest of the file is still being read.
+*	@param pszFileName Name of the BSP file.
+*	@return Null terminated entity data, or null if the data could not be read.
+*/
+std::unique_ptr<char[]> LoadBSPEntities( const char* const pszFileName );
 
 bool LoadBSPFile( const char* const pszFileName, CBSPFile& file );
 
@@ -0,0 +1,247 @@
+/*
+Copyright (C) 1996-1997 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "entity/CBaseEntity.h"
+
+#include "BSPRefrag.h"
+
+namespace BSP
+{
+/**
+*	Number of efrags allocated at a time.
+*/
+static const size_t EFRAGS_PER_BLOCK = 1024;
+
+static std::vector<std::unique_ptr<efrag_t[]>> efrag_blocks;
+
+/**
+*	Free efrags, linked through entnext.
+*/
+static efrag_t* free_efrags = nullptr;
+
+static efrag_t* R_AllocEfrag()
+{
+	if( !free_efrags )
+	{
+		efrag_blocks.emplace_back( new efrag_t[ EFRAGS_PER_BLOCK ] );
+
+		efrag_t* pBlock = efrag_blocks.back().get();
+
+		for( size_t uiIndex = 0; uiIndex < EFRAGS_PER_BLOCK; ++uiIndex )
+		{
+			pBlock[ uiIndex ].entnext = uiIndex + 1 < EFRAGS_PER_BLOCK ? &pBlock[ uiIndex + 1 ] : nullptr;
+		}
+
+		free_efrags = pBlock;
+	}
+
+	efrag_t* ef = free_efrags;
+
+	free_efrags = ef->entnext;
+
+	return ef;
+}
+
+static void R_FreeEfrag( efrag_t* ef )
+{
+	ef->entnext = free_efrags;
+	free_efrags = ef;
+}
+
+/**
+*	@return 1 if the box is in front of the plane, 2 if it is behind it, 3 if it is on both sides.
+*/
+static int BoxOnPlaneSide( const Vector& emins, const Vector& emaxs, const mplane_t* p )
+{
+	Vector nearCorner, farCorner;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		if( p->normal[ i ] >= 0 )
+		{
+			nearCorner[ i ] = emins[ i ];
+			farCorner[ i ] = emaxs[ i ];
+		}
+		else
+		{
+			nearCorner[ i ] = emaxs[ i ];
+			farCorner[ i ] = emins[ i ];
+		}
+	}
+
+	int sides = 0;
+
+	if( glm::dot( p->normal, farCorner ) >= p->dist )
+		sides = 1;
+	if( glm::dot( p->normal, nearCorner ) < p->dist )
+		sides |= 2;
+
+	return sides;
+}
+
+struct EfragContext_t
+{
+	CBaseEntity* pEntity;
+	Vector mins;
+	Vector maxs;
+	efrag_t** ppLastLink;
+};
+
+/*
+===================
+R_SplitEntityOnNode
+===================
+*/
+static void R_SplitEntityOnNode( mnode_t* node, EfragContext_t& context )
+{
+	if( node->contents == CONTENTS_SOLID )
+		return;
+
+	// add an efrag if the node is a leaf
+	if( node->contents < 0 )
+	{
+		mleaf_t* leaf = reinterpret_cast<mleaf_t*>( node );
+
+		efrag_t* ef = R_AllocEfrag();
+
+		ef->entity = context.pEntity;
+
+		// add the entity link
+		*context.ppLastLink = ef;
+		context.ppLastLink = &ef->entnext;
+		ef->entnext = nullptr;
+
+		// set the leaf links
+		ef->leaf = leaf;
+		ef->leafnext = leaf->efrags;
+		leaf->efrags = ef;
+
+		return;
+	}
+
+	// NODE_MIXED
+	const int sides = BoxOnPlaneSide( context.mins, context.maxs, node->plane );
+
+	// recurse down the contacted sides
+	if( sides & 1 )
+		R_SplitEntityOnNode( node->children[ 0 ], context );
+
+	if( sides & 2 )
+		R_SplitEntityOnNode( node->children[ 1 ], context );
+}
+
+void R_AddEfrags( CBaseEntity* pEntity, bmodel_t* pWorld )
+{
+	assert( pEntity );
+	assert( pWorld );
+
+	R_RemoveEfrags( pEntity );
+
+	pEntity->SetLinked( pWorld );
+
+	if( !pEntity->GetBrushModel() )
+		return;
+
+	efrag_t* pEfrags = nullptr;
+
+	EfragContext_t context;
+
+	context.pEntity = pEntity;
+	context.ppLastLink = &pEfrags;
+
+	pEntity->GetAbsBounds( context.mins, context.maxs );
+
+	R_SplitEntityOnNode( pWorld->nodes, context );
+
+	pEntity->SetEfrags( pEfrags );
+}
+
+/*
+================
+R_RemoveEfrags
+
+Call when removing an object from the world or moving it to another position
+================
+*/
+void R_RemoveEfrags( CBaseEntity* pEntity )
+{
+	assert( pEntity );
+
+	efrag_t* ef = pEntity->GetEfrags();
+
+	while( ef )
+	{
+		efrag_t** prev = &ef->leaf->efrags;
+
+		while( true )
+		{
+			efrag_t* walk = *prev;
+
+			if( !walk )
+				break;
+
+			if( walk == ef )
+			{
+				// remove this fragment
+				*prev = ef->leafnext;
+				break;
+			}
+			else
+				prev = &walk->leafnext;
+		}
+
+		efrag_t* old = ef;
+		ef = ef->entnext;
+
+		R_FreeEfrag( old );
+	}
+
+	pEntity->SetEfrags( nullptr );
+	pEntity->SetLinked( nullptr );
+}
+
+bool R_CheckEfrags( CBaseEntity* pEntity, bmodel_t* pWorld )
+{
+	assert( pEntity );
+
+	if( !pEntity->NeedsRelink( pWorld ) )
+		return false;
+
+	R_AddEfrags( pEntity, pWorld );
+
+	return true;
+}
+
+bool R_IsEntityVisible( const CBaseEntity* pEntity, const int iVisFrame )
+{
+	assert( pEntity );
+
+	for( const efrag_t* ef = pEntity->GetEfrags(); ef; ef = ef->entnext )
+	{
+		if( ef->leaf->visframe == iVisFrame )
+			return true;
+	}
+
+	return false;
+}
+}
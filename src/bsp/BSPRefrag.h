@@ -0,0 +1,57 @@
+/*
+Copyright (C) 1996-1997 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#ifndef BSP_BSPREFRAG_H
+#define BSP_BSPREFRAG_H
+
+/**
+*	@file Linking of entities into the leafs of the world, so entities can be culled with the potentially visible set.
+*/
+
+#include "BSPRenderDefs.h"
+
+class CBaseEntity;
+
+namespace BSP
+{
+/**
+*	Links an entity into every leaf of the world that its bounds touch. Existing links are removed first.
+*	@param pEntity Entity to link. Must have a brush model.
+*	@param pWorld World model.
+*/
+void R_AddEfrags( CBaseEntity* pEntity, bmodel_t* pWorld );
+
+/**
+*	Removes an entity from all leafs that it is linked into.
+*/
+void R_RemoveEfrags( CBaseEntity* pEntity );
+
+/**
+*	Links an entity if it hasn't been linked yet, or relinks it if it has moved or changed models since it was last linked.
+*	@return Whether the entity was (re)linked.
+*/
+bool R_CheckEfrags( CBaseEntity* pEntity, bmodel_t* pWorld );
+
+/**
+*	@return Whether any leaf that the entity is linked into has been marked with the given visframe.
+*/
+bool R_IsEntityVisible( const CBaseEntity* pEntity, const int iVisFrame );
+}
+
+#endif //BSP_BSPREFRAG_H
@@ -28,6 +28,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "BSPFile.h"
 
 struct msurface_t;
+struct mleaf_t;
+
+class CBaseEntity;
 
 /**
 *	in memory representation
@@ -101,10 +104,15 @@ struct texture_t
 	unsigned height;
 
 	/**
-	*	glGenTextures value for this texture.
+	*	Texture array that contains this texture.
 	*/
 	GLuint gl_texturenum;
 
+	/**
+	*	Layer of this texture in gl_texturenum.
+	*/
+	GLint gl_texturelayer;
+
 	/**
 	*	for gl_texsort drawing
 	*/
@@ -192,7 +200,7 @@ struct mtexinfo_t
 	int flags;
 };
 
-#define	VERTEXSIZE	7
+#define	VERTEXSIZE	9
 
 /**
 *	A single brush polygon.
@@ -221,19 +229,19 @@ struct glpoly_t
 	int flags;
 
 	/**
-	*	Experimental. The OpenGL VBO ID.
+	*	Index of the first vertex of this polygon in the map's vertex buffer.
 	*/
-	GLuint VBO;
+	GLint firstvert;
 
 	/**
-	*	Experimental. The OpenGL VAO ID.
+	*	Experimental. The OpenGL VAO ID. Owned by g_VertexArrayCache.
 	*/
 	GLuint VAO;
 
 	/**
 	*	List of vertex commands.
-	*	variable sized (xyz s1t1 s2t2)
-	*	coordinate texture coordinates lightmap coordinates
+	*	variable sized (xyz s1t1l1 s2t2l2)
+	*	coordinate texture coordinates and layer lightmap coordinates and layer
 	*	Actual size is numverts
 	*/
 	float verts[ 4 ][ VERTEXSIZE ];
@@ -320,10 +328,15 @@ struct msurface_t
 	int dlightbits;
 
 	/**
-	*	Lightmap texture number for this surface.
+	*	Lightmap texture array for this surface.
 	*/
 	GLuint lightmaptexturenum;
 
+	/**
+	*	Layer of this surface's lightmap in lightmaptexturenum.
+	*/
+	int lightmaplayer;
+
 	/**
 	*	Light style indices.
 	*/
@@ -404,10 +417,22 @@ struct mnode_t
 */
 struct efrag_t
 {
-	struct mleaf_s		*leaf;
-	struct efrag_s		*leafnext;
-	struct entity_s		*entity;
-	struct efrag_s		*entnext;
+	/**
+	*	Leaf that the entity is linked into.
+	*/
+	mleaf_t* leaf;
+
+	/**
+	*	Next fragment in the leaf.
+	*/
+	efrag_t* leafnext;
+
+	CBaseEntity* entity;
+
+	/**
+	*	Next fragment of the entity.
+	*/
+	efrag_t* entnext;
 };
 
 struct mleaf_t
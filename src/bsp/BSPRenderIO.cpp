@@ -20,18 +20,28 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <cmath>
 #include <cstdio>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include "common/StringUtils.h"
+
 #include "utility/ByteSwap.h"
-#include "utility/Tokenization.h"
+#include "utility/CTokenizer.h"
+#include "utility/CLogger.h"
+#include "utility/CProfiler.h"
 
 #include "gl/CShaderManager.h"
 #include "gl/CBaseShader.h"
+#include "gl/CGLDiagnostics.h"
 #include "gl/CShaderInstance.h"
 
 #include "wad/CWadManager.h"
 #include "gl/CTextureManager.h"
+#include "gl/CTextureCache.h"
+#include "gl/CVertexArrayCache.h"
 
 #include "BSPRenderIO.h"
 
@@ -44,13 +54,15 @@ Mod_LoadVertexes
 */
 bool Mod_LoadVertexes( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dvertex_t* in = ( dvertex_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -78,13 +90,15 @@ Mod_LoadEdges
 */
 bool Mod_LoadEdges( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dedge_t* in = ( dedge_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -110,13 +124,15 @@ Mod_LoadSurfedges
 */
 bool Mod_LoadSurfedges( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	int* in = ( int* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -140,6 +156,8 @@ Mod_LoadTextures
 */
 bool Mod_LoadTextures( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	int		j, pixels;
 	miptex_t	*mt;
 
@@ -171,7 +189,7 @@ bool Mod_LoadTextures( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 
 		if( ( mt->width & 15 ) || ( mt->height & 15 ) )
 		{
-			printf( "Texture %s is not 16 aligned\n", mt->name );
+			g_Logger.Warning( LogCategory::BSP, "Texture %s is not 16 aligned\n", mt->name );
 			return false;
 		}
 		pixels = mt->width*mt->height / 64 * 85;
@@ -196,12 +214,12 @@ bool Mod_LoadTextures( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 		*/
 	}
 
-	//Wads aren't needed anymore now.
-	g_WadManager.Clear();
+	//Textures are uploaded to array pages one layer at a time; generate the mipmaps for all of them at once.
+	g_TextureCache.GenerateMipmaps();
 
 	if( !g_TextureManager.SetupAnimatingTextures() )
 	{
-		printf( "Couldn't set up animating textures\n" );
+		g_Logger.Error( LogCategory::BSP, "Couldn't set up animating textures\n" );
 		return false;
 	}
 
@@ -215,6 +233,8 @@ Mod_LoadLighting
 */
 bool Mod_LoadLighting( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	//Nothing to load.
 	if( !l->filelen )
 	{
@@ -235,13 +255,15 @@ Mod_LoadPlanes
 */
 bool Mod_LoadPlanes( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dplane_t* in = ( dplane_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -283,6 +305,8 @@ Mod_LoadTexinfo
 */
 bool Mod_LoadTexinfo( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	size_t		miptex;
 	float	len1, len2;
 
@@ -292,7 +316,7 @@ bool Mod_LoadTexinfo( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -340,7 +364,7 @@ bool Mod_LoadTexinfo( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 		{
 			if( miptex >= g_TextureManager.GetMaxTextures() )
 			{
-				printf( "miptex >= loadmodel->numtextures\n" );
+				g_Logger.Error( LogCategory::BSP, "miptex >= loadmodel->numtextures\n" );
 				return false;
 			}
 
@@ -350,7 +374,7 @@ bool Mod_LoadTexinfo( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 
 			if( !out->texture )
 			{
-				printf( "Couldn't find texture \"%s\"\n", pMiptex->name );
+				g_Logger.Error( LogCategory::BSP, "Couldn't find texture \"%s\"\n", pMiptex->name );
 				out->texture = r_notexture_mip; // texture not found
 				out->flags = 0;
 			}
@@ -410,7 +434,7 @@ bool CalcSurfaceExtents( bmodel_t* pModel, msurface_t *s )
 		s->extents[ i ] = ( bmaxs[ i ] - bmins[ i ] ) * 16;
 		if( !( tex->flags & TEX_SPECIAL ) && s->extents[ i ] > 512 /* 256 */ )
 		{
-			printf( "Bad surface extents\n" );
+			g_Logger.Error( LogCategory::BSP, "Bad surface extents\n" );
 			return false;
 		}
 	}
@@ -436,27 +460,6 @@ void BoundPoly( int numverts, Vector* verts, Vector& mins, Vector& maxs )
 		}
 }
 
-//static size_t g_uiPolyCount = 0;
-
-void CreatePoly( glpoly_t* pPoly )
-{
-	//glGenVertexArrays( 1, &pPoly->VAO );
-	//glBindVertexArray( pPoly->VAO );
-
-	glGenBuffers( 1, &pPoly->VBO );
-	glBindBuffer( GL_ARRAY_BUFFER, pPoly->VBO );
-
-	glBufferData( GL_ARRAY_BUFFER, pPoly->numverts * VERTEXSIZE * sizeof( GLfloat ), pPoly->verts, GL_STATIC_DRAW );
-
-	//TODO: Needed for VAO
-	//g_ShaderManager.GetShader( "LightMappedGeneric" )->SetupVertexAttribs();
-
-	/*
-	++g_uiPolyCount;
-
-	printf( "Created poly %u%s\n", g_uiPolyCount, pPoly->next ? " (duplicate)" : "" );
-	*/
-}
 
 bool SubdividePolygon( msurface_t* pSurface, int numverts, Vector* verts )
 {
@@ -473,7 +476,7 @@ bool SubdividePolygon( msurface_t* pSurface, int numverts, Vector* verts )
 
 	if( numverts > 60 )
 	{
-		printf( "numverts = %i", numverts );
+		g_Logger.Error( LogCategory::BSP, "numverts = %i\n", numverts );
 		return false;
 	}
 
@@ -546,9 +549,10 @@ bool SubdividePolygon( msurface_t* pSurface, int numverts, Vector* verts )
 		t = glm::dot( *verts, *reinterpret_cast<Vector*>( &pSurface->texinfo->vecs[ 1 ] ) );
 		poly->verts[ i ][ 3 ] = s;
 		poly->verts[ i ][ 4 ] = t;
+		poly->verts[ i ][ 5 ] = static_cast<float>( pSurface->texinfo->texture ? pSurface->texinfo->texture->gl_texturelayer : 0 );
 	}
 
-	CreatePoly( poly );
+	//Vertices are uploaded by GL_BuildVertexArrays.
 
 	return true;
 }
@@ -594,6 +598,8 @@ Mod_LoadFaces
 */
 bool Mod_LoadFaces( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	int			planenum, side;
 
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
@@ -602,7 +608,7 @@ bool Mod_LoadFaces( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -690,13 +696,15 @@ Mod_LoadMarksurfaces
 */
 bool Mod_LoadMarksurfaces( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	short* in = ( short* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -714,7 +722,7 @@ bool Mod_LoadMarksurfaces( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 
 		if( j >= pModel->numsurfaces )
 		{
-			printf( "Mod_ParseMarksurfaces: bad surface number\n" );
+			g_Logger.Error( LogCategory::BSP, "Mod_ParseMarksurfaces: bad surface number\n" );
 			return false;
 		}
 
@@ -731,6 +739,8 @@ Mod_LoadVisibility
 */
 bool Mod_LoadVisibility( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	//Nothing to load.
 	if( !l->filelen )
 	{
@@ -751,13 +761,15 @@ Mod_LoadLeafs
 */
 bool Mod_LoadLeafs( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dleaf_t* in = ( dleaf_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -790,6 +802,7 @@ bool Mod_LoadLeafs( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 		else
 			out->compressed_vis = pModel->visdata + p;
 		out->efrags = NULL;
+		out->visframe = 0;
 
 		for( size_t j = 0; j<4; j++ )
 			out->ambient_sound_level[ j ] = in->ambient_level[ j ];
@@ -826,13 +839,15 @@ Mod_LoadNodes
 */
 bool Mod_LoadNodes( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dnode_t* in = ( dnode_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -880,13 +895,15 @@ Mod_LoadClipnodes
 */
 bool Mod_LoadClipnodes( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dclipnode_t* in = ( dclipnode_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -939,6 +956,8 @@ Mod_LoadEntities
 */
 bool Mod_LoadEntities( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	//Nothing to load.
 	if( !l->filelen )
 	{
@@ -959,13 +978,15 @@ Mod_LoadSubmodels
 */
 bool Mod_LoadSubmodels( bmodel_t* pModel, dheader_t* pHeader, lump_t* l )
 {
+	PROFILE_FUNCTION();
+
 	byte* mod_base = reinterpret_cast<byte*>( pHeader );
 
 	dmodel_t* in = ( dmodel_t* ) ( mod_base + l->fileofs );
 
 	if( l->filelen % sizeof( *in ) )
 	{
-		printf( "MOD_LoadBmodel: funny lump size in %s", pModel->name );
+		g_Logger.Error( LogCategory::BSP, "MOD_LoadBmodel: funny lump size in %s\n", pModel->name );
 		return false;
 	}
 
@@ -1049,73 +1070,100 @@ float RadiusFromBounds( const Vector& mins, const Vector& maxs )
 bmodel_t mod_known[ MAX_MOD_KNOWN ];
 int mod_numknown = 0;
 
+typedef std::unordered_map<const char*, bmodel_t*, RawCharHash, RawCharEqualTo> ModelNameMap_t;
+
+/**
+*	Maps model names to models in mod_known. Keys point to the model's name.
+*/
+static ModelNameMap_t mod_knownmap;
+
 /*
 ==================
 Mod_FindName
 
 ==================
 */
-bmodel_t* Mod_FindName( char* name )
+bmodel_t* Mod_FindName( const char* name )
 {
-	int		i;
 	bmodel_t* mod;
 
 	if( !name[ 0 ] )
 	{
-		printf( "Mod_ForName: NULL name" );
+		g_Logger.Error( LogCategory::BSP, "Mod_ForName: NULL name\n" );
 		return nullptr;
 	}
 
 	//
 	// search the currently loaded models
 	//
-	for( i = 0, mod = mod_known; i<mod_numknown; i++, mod++ )
-		if( !strcmp( mod->name, name ) )
-			break;
+	mod = Mod_FindKnown( name );
 
-	if( i == mod_numknown )
+	if( !mod )
 	{
 		if( mod_numknown == MAX_MOD_KNOWN )
 		{
-			printf( "mod_numknown == MAX_MOD_KNOWN" );
+			g_Logger.Error( LogCategory::BSP, "mod_numknown == MAX_MOD_KNOWN\n" );
 			return nullptr;
 		}
+		mod = &mod_known[ mod_numknown ];
 		strcpy( mod->name, name );
 		mod_numknown++;
+
+		mod_knownmap.insert( std::make_pair( mod->name, mod ) );
 	}
 
 	return mod;
 }
 
+bmodel_t* Mod_FindKnown( const char* pszName )
+{
+	auto it = mod_knownmap.find( pszName );
+
+	return it != mod_knownmap.end() ? it->second : nullptr;
+}
+
+void Mod_ClearAll()
+{
+	mod_knownmap.clear();
+
+	memset( mod_known, 0, sizeof( mod_known ) );
+	mod_numknown = 0;
+}
+
 bool FindWadList( const bmodel_t* pModel, char*& pszWadList )
 {
 	assert( pModel );
 
+	return FindWadList( pModel->entities, pszWadList );
+}
+
+bool FindWadList( char* pszEntities, char*& pszWadList )
+{
 	pszWadList = nullptr;
 
-	if( pModel->entities )
+	if( pszEntities )
 	{
-		char* pszNext = pModel->entities;
+		CTokenizer tokenizer( pszEntities );
 
-		while( true )
-		{
-			char* pszNextToken = COM_Parse( pszNext );
+		CStringView key;
 
-			if( !pszNextToken || !( *pszNextToken ) || com_token[ 0 ] == '}' )
+		while( tokenizer.Next( key ) )
+		{
+			if( tokenizer.IsAtEnd() || key.GetFirst() == '}' )
 			{
 				break;
 			}
 
-			pszNext = pszNextToken;
-
-			if( strcmp( com_token, "wad" ) == 0 )
+			if( key == "wad" )
 			{
-				COM_Parse( pszNextToken );
+				//The value is the wad path list - Solokiller
+				CStringView value;
 
-				//com_token is the wad path list - Solokiller
-				size_t uiLength = strlen( com_token );
+				tokenizer.Next( value );
 
-				const bool bHasSemiColonEnd = uiLength > 0 ? com_token[ uiLength - 1 ] == ';' : false;
+				size_t uiLength = value.GetLength();
+
+				const bool bHasSemiColonEnd = value.GetLast() == ';';
 
 				//Need to append a semicolon at the end so search operations are easier - Solokiller
 				if( !bHasSemiColonEnd )
@@ -1123,7 +1171,7 @@ bool FindWadList( const bmodel_t* pModel, char*& pszWadList )
 
 				pszWadList = new char[ uiLength + 1 ];
 
-				strcpy( pszWadList, com_token );
+				value.CopyTo( pszWadList, uiLength + 1 );
 
 				if( !bHasSemiColonEnd )
 				{
@@ -1139,6 +1187,41 @@ bool FindWadList( const bmodel_t* pModel, char*& pszWadList )
 	return false;
 }
 
+void GetWadNames( char* pszWadList, std::vector<std::string>& wadNames )
+{
+	assert( pszWadList );
+
+	char* pszWad = pszWadList;
+
+	while( pszWad && *pszWad )
+	{
+		char* pszNext = strchr( pszWad + 1, ';' );
+
+		if( !pszNext )
+			break;
+
+		//Null terminate so the next operations succeeds.
+		*pszNext = '\0';
+
+		//TODO: fix slashes.
+		//Strip path.
+		char* pszWadName = strrchr( pszWad, '\\' );
+
+		if( pszWadName )
+			pszWad = pszWadName + 1;
+
+		char* pszExt = strrchr( pszWad, '.' );
+
+		//Null terminate for convenience.
+		if( pszExt )
+			*pszExt = '\0';
+
+		wadNames.emplace_back( pszWad );
+
+		pszWad = pszNext + 1;
+	}
+}
+
 /*
 ================
 BuildSurfaceDisplayList
@@ -1199,6 +1282,7 @@ void BuildSurfaceDisplayList( bmodel_t* pModel, msurface_t *fa )
 		*reinterpret_cast<Vector*>( &poly->verts[ i ] ) = *vec;
 		poly->verts[ i ][ 3 ] = s;
 		poly->verts[ i ][ 4 ] = t;
+		poly->verts[ i ][ 5 ] = static_cast<float>( fa->texinfo->texture->gl_texturelayer );
 
 		//
 		// lightmap texture coordinates
@@ -1215,8 +1299,9 @@ void BuildSurfaceDisplayList( bmodel_t* pModel, msurface_t *fa )
 		t += 8;
 		t /= BLOCK_HEIGHT * 16; //fa->texinfo->texture->height;
 
-		poly->verts[ i ][ 5 ] = s;
-		poly->verts[ i ][ 6 ] = t;
+		poly->verts[ i ][ 6 ] = s;
+		poly->verts[ i ][ 7 ] = t;
+		poly->verts[ i ][ 8 ] = static_cast<float>( fa->lightmaplayer );
 	}
 
 	//
@@ -1258,8 +1343,6 @@ void BuildSurfaceDisplayList( bmodel_t* pModel, msurface_t *fa )
 		}
 	}
 	poly->numverts = lnumverts;
-
-	CreatePoly( poly );
 }
 
 int			allocated[ MAX_LIGHTMAPS ][ BLOCK_WIDTH ];
@@ -1276,7 +1359,12 @@ int		d_lightstylevalue[ 256 ];	// 8.8 fraction of base light value
 
 int		gl_lightmap_format = GL_RGBA;
 
-GLuint lightmapID[ MAX_LIGHTMAPS ];
+GLuint lightmapArray = 0;
+
+/**
+*	Vertex buffer that contains the vertices of all polygons.
+*/
+static GLuint vertexBuffer = 0;
 
 #define MAX_GAMMA 256
 
@@ -1317,15 +1405,15 @@ int AllocBlock( int w, int h, int *x, int *y )
 		for( i = 0; i<w; i++ )
 			allocated[ texnum ][ *x + i ] = best + h;
 
-		if( lightmapID[ texnum ] == 0 )
+		if( lightmapArray == 0 )
 		{
-			glGenTextures( 1, &lightmapID[ texnum ] );
+			glGenTextures( 1, &lightmapArray );
 		}
 
 		return texnum;
 	}
 
-	printf( "AllocBlock: full\n" );
+	g_Logger.Error( LogCategory::BSP, "AllocBlock: full\n" );
 
 	return -1;
 }
@@ -1434,13 +1522,76 @@ store:
 		}
 		break;
 	default:
-		printf( "Bad lightmap format" );
+		g_Logger.Error( LogCategory::BSP, "Bad lightmap format\n" );
 		return false;
 	}
 
 	return true;
 }
 
+/*
+====================
+GL_BuildVertexArrays
+
+Uploads the vertices of all polygons into a single vertex buffer, so polygons that share state can be drawn with one call,
+and creates the vertex array objects that feed each polygon to its texture's shader.
+====================
+*/
+static void GL_BuildVertexArrays( bmodel_t* pModel )
+{
+	PROFILE_FUNCTION();
+
+	size_t uiNumVerts = 0;
+
+	msurface_t* pSurface = pModel->surfaces;
+
+	for( int i = 0; i < pModel->numsurfaces; ++i, ++pSurface )
+	{
+		for( glpoly_t* pPoly = pSurface->polys; pPoly; pPoly = pPoly->next )
+		{
+			uiNumVerts += pPoly->numverts;
+		}
+	}
+
+	std::vector<float> vertices;
+
+	vertices.reserve( uiNumVerts * VERTEXSIZE );
+
+	pSurface = pModel->surfaces;
+
+	for( int i = 0; i < pModel->numsurfaces; ++i, ++pSurface )
+	{
+		for( glpoly_t* pPoly = pSurface->polys; pPoly; pPoly = pPoly->next )
+		{
+			pPoly->firstvert = static_cast<GLint>( vertices.size() / VERTEXSIZE );
+
+			vertices.insert( vertices.end(), &pPoly->verts[ 0 ][ 0 ], &pPoly->verts[ pPoly->numverts ][ 0 ] );
+		}
+	}
+
+	glGenBuffers( 1, &vertexBuffer );
+	glBindBuffer( GL_ARRAY_BUFFER, vertexBuffer );
+
+	glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof( GLfloat ), vertices.data(), GL_STATIC_DRAW );
+
+	check_gl_error();
+
+	pSurface = pModel->surfaces;
+
+	for( int i = 0; i < pModel->numsurfaces; ++i, ++pSurface )
+	{
+		const texture_t* pTexture = pSurface->texinfo->texture;
+
+		if( !pTexture || !pTexture->pShader )
+			continue;
+
+		for( glpoly_t* pPoly = pSurface->polys; pPoly; pPoly = pPoly->next )
+		{
+			pPoly->VAO = g_VertexArrayCache.GetVertexArray( pTexture->pShader, vertexBuffer );
+		}
+	}
+}
+
 /*
 ========================
 GL_CreateSurfaceLightmap
@@ -1470,7 +1621,8 @@ bool GL_CreateSurfaceLightmap( msurface_t *surf )
 	if( iTexture == -1 )
 		return false;
 
-	surf->lightmaptexturenum = lightmapID[ iTexture ];
+	surf->lightmaptexturenum = lightmapArray;
+	surf->lightmaplayer = iTexture;
 
 	base = lightmaps + iTexture*lightmap_bytes*BLOCK_WIDTH*BLOCK_HEIGHT;
 	base += ( surf->light_t * BLOCK_WIDTH + surf->light_s ) * lightmap_bytes;
@@ -1510,11 +1662,15 @@ bool LoadBrushModel( bmodel_t* pModel, dheader_t* pHeader )
 	assert( pModel );
 	assert( pHeader );
 
+	GLDIAG_GROUP( "Load brush model" );
+
+	PROFILE_FUNCTION();
+
 	const int iVersion = LittleValue( pHeader->version );
 
 	if( iVersion != BSPVERSION )
 	{
-		printf( "BSP::LoadBrushmodel: %s has wrong version number (%d should be %d)\n", 
+		g_Logger.Error( LogCategory::BSP, "BSP::LoadBrushmodel: %s has wrong version number (%d should be %d)\n", 
 				pModel->name, iVersion, BSPVERSION );
 		return false;
 	}
@@ -1544,52 +1700,31 @@ bool LoadBrushModel( bmodel_t* pModel, dheader_t* pHeader )
 	if( !BSP::FindWadList( pModel, pszWadList ) )
 	{
 		//TODO: is this supposed to be an error? - Solokiller
-		printf( "Couldn't find wad list!\n" );
+		g_Logger.Error( LogCategory::BSP, "Couldn't find wad list!\n" );
 		return false;
 	}
 
-	{
-		const size_t uiLength = strlen( pszWadList );
-
-		char* pszWad = pszWadList;
-
-		while( pszWad && *pszWad )
-		{
-			char* pszNext = strchr( pszWad + 1, ';' );
-
-			if( !pszNext )
-				break;
-
-			//Null terminate so the next operations succeeds.
-			*pszNext = '\0';
-
-			//TODO: fix slashes.
-			//Strip path.
-			char* pszWadName = strrchr( pszWad, '\\' );
+	std::vector<std::string> wadNames;
 
-			if( pszWadName )
-				pszWad = pszWadName + 1;
+	GetWadNames( pszWadList, wadNames );
 
-			char* pszExt = strrchr( pszWad, '.' );
+	delete[] pszWadList;
 
-			//Null terminate for convenience.
-			if( pszExt )
-				*pszExt = '\0';
+	{
+		PROFILE_SCOPE( "Add wads" );
 
-			const auto result = g_WadManager.AddWad( pszWad );
+		for( const auto& szWadName : wadNames )
+		{
+			const auto result = g_WadManager.AddWad( szWadName.c_str() );
 
 			//TODO: adding wads that don't exist is not a failure condition in the engine. - Solokiller
 			if( result != CWadManager::AddResult::SUCCESS && 
 				result != CWadManager::AddResult::ALREADY_ADDED &&
 				result != CWadManager::AddResult::FILE_NOT_FOUND )
 				return false;
-
-			pszWad = pszNext + 1;
 		}
 	}
 
-	delete[] pszWadList;
-
 	if( !Mod_LoadTextures( pModel, pHeader, &pHeader->lumps[ LUMP_TEXTURES ] ) )
 		return false;
 
@@ -1680,7 +1815,7 @@ bool LoadBrushModel( bmodel_t* pModel, dheader_t* pHeader )
 
 	memset( allocated, 0, sizeof( allocated ) );
 	memset( lightmaps, 0, sizeof( lightmaps ) );
-	memset( lightmapID, 0, sizeof( lightmapID ) );
+	lightmapArray = 0;
 
 	BuildGammaTable( 1.0f, 2.2f );
 
@@ -1689,58 +1824,76 @@ bool LoadBrushModel( bmodel_t* pModel, dheader_t* pHeader )
 		d_lightstylevalue[ uiIndex ] = 264;
 	}
 
-	for( int i = 0; i<pModel->numsurfaces; i++ )
 	{
-		if( !GL_CreateSurfaceLightmap( pModel->surfaces + i ) )
-			return false;
-		/*
-		if( pModel->surfaces[ i ].flags & SURF_DRAWTURB )
-		continue;
-		#ifndef QUAKE2
-		if( pModel->surfaces[ i ].flags & SURF_DRAWSKY )
-		continue;
-		#endif
-		*/
-		BuildSurfaceDisplayList( pModel, pModel->surfaces + i );
-	}
+		PROFILE_SCOPE( "Build lightmaps" );
 
-	for( size_t j = 1; j<MAX_MOD_KNOWN; j++ )
-	{
-		pCurrentModel = &mod_known[ j ];
-		if( !pCurrentModel->name[ 0 ] )
-			break;
-		for( int i = 0; i<pCurrentModel->numsurfaces; i++ )
+		for( int i = 0; i<pModel->numsurfaces; i++ )
 		{
-			if( !GL_CreateSurfaceLightmap( pCurrentModel->surfaces + i ) )
+			if( !GL_CreateSurfaceLightmap( pModel->surfaces + i ) )
 				return false;
 			/*
-			if( pCurrentModel->surfaces[ i ].flags & SURF_DRAWTURB )
-				continue;
+			if( pModel->surfaces[ i ].flags & SURF_DRAWTURB )
+			continue;
+			#ifndef QUAKE2
+			if( pModel->surfaces[ i ].flags & SURF_DRAWSKY )
+			continue;
+			#endif
+			*/
+			BuildSurfaceDisplayList( pModel, pModel->surfaces + i );
+		}
+
+		for( size_t j = 1; j<MAX_MOD_KNOWN; j++ )
+		{
+			pCurrentModel = &mod_known[ j ];
+			if( !pCurrentModel->name[ 0 ] )
+				break;
+			for( int i = 0; i<pCurrentModel->numsurfaces; i++ )
+			{
+				if( !GL_CreateSurfaceLightmap( pCurrentModel->surfaces + i ) )
+					return false;
+				/*
+				if( pCurrentModel->surfaces[ i ].flags & SURF_DRAWTURB )
+					continue;
 #ifndef QUAKE2
-			if( pCurrentModel->surfaces[ i ].flags & SURF_DRAWSKY )
-				continue;
+				if( pCurrentModel->surfaces[ i ].flags & SURF_DRAWSKY )
+					continue;
 #endif
-*/
-			BuildSurfaceDisplayList( pCurrentModel, pCurrentModel->surfaces + i );
+	*/
+				BuildSurfaceDisplayList( pCurrentModel, pCurrentModel->surfaces + i );
+			}
 		}
 	}
 
 	//
 	// upload all lightmaps that were filled
+	// pages are stored contiguously, so they're uploaded as the layers of a single array
 	//
-	for( size_t i = 0; i<MAX_LIGHTMAPS; i++ )
+	GLsizei numLightmaps;
+
+	for( numLightmaps = 0; numLightmaps<MAX_LIGHTMAPS; numLightmaps++ )
 	{
-		if( !allocated[ i ][ 0 ] )
+		if( !allocated[ numLightmaps ][ 0 ] )
 			break;		// no more used
-		glBindTexture( GL_TEXTURE_2D, lightmapID[ i ] );
+	}
+
+	if( numLightmaps )
+	{
+		PROFILE_SCOPE( "Upload lightmaps" );
+
+		glBindTexture( GL_TEXTURE_2D_ARRAY, lightmapArray );
+
+		glTexParameterf( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+		glTexParameterf( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+		glTexImage3D( GL_TEXTURE_2D_ARRAY, 0, GL_RGBA
+					  , BLOCK_WIDTH, BLOCK_HEIGHT, numLightmaps, 0,
+					  gl_lightmap_format, GL_UNSIGNED_BYTE, lightmaps );
 
-		glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-		glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA
-					  , BLOCK_WIDTH, BLOCK_HEIGHT, 0,
-					  gl_lightmap_format, GL_UNSIGNED_BYTE, lightmaps + i*BLOCK_WIDTH*BLOCK_HEIGHT*lightmap_bytes );
+		check_gl_error();
 	}
 
+	//Submodels share the world's surfaces, so this covers every polygon.
+	GL_BuildVertexArrays( pModel );
+
 	return true;
 }
 
@@ -1749,18 +1902,18 @@ void FreeModel( bmodel_t* pModel )
 	if( !pModel )
 		return;
 
-	size_t uiNumLightmapTex;
+	g_VertexArrayCache.Clear();
 
-	for( uiNumLightmapTex = 0; uiNumLightmapTex < MAX_LIGHTMAPS; ++uiNumLightmapTex )
+	if( lightmapArray )
 	{
-		if( lightmapID[ uiNumLightmapTex ] == 0 )
-			break;
+		glDeleteTextures( 1, &lightmapArray );
+		lightmapArray = 0;
 	}
 
-	if( uiNumLightmapTex )
+	if( vertexBuffer )
 	{
-		glDeleteTextures( uiNumLightmapTex, lightmapID );
-		memset( lightmapID, 0, sizeof( lightmapID ) );
+		glDeleteBuffers( 1, &vertexBuffer );
+		vertexBuffer = 0;
 	}
 
 	delete[] pModel->submodels;
@@ -1793,6 +1946,12 @@ void FreeModel( bmodel_t* pModel )
 	//The textures themselves are managed by CTextureManager now, so don't delete them here. - Solokiller
 	g_TextureManager.Shutdown();
 
+	//Keep textures and wads around for the next map, within their memory budgets.
+	g_TextureCache.Trim();
+
+	g_WadManager.ReleaseWads();
+	g_WadManager.Trim();
+
 	delete[] pModel->visdata;
 	delete[] pModel->lightdata;
 	delete[] pModel->entities;
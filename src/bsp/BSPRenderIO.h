@@ -24,6 +24,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 *	@file BSP Rendering data structures file IO
 */
 
+#include <string>
+#include <vector>
+
 #include <gl/glew.h>
 
 #include "BSPConstants.h"
@@ -38,10 +41,45 @@ extern bmodel_t mod_known[ MAX_MOD_KNOWN ];
 
 extern int mod_numknown;
 
-extern GLuint lightmapID[ MAX_LIGHTMAPS ];
+/**
+*	Texture array that contains all lightmap pages, one per layer.
+*/
+extern GLuint lightmapArray;
+
+/**
+*	Finds a model by name, adding it to mod_known if it isn't known yet.
+*	@return The model, or null if the name is empty or there is no room for more models.
+*/
+bmodel_t* Mod_FindName( const char* name );
+
+/**
+*	Finds a known model by name without adding it.
+*	@return The model, or null if no model with that name is known.
+*/
+bmodel_t* Mod_FindKnown( const char* pszName );
+
+/**
+*	Forgets all known models. Does not free them; see FreeModel.
+*/
+void Mod_ClearAll();
 
 bool FindWadList( const bmodel_t* pModel, char*& pszWadList );
 
+/**
+*	Finds the wad list in the given entity data.
+*	@param pszEntities Entity data.
+*	@param pszWadList If the list was found, receives a copy of the list, terminated with a semicolon. Must be freed with delete[].
+*	@return Whether the wad list was found.
+*/
+bool FindWadList( char* pszEntities, char*& pszWadList );
+
+/**
+*	Gets the names of the wads in a wad list, without path and extension.
+*	@param pszWadList List of wads. Modified by this function.
+*	@param wadNames Receives the names.
+*/
+void GetWadNames( char* pszWadList, std::vector<std::string>& wadNames );
+
 bool LoadBrushModel( bmodel_t* pModel, dheader_t* pHeader );
 
 void FreeModel( bmodel_t* pModel );
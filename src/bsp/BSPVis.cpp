@@ -0,0 +1,127 @@
+/*
+Copyright (C) 1996-1997 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#include <cassert>
+#include <cstring>
+
+#include "BSPVis.h"
+
+namespace BSP
+{
+static byte mod_decompressed[ MAX_MAP_LEAFS / 8 ];
+static byte mod_novis[ MAX_MAP_LEAFS / 8 ];
+
+/*
+===============
+Mod_PointInLeaf
+===============
+*/
+mleaf_t* Mod_PointInLeaf( const Vector& vecPoint, bmodel_t* pModel )
+{
+	assert( pModel && pModel->nodes );
+
+	mnode_t* node = pModel->nodes;
+
+	while( true )
+	{
+		if( node->contents < 0 )
+			return reinterpret_cast<mleaf_t*>( node );
+
+		const mplane_t* plane = node->plane;
+
+		const float d = glm::dot( vecPoint, plane->normal ) - plane->dist;
+
+		if( d > 0 )
+			node = node->children[ 0 ];
+		else
+			node = node->children[ 1 ];
+	}
+}
+
+/*
+===================
+Mod_DecompressVis
+===================
+*/
+static const byte* Mod_DecompressVis( const byte* in, const bmodel_t* pModel )
+{
+	const int row = ( pModel->numleafs + 7 ) >> 3;
+
+	byte* out = mod_decompressed;
+
+	if( !in )
+	{
+		// no vis info, so make all visible
+		memset( out, 0xFF, row );
+		return mod_decompressed;
+	}
+
+	do
+	{
+		if( *in )
+		{
+			*out++ = *in++;
+			continue;
+		}
+
+		int c = in[ 1 ];
+		in += 2;
+
+		// don't write past the end of the row on bad data
+		if( c > row - ( out - mod_decompressed ) )
+			c = row - ( out - mod_decompressed );
+
+		while( c )
+		{
+			*out++ = 0;
+			c--;
+		}
+	}
+	while( out - mod_decompressed < row );
+
+	return mod_decompressed;
+}
+
+const byte* Mod_LeafPVS( mleaf_t* pLeaf, bmodel_t* pModel )
+{
+	if( pLeaf == pModel->leafs )
+	{
+		memset( mod_novis, 0xFF, sizeof( mod_novis ) );
+		return mod_novis;
+	}
+
+	return Mod_DecompressVis( pLeaf->compressed_vis, pModel );
+}
+
+void R_MarkLeaves( mleaf_t* pViewLeaf, bmodel_t* pModel, const int iVisFrame )
+{
+	assert( pViewLeaf );
+	assert( pModel );
+
+	const byte* vis = Mod_LeafPVS( pViewLeaf, pModel );
+
+	for( int i = 0; i < pModel->numleafs; ++i )
+	{
+		if( vis[ i >> 3 ] & ( 1 << ( i & 7 ) ) )
+			pModel->leafs[ i + 1 ].visframe = iVisFrame;
+	}
+
+	pViewLeaf->visframe = iVisFrame;
+}
+}
@@ -0,0 +1,57 @@
+/*
+Copyright (C) 1996-1997 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+#ifndef BSP_BSPVIS_H
+#define BSP_BSPVIS_H
+
+/**
+*	@file Potentially visible set lookups.
+*/
+
+#include "BSPRenderDefs.h"
+
+namespace BSP
+{
+/**
+*	Finds the leaf that contains a point.
+*	@param vecPoint Point to find.
+*	@param pModel Model whose node tree to search.
+*	@return The leaf.
+*/
+mleaf_t* Mod_PointInLeaf( const Vector& vecPoint, bmodel_t* pModel );
+
+/**
+*	Gets the potentially visible set of a leaf. Bit N is set if leaf N + 1 is visible.
+*	If the leaf has no visibility data, everything is visible.
+*	@param pLeaf Leaf to get the set for.
+*	@param pModel Model that the leaf belongs to.
+*	@return The decompressed set. Valid until the next call.
+*/
+const byte* Mod_LeafPVS( mleaf_t* pLeaf, bmodel_t* pModel );
+
+/**
+*	Marks every leaf in the potentially visible set of a leaf, as well as the leaf itself.
+*	@param pViewLeaf Leaf that the view is in.
+*	@param pModel Model that the leaf belongs to.
+*	@param iVisFrame Value to set mleaf_t::visframe to in visible leafs.
+*/
+void R_MarkLeaves( mleaf_t* pViewLeaf, bmodel_t* pModel, const int iVisFrame );
+}
+
+#endif //BSP_BSPVIS_H
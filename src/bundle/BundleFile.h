@@ -0,0 +1,115 @@
+#ifndef BUNDLE_BUNDLEFILE_H
+#define BUNDLE_BUNDLEFILE_H
+
+/**
+*	@file Map bundle file format.
+*	A bundle contains a BSP file and a wad with only the textures that the map uses, so the map can be loaded from a single file.
+*	The header is followed by the table of contents. Every section starts at a multiple of BUNDLE_ALIGNMENT so it can be mapped directly.
+*/
+
+/**
+*	File extension for bundle files.
+*/
+#define BUNDLE_FILE_EXT ".bundle"
+
+/**
+*	Identifier for bundle files.
+*/
+#define BUNDLE_ID "MBDL"
+
+#define BUNDLE_VERSION 1
+
+/**
+*	Alignment of sections in the file.
+*/
+#define BUNDLE_ALIGNMENT 4096
+
+/**
+*	Maximum size that a section name can be, including the null terminator.
+*/
+#define BUNDLE_MAX_SECTION_NAME_SIZE 32
+
+enum BundleSectionType
+{
+	/**
+	*	BSP file. The wad key in the entity data refers to the bundle's wad section.
+	*/
+	BUNDLE_SECTION_BSP	= 0,
+
+	/**
+	*	WAD3 file containing the textures that the BSP doesn't contain itself.
+	*/
+	BUNDLE_SECTION_WAD	= 1,
+};
+
+enum BundleCompression
+{
+	BUNDLE_COMPRESSION_NONE	= 0,
+
+	/**
+	*	LZ4 block format.
+	*/
+	BUNDLE_COMPRESSION_LZ4	= 1,
+};
+
+/**
+*	Bundle file header.
+*/
+struct bundleheader_t
+{
+	/**
+	*	Should be MBDL.
+	*/
+	char id[ 4 ];
+
+	int version;
+
+	/**
+	*	Number of sections in the table of contents.
+	*/
+	int numsections;
+
+	/**
+	*	Offset in this file where the table of contents starts.
+	*/
+	int tocofs;
+};
+
+/**
+*	A single section in the table of contents.
+*/
+struct bundlesection_t
+{
+	/**
+	*	Name of the section. For wad sections, this is the name of the wad.
+	*	Must be null terminated.
+	*/
+	char name[ BUNDLE_MAX_SECTION_NAME_SIZE ];
+
+	/**
+	*	@see BundleSectionType
+	*/
+	int type;
+
+	/**
+	*	@see BundleCompression
+	*/
+	int compression;
+
+	/**
+	*	Offset in this file where the section's data starts.
+	*/
+	int fileofs;
+
+	/**
+	*	Size of the section's data in the file. If this section is compressed, this is the compressed size.
+	*/
+	int disksize;
+
+	/**
+	*	Size of the section's data after decompression.
+	*/
+	int size;
+};
+
+#endif //BUNDLE_BUNDLEFILE_H
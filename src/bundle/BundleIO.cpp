@@ -0,0 +1,649 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Platform.h"
+
+#include "utility/ByteSwap.h"
+#include "utility/LZ4.h"
+#include "utility/CTokenizer.h"
+#include "utility/CLogger.h"
+
+#include "filesystem/CFileSystem.h"
+#include "filesystem/CMappedFile.h"
+
+#include "bsp/BSPIO.h"
+#include "bsp/BSPRenderIO.h"
+
+#include "wad/CWadManager.h"
+#include "wad/WadIO.h"
+
+#include "BundleIO.h"
+
+/**
+*	Section data waiting to be written.
+*/
+struct BundleSectionData_t
+{
+	bundlesection_t section;
+	std::vector<byte> data;
+};
+
+static size_t AlignUp( const size_t uiValue, const size_t uiAlignment )
+{
+	return ( uiValue + uiAlignment - 1 ) & ~( uiAlignment - 1 );
+}
+
+static void AppendData( std::vector<byte>& buffer, const void* pData, const size_t uiSize )
+{
+	const byte* pBytes = reinterpret_cast<const byte*>( pData );
+
+	buffer.insert( buffer.end(), pBytes, pBytes + uiSize );
+}
+
+/**
+*	32 bit FNV-1a hash of a buffer.
+*/
+static uint32_t HashData( const std::vector<byte>& data )
+{
+	uint32_t uiHash = 2166136261U;
+
+	for( const auto value : data )
+	{
+		uiHash = ( uiHash ^ value ) * 16777619U;
+	}
+
+	return uiHash;
+}
+
+/**
+*	Gets the size of a miptex, including its mipmaps and palette.
+*/
+static size_t GetMiptexSize( const miptex_t& miptex )
+{
+	return LittleValue( miptex.offsets[ 0 ] ) + GetMiptexPixelSize( miptex ) + sizeof( short ) + 256 * 3;
+}
+
+/**
+*	Replaces the value of the wad key in the entity data.
+*	@return Whether the wad key was found.
+*/
+static bool ReplaceWadList( const std::vector<char>& entities, const char* const pszWadList, std::string& szResult )
+{
+	CTokenizer tokenizer( entities.data() );
+
+	CStringView key;
+
+	while( tokenizer.Next( key ) )
+	{
+		if( tokenizer.IsAtEnd() || key.GetFirst() == '}' )
+			break;
+
+		if( key == "wad" )
+		{
+			const char* pszValueStart = tokenizer.GetPosition();
+
+			while( *pszValueStart && static_cast<unsigned char>( *pszValueStart ) <= ' ' )
+				++pszValueStart;
+
+			CStringView value;
+
+			if( !tokenizer.Next( value ) )
+				return false;
+
+			szResult.assign( entities.data(), pszValueStart - entities.data() );
+			szResult += '\"';
+			szResult += pszWadList;
+			szResult += '\"';
+			szResult += tokenizer.GetPosition();
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+*	Builds a WAD3 file containing the given textures.
+*/
+static void BuildWad( const std::vector<const miptex_t*>& textures, std::vector<byte>& wad )
+{
+	wad.resize( sizeof( wadinfo_t ) );
+
+	std::vector<lumpinfo_t> lumps;
+
+	lumps.reserve( textures.size() );
+
+	for( auto pMiptex : textures )
+	{
+		const size_t uiSize = GetMiptexSize( *pMiptex );
+
+		lumpinfo_t lump;
+
+		memset( &lump, 0, sizeof( lump ) );
+
+		lump.filepos = LittleValue( static_cast<int>( wad.size() ) );
+		lump.disksize = LittleValue( static_cast<int>( uiSize ) );
+		lump.size = lump.disksize;
+		lump.type = TYP_LUMPY + TYP_LUMPY_MIPTEX;
+		lump.compression = false;
+
+		CleanupWadLumpName( pMiptex->name, lump.name, sizeof( lump.name ) );
+
+		lumps.push_back( lump );
+
+		AppendData( wad, pMiptex, uiSize );
+
+		wad.resize( AlignUp( wad.size(), 4 ) );
+	}
+
+	wadinfo_t header;
+
+	memcpy( header.identification, WAD3_ID, sizeof( header.identification ) );
+	header.numlumps = LittleValue( static_cast<int>( lumps.size() ) );
+	header.infotableofs = LittleValue( static_cast<int>( wad.size() ) );
+
+	if( !lumps.empty() )
+		AppendData( wad, lumps.data(), lumps.size() * sizeof( lumpinfo_t ) );
+
+	memcpy( wad.data(), &header, sizeof( header ) );
+}
+
+/**
+*	Builds the BSP and wad sections of a bundle.
+*	@param pszMapName Name of the map to bundle.
+*	@param pszBaseName Base name of the bundle. The wad is named after it and its contents.
+*	@param pszWadName Receives the name of the wad, without extension.
+*	@param uiWadNameSize Size of the wad name buffer.
+*/
+static bool BuildMapSections( const char* const pszMapName, const char* const pszBaseName, char* pszWadName, const size_t uiWadNameSize,
+							  std::vector<byte>& bsp, std::vector<byte>& wad )
+{
+	CFileData data = LoadBSPFile( pszMapName );
+
+	if( !data.IsValid() )
+		return false;
+
+	const byte* pBase = data.GetData();
+
+	dheader_t header;
+
+	memcpy( &header, pBase, sizeof( header ) );
+
+	for( size_t uiIndex = 0; uiIndex < sizeof( dheader_t ) / 4; ++uiIndex )
+	{
+		reinterpret_cast<int*>( &header )[ uiIndex ] = LittleValue( reinterpret_cast<int*>( &header )[ uiIndex ] );
+	}
+
+	if( header.version != BSPVERSION )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: BSP file \"%s\" is version %d, not %d\n", pszMapName, header.version, BSPVERSION );
+		return false;
+	}
+
+	for( int iLump = LUMP_FIRST; iLump <= LUMP_LAST; ++iLump )
+	{
+		const auto& lump = header.lumps[ iLump ];
+
+		if( lump.fileofs < 0 || lump.filelen < 0 ||
+			static_cast<size_t>( lump.fileofs ) + static_cast<size_t>( lump.filelen ) > data.GetSize() )
+		{
+			g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: BSP file \"%s\" lump %d is out of range\n", pszMapName, iLump );
+			return false;
+		}
+	}
+
+	//Find the wads that the map uses.
+	const lump_t& entityLump = header.lumps[ LUMP_ENTITIES ];
+
+	std::vector<char> entities( pBase + entityLump.fileofs, pBase + entityLump.fileofs + entityLump.filelen );
+
+	entities.push_back( '\0' );
+
+	char* pszWadList;
+
+	if( !BSP::FindWadList( entities.data(), pszWadList ) )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: Couldn't find wad list in \"%s\"\n", pszMapName );
+		return false;
+	}
+
+	std::vector<std::string> wadNames;
+
+	BSP::GetWadNames( pszWadList, wadNames );
+
+	delete[] pszWadList;
+
+	for( const auto& szWadName : wadNames )
+	{
+		g_WadManager.AddWad( szWadName.c_str() );
+	}
+
+	//Collect the textures that aren't stored in the BSP.
+	std::vector<const miptex_t*> textures;
+
+	const lump_t& textureLump = header.lumps[ LUMP_TEXTURES ];
+
+	if( textureLump.filelen >= static_cast<int>( sizeof( int ) ) )
+	{
+		const byte* pTexBase = pBase + textureLump.fileofs;
+
+		const int iNumMiptex = LittleValue( reinterpret_cast<const dmiptexlump_t*>( pTexBase )->nummiptex );
+
+		const int* pDataOfs = reinterpret_cast<const dmiptexlump_t*>( pTexBase )->dataofs;
+
+		for( int iMiptex = 0; iMiptex < iNumMiptex; ++iMiptex )
+		{
+			const int iOfs = LittleValue( pDataOfs[ iMiptex ] );
+
+			//Missing texture.
+			if( iOfs == -1 )
+				continue;
+
+			const miptex_t* pMiptex = reinterpret_cast<const miptex_t*>( pTexBase + iOfs );
+
+			if( LittleValue( pMiptex->offsets[ 0 ] ) > 0 )
+				continue;
+
+			const miptex_t* pWadMiptex = g_WadManager.FindTextureByName( pMiptex->name );
+
+			if( !pWadMiptex )
+			{
+				g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: Couldn't find texture \"%s\"\n", pMiptex->name );
+				continue;
+			}
+
+			auto it = std::find( textures.begin(), textures.end(), pWadMiptex );
+
+			if( it == textures.end() )
+				textures.push_back( pWadMiptex );
+		}
+	}
+
+	BuildWad( textures, wad );
+
+	g_WadManager.ReleaseWads();
+
+	//Wads are cached by name, so bundles with the same name but different textures must not share a wad name.
+	//The content hash makes the name unique per set of textures; bundles that do share it have identical wads.
+	snprintf( pszWadName, uiWadNameSize, "%.22s_%08x", pszBaseName, HashData( wad ) );
+
+	g_Logger.Info( LogCategory::BUNDLE, "WriteMapBundle: %u textures from %u wads\n", textures.size(), wadNames.size() );
+
+	//Point the map to the bundle's wad.
+	std::string szEntities;
+
+	char szWadList[ MAX_PATH_LENGTH ];
+
+	snprintf( szWadList, sizeof( szWadList ), "%s%s", pszWadName, WAD_FILE_EXT );
+
+	if( !ReplaceWadList( entities, szWadList, szEntities ) )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: Couldn't replace wad list in \"%s\"\n", pszMapName );
+		return false;
+	}
+
+	//Rebuild the BSP with the new entity data.
+	dheader_t newHeader;
+
+	memset( &newHeader, 0, sizeof( newHeader ) );
+
+	newHeader.version = LittleValue( header.version );
+
+	bsp.resize( sizeof( dheader_t ) );
+
+	for( int iLump = LUMP_FIRST; iLump <= LUMP_LAST; ++iLump )
+	{
+		bsp.resize( AlignUp( bsp.size(), 4 ) );
+
+		const void* pData;
+		size_t uiLength;
+
+		if( iLump == LUMP_ENTITIES )
+		{
+			pData = szEntities.c_str();
+			uiLength = szEntities.length() + 1;
+		}
+		else
+		{
+			pData = pBase + header.lumps[ iLump ].fileofs;
+			uiLength = header.lumps[ iLump ].filelen;
+		}
+
+		newHeader.lumps[ iLump ].fileofs = LittleValue( static_cast<int>( bsp.size() ) );
+		newHeader.lumps[ iLump ].filelen = LittleValue( static_cast<int>( uiLength ) );
+
+		AppendData( bsp, pData, uiLength );
+	}
+
+	memcpy( bsp.data(), &newHeader, sizeof( newHeader ) );
+
+	return true;
+}
+
+static void SetupSection( BundleSectionData_t& section, const char* const pszName, const BundleSectionType type, std::vector<byte>&& data, const bool bCompress )
+{
+	memset( &section.section, 0, sizeof( section.section ) );
+
+	strncpy( section.section.name, pszName, sizeof( section.section.name ) );
+	section.section.name[ sizeof( section.section.name ) - 1 ] = '\0';
+
+	section.section.type = type;
+	section.section.compression = BUNDLE_COMPRESSION_NONE;
+	section.section.size = static_cast<int>( data.size() );
+
+	section.data = std::move( data );
+
+	if( bCompress && !section.data.empty() )
+	{
+		std::vector<byte> compressed( LZ4_CompressBound( section.data.size() ) );
+
+		const size_t uiCompressedSize = LZ4_Compress( section.data.data(), section.data.size(), compressed.data(), compressed.size() );
+
+		//Only worth it if it's smaller.
+		if( uiCompressedSize > 0 && uiCompressedSize < section.data.size() )
+		{
+			compressed.resize( uiCompressedSize );
+
+			section.data = std::move( compressed );
+			section.section.compression = BUNDLE_COMPRESSION_LZ4;
+		}
+	}
+
+	section.section.disksize = static_cast<int>( section.data.size() );
+}
+
+static bool WriteZeroes( FILE* pFile, size_t uiCount )
+{
+	static const byte zeroes[ BUNDLE_ALIGNMENT ] = {};
+
+	while( uiCount > 0 )
+	{
+		const size_t uiChunk = uiCount < sizeof( zeroes ) ? uiCount : sizeof( zeroes );
+
+		if( fwrite( zeroes, 1, uiChunk, pFile ) != uiChunk )
+			return false;
+
+		uiCount -= uiChunk;
+	}
+
+	return true;
+}
+
+bool WriteMapBundle( const char* const pszMapName, const char* const pszOutFileName, const bool bCompress )
+{
+	assert( pszMapName );
+	assert( pszOutFileName );
+
+	char szBaseName[ MAX_PATH_LENGTH ];
+
+	{
+		const char* pszBaseName = strrchr( pszOutFileName, '/' );
+		const char* pszBaseName2 = strrchr( pszOutFileName, '\\' );
+
+		if( pszBaseName2 > pszBaseName )
+			pszBaseName = pszBaseName2;
+
+		pszBaseName = pszBaseName ? pszBaseName + 1 : pszOutFileName;
+
+		strncpy( szBaseName, pszBaseName, sizeof( szBaseName ) );
+		szBaseName[ sizeof( szBaseName ) - 1 ] = '\0';
+
+		if( char* pszExt = strrchr( szBaseName, '.' ) )
+			*pszExt = '\0';
+	}
+
+	char szWadName[ BUNDLE_MAX_SECTION_NAME_SIZE ];
+
+	std::vector<byte> bsp;
+	std::vector<byte> wad;
+
+	if( !BuildMapSections( pszMapName, szBaseName, szWadName, sizeof( szWadName ), bsp, wad ) )
+		return false;
+
+	const int iNumSections = 2;
+
+	BundleSectionData_t sections[ iNumSections ];
+
+	SetupSection( sections[ 0 ], szBaseName, BUNDLE_SECTION_BSP, std::move( bsp ), bCompress );
+	SetupSection( sections[ 1 ], szWadName, BUNDLE_SECTION_WAD, std::move( wad ), bCompress );
+
+	bundleheader_t header;
+
+	memcpy( header.id, BUNDLE_ID, sizeof( header.id ) );
+	header.version = LittleValue( BUNDLE_VERSION );
+	header.numsections = LittleValue( iNumSections );
+	header.tocofs = LittleValue( static_cast<int>( sizeof( bundleheader_t ) ) );
+
+	size_t uiOffset = AlignUp( sizeof( bundleheader_t ) + sizeof( bundlesection_t ) * iNumSections, BUNDLE_ALIGNMENT );
+
+	bundlesection_t toc[ iNumSections ];
+
+	for( int iSection = 0; iSection < iNumSections; ++iSection )
+	{
+		auto& section = sections[ iSection ].section;
+
+		section.fileofs = static_cast<int>( uiOffset );
+
+		uiOffset = AlignUp( uiOffset + section.disksize, BUNDLE_ALIGNMENT );
+
+		toc[ iSection ] = section;
+
+		toc[ iSection ].type = LittleValue( section.type );
+		toc[ iSection ].compression = LittleValue( section.compression );
+		toc[ iSection ].fileofs = LittleValue( section.fileofs );
+		toc[ iSection ].disksize = LittleValue( section.disksize );
+		toc[ iSection ].size = LittleValue( section.size );
+	}
+
+	FILE* pFile = fopen( pszOutFileName, "wb" );
+
+	if( !pFile )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: Couldn't open \"%s\" for writing\n", pszOutFileName );
+		return false;
+	}
+
+	bool bSuccess = fwrite( &header, sizeof( header ), 1, pFile ) == 1 &&
+		fwrite( toc, sizeof( bundlesection_t ), iNumSections, pFile ) == static_cast<size_t>( iNumSections );
+
+	size_t uiWritten = sizeof( header ) + sizeof( bundlesection_t ) * iNumSections;
+
+	for( int iSection = 0; bSuccess && iSection < iNumSections; ++iSection )
+	{
+		const auto& section = sections[ iSection ];
+
+		bSuccess = WriteZeroes( pFile, section.section.fileofs - uiWritten );
+
+		if( bSuccess && !section.data.empty() )
+			bSuccess = fwrite( section.data.data(), 1, section.data.size(), pFile ) == section.data.size();
+
+		uiWritten = section.section.fileofs + section.data.size();
+
+		g_Logger.Info( LogCategory::BUNDLE, "WriteMapBundle: Section \"%s\": %d bytes, %d on disk%s\n",
+				section.section.name, section.section.size, section.section.disksize,
+				section.section.compression == BUNDLE_COMPRESSION_LZ4 ? " (LZ4)" : "" );
+	}
+
+	fclose( pFile );
+
+	if( !bSuccess )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "WriteMapBundle: Error writing \"%s\"\n", pszOutFileName );
+		return false;
+	}
+
+	return true;
+}
+
+/**
+*	Loads a section's data. Uncompressed sections are views of the mapped bundle.
+*/
+static CFileData LoadBundleSection( const CMappedFile& file, const bundlesection_t& section )
+{
+	switch( section.compression )
+	{
+	case BUNDLE_COMPRESSION_NONE:
+		{
+			if( section.disksize != section.size )
+				return CFileData();
+
+			return CFileData( file.MapView( section.fileofs, section.size ) );
+		}
+
+	case BUNDLE_COMPRESSION_LZ4:
+		{
+			auto view = file.MapView( section.fileofs, section.disksize );
+
+			if( !view )
+				return CFileData();
+
+			std::unique_ptr<byte[]> data( new byte[ section.size ] );
+
+			if( !LZ4_Decompress( view->GetData(), view->GetSize(), data.get(), section.size ) )
+				return CFileData();
+
+			return CFileData( std::move( data ), section.size );
+		}
+
+	default: return CFileData();
+	}
+}
+
+bool LoadMapBundle( const char* const pszFileName, CFileData& bspData )
+{
+	assert( pszFileName );
+
+	//Bundles are memory mapped, so they have to be loose files. Names that aren't in the search paths are opened as given.
+	char szPath[ MAX_PATH_LENGTH ];
+	bool bInPak = false;
+
+	const char* pszPath = pszFileName;
+
+	if( g_FileSystem.GetLooseFilePath( pszFileName, szPath, sizeof( szPath ), bInPak ) )
+	{
+		pszPath = szPath;
+	}
+	else if( bInPak )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Bundle \"%s\" is in a pak file, bundles must be loose files\n", pszFileName );
+		return false;
+	}
+
+	CMappedFile file;
+
+	if( !file.Open( pszPath ) )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Couldn't open bundle \"%s\"\n", pszFileName );
+		return false;
+	}
+
+	bundleheader_t header;
+
+	{
+		auto view = file.MapView( 0, sizeof( header ) );
+
+		if( !view )
+		{
+			g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: File \"%s\" is too small to be a bundle\n", pszFileName );
+			return false;
+		}
+
+		memcpy( &header, view->GetData(), sizeof( header ) );
+	}
+
+	if( strncmp( BUNDLE_ID, header.id, sizeof( header.id ) ) )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: File \"%s\" is not a bundle\n", pszFileName );
+		return false;
+	}
+
+	header.version = LittleValue( header.version );
+	header.numsections = LittleValue( header.numsections );
+	header.tocofs = LittleValue( header.tocofs );
+
+	if( header.version != BUNDLE_VERSION )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Bundle \"%s\" is version %d, not %d\n", pszFileName, header.version, BUNDLE_VERSION );
+		return false;
+	}
+
+	if( header.numsections <= 0 || header.tocofs < 0 )
+	{
+		g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Bundle \"%s\" has an invalid table of contents\n", pszFileName );
+		return false;
+	}
+
+	std::vector<bundlesection_t> sections( header.numsections );
+
+	{
+		auto view = file.MapView( header.tocofs, sizeof( bundlesection_t ) * header.numsections );
+
+		if( !view )
+		{
+			g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Bundle \"%s\" has an invalid table of contents\n", pszFileName );
+			return false;
+		}
+
+		memcpy( sections.data(), view->GetData(), view->GetSize() );
+	}
+
+	for( auto& section : sections )
+	{
+		section.name[ sizeof( section.name ) - 1 ] = '\0';
+		section.type = LittleValue( section.type );
+		section.compression = LittleValue( section.compression );
+		section.fileofs = LittleValue( section.fileofs );
+		section.disksize = LittleValue( section.disksize );
+		section.size = LittleValue( section.size );
+
+		if( section.fileofs < 0 || section.disksize <= 0 || section.size <= 0 )
+		{
+			g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Bundle \"%s\" section \"%s\" is invalid\n", pszFileName, section.name );
+			return false;
+		}
+
+		CFileData data = LoadBundleSection( file, section );
+
+		if( !data.IsValid() )
+		{
+			g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Couldn't load bundle \"%s\" section \"%s\"\n", pszFileName, section.name );
+			return false;
+		}
+
+		switch( section.type )
+		{
+		case BUNDLE_SECTION_BSP:
+			{
+				bspData = LoadBSPFile( section.name, std::move( data ) );
+				break;
+			}
+
+		case BUNDLE_SECTION_WAD:
+			{
+				const auto result = g_WadManager.AddWad( section.name, std::move( data ) );
+
+				if( result != CWadManager::AddResult::SUCCESS && result != CWadManager::AddResult::ALREADY_ADDED )
+				{
+					g_Logger.Error( LogCategory::BUNDLE, "LoadMapBundle: Couldn't add bundle \"%s\" wad \"%s\"\n", pszFileName, section.name );
+					return false;
+				}
+
+				break;
+			}
+
+		default:
+			{
+				g_Logger.Warning( LogCategory::BUNDLE, "LoadMapBundle: Bundle \"%s\" section \"%s\" has unknown type %d, ignoring\n", pszFileName, section.name, section.type );
+				break;
+			}
+		}
+	}
+
+	return bspData.IsValid();
+}
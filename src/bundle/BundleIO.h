@@ -0,0 +1,26 @@
+#ifndef BUNDLE_BUNDLEIO_H
+#define BUNDLE_BUNDLEIO_H
+
+#include "filesystem/CFileData.h"
+
+#include "BundleFile.h"
+
+/**
+*	Writes a bundle for a map. The wads that the map uses are loaded to find the textures it needs.
+*	@param pszMapName Name of the BSP file, relative to the search paths.
+*	@param pszOutFileName Name of the bundle file to write.
+*	@param bCompress Whether to compress sections with LZ4. Sections that don't get smaller are stored uncompressed.
+*	@return Whether the bundle was written.
+*/
+bool WriteMapBundle( const char* const pszMapName, const char* const pszOutFileName, const bool bCompress );
+
+/**
+*	Loads a bundle. The bundle is mapped into memory; uncompressed sections are used without copying them.
+*	The bundle's wad is added to the wad manager.
+*	@param pszFileName Name of the bundle file. Looked up in the file system's search paths; bundles in pak files are not supported.
+*	@param bspData Receives the BSP file data.
+*	@return Whether the bundle was loaded.
+*/
+bool LoadMapBundle( const char* const pszFileName, CFileData& bspData );
+
+#endif //BUNDLE_BUNDLEIO_H
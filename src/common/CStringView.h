@@ -0,0 +1,131 @@
+#ifndef COMMON_CSTRINGVIEW_H
+#define COMMON_CSTRINGVIEW_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "core/Platform.h"
+
+/**
+*	Non-owning view of a range of characters. The characters are not null terminated.
+*/
+class CStringView final
+{
+public:
+	/**
+	*	Constructs an empty view.
+	*/
+	CStringView() = default;
+
+	/**
+	*	Constructs a view of the given characters.
+	*/
+	CStringView( const char* pszData, const size_t uiLength )
+		: m_pszData( pszData )
+		, m_uiLength( uiLength )
+	{
+	}
+
+	/**
+	*	Constructs a view of a null terminated string.
+	*/
+	CStringView( const char* pszString )
+		: m_pszData( pszString )
+		, m_uiLength( pszString ? strlen( pszString ) : 0 )
+	{
+	}
+
+	CStringView( const CStringView& other ) = default;
+	CStringView& operator=( const CStringView& other ) = default;
+
+	const char* GetData() const { return m_pszData; }
+
+	size_t GetLength() const { return m_uiLength; }
+
+	bool IsEmpty() const { return m_uiLength == 0; }
+
+	const char* begin() const { return m_pszData; }
+
+	const char* end() const { return m_pszData + m_uiLength; }
+
+	char operator[]( const size_t uiIndex ) const
+	{
+		assert( uiIndex < m_uiLength );
+
+		return m_pszData[ uiIndex ];
+	}
+
+	/**
+	*	@return The first character, or '\0' if the view is empty.
+	*/
+	char GetFirst() const { return m_uiLength ? m_pszData[ 0 ] : '\0'; }
+
+	/**
+	*	@return The last character, or '\0' if the view is empty.
+	*/
+	char GetLast() const { return m_uiLength ? m_pszData[ m_uiLength - 1 ] : '\0'; }
+
+	/**
+	*	@return Whether this view contains the same characters as the given view.
+	*/
+	bool Equals( const CStringView& other ) const
+	{
+		return m_uiLength == other.m_uiLength && ( m_uiLength == 0 || memcmp( m_pszData, other.m_pszData, m_uiLength ) == 0 );
+	}
+
+	/**
+	*	@return Whether this view contains the same characters as the given view, ignoring case.
+	*/
+	bool EqualsI( const CStringView& other ) const
+	{
+		return m_uiLength == other.m_uiLength && ( m_uiLength == 0 || strncasecmp( m_pszData, other.m_pszData, m_uiLength ) == 0 );
+	}
+
+	/**
+	*	Removes trailing characters that match the given character.
+	*/
+	void TrimEnd( const char character = ' ' )
+	{
+		while( m_uiLength && m_pszData[ m_uiLength - 1 ] == character )
+			--m_uiLength;
+	}
+
+	/**
+	*	Copies the characters to a buffer and null terminates it. The string is truncated if it doesn't fit.
+	*	@return Whether the entire string fit in the buffer.
+	*/
+	bool CopyTo( char* pszBuffer, const size_t uiBufferSize ) const
+	{
+		assert( pszBuffer );
+		assert( uiBufferSize > 0 );
+
+		const size_t uiCount = m_uiLength < uiBufferSize ? m_uiLength : uiBufferSize - 1;
+
+		if( uiCount )
+			memcpy( pszBuffer, m_pszData, uiCount );
+
+		pszBuffer[ uiCount ] = '\0';
+
+		return uiCount == m_uiLength;
+	}
+
+	std::string ToString() const { return std::string( m_pszData, m_uiLength ); }
+
+private:
+	const char* m_pszData = "";
+	size_t m_uiLength = 0;
+};
+
+inline bool operator==( const CStringView& lhs, const CStringView& rhs )
+{
+	return lhs.Equals( rhs );
+}
+
+inline bool operator!=( const CStringView& lhs, const CStringView& rhs )
+{
+	return !lhs.Equals( rhs );
+}
+
+#endif //COMMON_CSTRINGVIEW_H
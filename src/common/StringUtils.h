@@ -2,6 +2,7 @@
 #define COMMON_STRINGUTILS_H
 
 #include <cctype>
+#include <cstdint>
 #include <cstring>
 #include <functional>
 
@@ -73,4 +74,29 @@ struct BaseRawCharEqualTo : public std::binary_function<const char*, const char*
 typedef BaseRawCharEqualTo<strcmp> RawCharEqualTo;
 typedef BaseRawCharEqualTo<strcasecmp> RawCharEqualToI;
 
+/**
+*	32 bit FNV-1a hash that can be evaluated at compile time, so it can be used for case labels when switching on a string.
+*	Since case labels must be unique, a switch on this hash is a perfect hash of the strings it handles.
+*	A match still has to be confirmed with a string comparison, since other strings can have the same hash.
+*/
+constexpr uint32_t ConstStringHash( const char* pszString, const uint32_t uiHash = 2166136261U )
+{
+	return *pszString ? ConstStringHash( pszString + 1, ( uiHash ^ static_cast<uint8_t>( *pszString ) ) * 16777619U ) : uiHash;
+}
+
+/**
+*	Runtime version of ConstStringHash.
+*/
+inline uint32_t RuntimeStringHash( const char* pszString )
+{
+	uint32_t uiHash = 2166136261U;
+
+	for( ; *pszString; ++pszString )
+	{
+		uiHash = ( uiHash ^ static_cast<uint8_t>( *pszString ) ) * 16777619U;
+	}
+
+	return uiHash;
+}
+
 #endif //COMMON_STRINGUTILS_H
\ No newline at end of file
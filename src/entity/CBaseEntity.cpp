@@ -1,15 +1,100 @@
+#include <cstdlib>
 #include <cstring>
 
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "common/StringUtils.h"
+
+#include "utility/StringToNumber.h"
+
 #include "bsp/BSPRenderIO.h"
 
 #include "CBaseEntity.h"
+#include "CEntityList.h"
+
+/**
+*	Classes that use their angles as the direction they move in. The game turns the angles into a direction and clears them
+*	in SetMovedir, so their models are drawn unrotated; their vertices are already in world space.
+*/
+static const char* const MOVEDIR_CLASSNAMES[] =
+{
+	"func_door",
+	"func_water",
+	"func_button",
+	"func_conveyor",
+	"momentary_door",
+	"trigger_autosave",
+	"trigger_cdaudio",
+	"trigger_changelevel",
+	"trigger_counter",
+	"trigger_endsection",
+	"trigger_gravity",
+	"trigger_hurt",
+	"trigger_monsterjump",
+	"trigger_multiple",
+	"trigger_once",
+	"trigger_push",
+	"trigger_teleport"
+};
+
+static bool UsesMoveDir( const char* const pszClassName )
+{
+	for( auto pszMoveDirClassName : MOVEDIR_CLASSNAMES )
+	{
+		if( strcmp( pszMoveDirClassName, pszClassName ) == 0 )
+			return true;
+	}
+
+	return false;
+}
 
 void CBaseEntity::Construct( const char* const pszClassName, const size_t uiEntIndex )
 {
-	m_szClassName = pszClassName;
+	m_pszClassName = pszClassName;
 	m_uiEntIndex = uiEntIndex;
 }
 
+void CBaseEntity::GetAbsBounds( Vector& mins, Vector& maxs ) const
+{
+	if( m_pModel )
+	{
+		if( m_vecAngles[ 0 ] || m_vecAngles[ 1 ] || m_vecAngles[ 2 ] )
+		{
+			//The radius covers the model in any orientation.
+			mins = m_vecOrigin - Vector( m_pModel->radius );
+			maxs = m_vecOrigin + Vector( m_pModel->radius );
+		}
+		else
+		{
+			mins = m_vecOrigin + m_pModel->mins;
+			maxs = m_vecOrigin + m_pModel->maxs;
+		}
+	}
+	else
+	{
+		mins = m_vecOrigin;
+		maxs = m_vecOrigin;
+	}
+}
+
+const glm::mat4x4& CBaseEntity::GetModelMatrix()
+{
+	//The matrix starts out as identity, which is correct for an entity at the world origin.
+	if( m_vecMatrixOrigin != m_vecOrigin || m_vecMatrixAngles != m_vecAngles )
+	{
+		m_vecMatrixOrigin = m_vecOrigin;
+		m_vecMatrixAngles = m_vecAngles;
+
+		//Same order as R_RotateForEntity: yaw around z, pitch around y (inverted for brush models), then roll around x.
+		m_ModelMatrix = glm::translate( glm::mat4x4(), m_vecOrigin );
+		m_ModelMatrix = glm::rotate( m_ModelMatrix, glm::radians( m_vecAngles[ 1 ] ), Vector( 0, 0, 1 ) );
+		m_ModelMatrix = glm::rotate( m_ModelMatrix, glm::radians( -m_vecAngles[ 0 ] ), Vector( 0, 1, 0 ) );
+		m_ModelMatrix = glm::rotate( m_ModelMatrix, glm::radians( m_vecAngles[ 2 ] ), Vector( 1, 0, 0 ) );
+	}
+
+	return m_ModelMatrix;
+}
+
 void CBaseEntity::OnCreate()
 {
 }
@@ -22,11 +107,11 @@ void ParseVector( const char* pszString, Vector& vec )
 {
 	size_t uiIndex;
 
-	char* pszNext = const_cast<char*>( pszString );
+	const char* pszNext = pszString;
 
 	for( uiIndex = 0; uiIndex < 3; ++uiIndex )
 	{
-		vec[ uiIndex ] = static_cast<float>( strtod( pszNext, &pszNext ) );
+		pszNext = ParseFloat( pszNext, vec[ uiIndex ] );
 
 		if( !( *pszNext ) )
 			break;
@@ -44,49 +129,86 @@ T clamp( T min, T val, T max )
 	return ( val < min ) ? min : ( val > max ? max : val );
 }
 
+const char* CBaseEntity::GetKeyValue( const char* pszKey ) const
+{
+	return g_EntList.GetKeyValues().Find( m_uiFirstKeyValue, pszKey );
+}
+
 bool CBaseEntity::KeyValue( const char* pszKey, const char* pszValue )
 {
-	if( strcmp( "origin", pszKey ) == 0 )
-	{
-		ParseVector( pszValue, m_vecOrigin );
-		return true;
-	}
-	else if( strcmp( "angles", pszKey ) == 0 )
-	{
-		ParseVector( pszValue, m_vecAngles );
-		return true;
-	}
-	else if( strcmp( "rendermode", pszKey ) == 0 )
-	{
-		m_RenderMode = static_cast<RenderMode>( strtol( pszValue, nullptr, 10 ) );
+	m_uiLastKeyValue = g_EntList.GetKeyValues().Add( pszKey, pszValue, m_uiLastKeyValue );
 
-		if( m_RenderMode < RenderMode::FIRST )
-			m_RenderMode = RenderMode::FIRST;
-		else if( m_RenderMode > RenderMode::LAST )
-			m_RenderMode = RenderMode::LAST;
+	if( m_uiFirstKeyValue == CKeyValueStore::INVALID_INDEX )
+		m_uiFirstKeyValue = m_uiLastKeyValue;
 
-		return true;
-	}
-	else if( strcmp( "renderamt", pszKey ) == 0 )
-	{
-		m_flRenderAmount = static_cast<float>( clamp( 0.0, strtod( pszValue, nullptr ), 255.0 ) );
-		return true;
-	}
-	else if( strcmp( "model", pszKey ) == 0 )
+	g_EntList.InvalidateIndex();
+
+	//Case labels are hashed at compile time; the string comparison rejects other keys with the same hash.
+	switch( RuntimeStringHash( pszKey ) )
 	{
-		for( int iIndex = 0; iIndex < BSP::mod_numknown; ++iIndex )
+	case ConstStringHash( "origin" ):
 		{
-			if( !BSP::mod_known[ iIndex ].name[ 0 ] )
+			if( strcmp( "origin", pszKey ) != 0 )
 				break;
 
-			if( strcmp( pszValue, BSP::mod_known[ iIndex ].name ) == 0 )
-			{
-				m_pModel = &BSP::mod_known[ iIndex ];
+			ParseVector( pszValue, m_vecOrigin );
+			return true;
+		}
+
+	case ConstStringHash( "angles" ):
+		{
+			if( strcmp( "angles", pszKey ) != 0 )
+				break;
+
+			//The keyvalue is still stored, so the move direction can be looked up.
+			if( !UsesMoveDir( m_pszClassName ) )
+				ParseVector( pszValue, m_vecAngles );
+
+			return true;
+		}
+
+	case ConstStringHash( "rendermode" ):
+		{
+			if( strcmp( "rendermode", pszKey ) != 0 )
 				break;
-			}
+
+			m_RenderMode = static_cast<RenderMode>( strtol( pszValue, nullptr, 10 ) );
+
+			if( m_RenderMode < RenderMode::FIRST )
+				m_RenderMode = RenderMode::FIRST;
+			else if( m_RenderMode > RenderMode::LAST )
+				m_RenderMode = RenderMode::LAST;
+
+			return true;
+		}
+
+	case ConstStringHash( "renderamt" ):
+		{
+			if( strcmp( "renderamt", pszKey ) != 0 )
+				break;
+
+			double flAmount;
+
+			ParseDouble( pszValue, flAmount );
+
+			m_flRenderAmount = static_cast<float>( clamp( 0.0, flAmount, 255.0 ) );
+			return true;
+		}
+
+	case ConstStringHash( "model" ):
+		{
+			if( strcmp( "model", pszKey ) != 0 )
+				break;
+
+			bmodel_t* pModel = BSP::Mod_FindKnown( pszValue );
+
+			if( pModel )
+				m_pModel = pModel;
+
+			return true;
 		}
 
-		return true;
+	default: break;
 	}
 
 	return false;
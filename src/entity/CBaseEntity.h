@@ -3,11 +3,16 @@
 
 #include <string>
 
+#include <glm/mat4x4.hpp>
+
 #include "utility/Mathlib.h"
 
+#include "CKeyValueStore.h"
+
 #undef GetClassName
 
 struct bmodel_t;
+struct efrag_t;
 
 enum class RenderMode
 {
@@ -44,10 +49,24 @@ public:
 
 	virtual void Spawn();
 
-	const char* GetClassName() const { return m_szClassName.c_str(); }
+	/**
+	*	@return The class name. Class names are interned in g_AtomTable, so they can be compared by pointer.
+	*/
+	const char* GetClassName() const { return m_pszClassName; }
 
 	size_t GetEntIndex() const { return m_uiEntIndex; }
 
+	/**
+	*	Gets the value of a keyvalue. Every keyvalue passed to KeyValue is stored, including ones that this entity doesn't use.
+	*	@return The last value that was set for the key, or null if the key was never set.
+	*/
+	const char* GetKeyValue( const char* pszKey ) const;
+
+	/**
+	*	@return Index of the first keyvalue of this entity in the entity list's keyvalue store, or CKeyValueStore::INVALID_INDEX.
+	*/
+	size_t GetFirstKeyValue() const { return m_uiFirstKeyValue; }
+
 	bmodel_t* GetBrushModel() const { return m_pModel; }
 
 	const Vector& GetOrigin() const { return m_vecOrigin; }
@@ -58,24 +77,80 @@ public:
 
 	Vector& GetMutableAngles() { return m_vecAngles; }
 
+	/**
+	*	Gets the matrix that transforms the entity's model into world space.
+	*	Classes whose angles are a move direction, like func_door, are not rotated.
+	*	The matrix is cached and only recalculated when the origin or angles have changed since the last call.
+	*/
+	const glm::mat4x4& GetModelMatrix();
+
 	RenderMode GetRenderMode() const { return m_RenderMode; }
 
 	float GetRenderAmount() const { return m_flRenderAmount; }
 
+	/**
+	*	Gets the bounds of the entity in world space. Brush entities are bounded by their model, rotated models by the model radius.
+	*	Other entities are a point at their origin.
+	*/
+	void GetAbsBounds( Vector& mins, Vector& maxs ) const;
+
+	/**
+	*	@return The fragments linking this entity into the leafs of the world. See BSPRefrag.h.
+	*/
+	efrag_t* GetEfrags() const { return m_pEfrags; }
+
+	void SetEfrags( efrag_t* pEfrags ) { m_pEfrags = pEfrags; }
+
+	/**
+	*	Records that the entity was linked into the given world in its current position, or unlinked if pWorld is null.
+	*/
+	void SetLinked( bmodel_t* pWorld )
+	{
+		m_pLinkedWorld = pWorld;
+		m_vecLinkedOrigin = m_vecOrigin;
+		m_vecLinkedAngles = m_vecAngles;
+		m_pLinkedModel = m_pModel;
+	}
+
+	/**
+	*	@return Whether the entity isn't linked into the given world, or has moved or changed models since it was linked.
+	*/
+	bool NeedsRelink( const bmodel_t* pWorld ) const
+	{
+		return m_pLinkedWorld != pWorld ||
+			m_pLinkedModel != m_pModel ||
+			m_vecLinkedOrigin != m_vecOrigin ||
+			m_vecLinkedAngles != m_vecAngles;
+	}
+
 private:
-	std::string m_szClassName;
+	const char* m_pszClassName = "";
 
 	size_t m_uiEntIndex = INVALID_ENT_INDEX;
 
+	size_t m_uiFirstKeyValue = CKeyValueStore::INVALID_INDEX;
+	size_t m_uiLastKeyValue = CKeyValueStore::INVALID_INDEX;
+
 	bmodel_t* m_pModel = nullptr;
 
 	Vector m_vecOrigin;
 	Vector m_vecAngles;
 
+	glm::mat4x4 m_ModelMatrix;
+	Vector m_vecMatrixOrigin;
+	Vector m_vecMatrixAngles;
+
 	RenderMode m_RenderMode = RenderMode::NORMAL;
 
 	float m_flRenderAmount = 0;
 
+	efrag_t* m_pEfrags = nullptr;
+
+	bmodel_t* m_pLinkedWorld = nullptr;
+	bmodel_t* m_pLinkedModel = nullptr;
+	Vector m_vecLinkedOrigin;
+	Vector m_vecLinkedAngles;
+
 private:
 	CBaseEntity( const CBaseEntity& ) = delete;
 	CBaseEntity& operator=( const CBaseEntity& ) = delete;
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cmath>
+
+#include "utility/CAtomTable.h"
+
+#include "CBaseEntity.h"
+
+#include "CEntityIndex.h"
+
+/**
+*	Cell coordinates are packed into 21 bits each.
+*/
+static const int CELL_COORD_BITS = 21;
+static const uint64_t CELL_COORD_MASK = ( 1ULL << CELL_COORD_BITS ) - 1;
+
+static inline int GetCellCoord( const float flValue )
+{
+	return static_cast<int>( floor( flValue / CEntityIndex::CELL_SIZE ) );
+}
+
+static inline uint64_t GetCellKey( const int iX, const int iY, const int iZ )
+{
+	return ( static_cast<uint64_t>( iX ) & CELL_COORD_MASK ) |
+		( ( static_cast<uint64_t>( iY ) & CELL_COORD_MASK ) << CELL_COORD_BITS ) |
+		( ( static_cast<uint64_t>( iZ ) & CELL_COORD_MASK ) << ( CELL_COORD_BITS * 2 ) );
+}
+
+void CEntityIndex::Build( const std::vector<CBaseEntity*>& entities )
+{
+	Clear();
+
+	const char* const pszTargetName = g_AtomTable.Intern( "targetname" );
+	const char* const pszTarget = g_AtomTable.Intern( "target" );
+
+	m_Bounds.reserve( entities.size() );
+
+	for( auto pEntity : entities )
+	{
+		m_ClassNames.insert( std::make_pair( pEntity->GetClassName(), pEntity ) );
+
+		if( const char* pszValue = pEntity->GetKeyValue( pszTargetName ) )
+			m_TargetNames.insert( std::make_pair( g_AtomTable.Intern( pszValue ), pEntity ) );
+
+		if( const char* pszValue = pEntity->GetKeyValue( pszTarget ) )
+			m_Targets.insert( std::make_pair( g_AtomTable.Intern( pszValue ), pEntity ) );
+
+		EntityBounds_t bounds;
+
+		bounds.pEntity = pEntity;
+
+		pEntity->GetAbsBounds( bounds.mins, bounds.maxs );
+
+		const size_t uiIndex = m_Bounds.size();
+
+		m_Bounds.push_back( bounds );
+
+		const int iMinX = GetCellCoord( bounds.mins[ 0 ] ), iMaxX = GetCellCoord( bounds.maxs[ 0 ] );
+		const int iMinY = GetCellCoord( bounds.mins[ 1 ] ), iMaxY = GetCellCoord( bounds.maxs[ 1 ] );
+		const int iMinZ = GetCellCoord( bounds.mins[ 2 ] ), iMaxZ = GetCellCoord( bounds.maxs[ 2 ] );
+
+		const size_t uiNumCells =
+			static_cast<size_t>( iMaxX - iMinX + 1 ) * static_cast<size_t>( iMaxY - iMinY + 1 ) * static_cast<size_t>( iMaxZ - iMinZ + 1 );
+
+		if( uiNumCells > MAX_CELLS_PER_ENTITY )
+		{
+			m_Oversized.push_back( uiIndex );
+			continue;
+		}
+
+		for( int iX = iMinX; iX <= iMaxX; ++iX )
+		{
+			for( int iY = iMinY; iY <= iMaxY; ++iY )
+			{
+				for( int iZ = iMinZ; iZ <= iMaxZ; ++iZ )
+				{
+					m_Cells[ GetCellKey( iX, iY, iZ ) ].push_back( uiIndex );
+				}
+			}
+		}
+	}
+
+	m_VisitMarks.resize( m_Bounds.size(), 0 );
+}
+
+void CEntityIndex::Clear()
+{
+	m_ClassNames.clear();
+	m_TargetNames.clear();
+	m_Targets.clear();
+
+	m_Bounds.clear();
+	m_Cells.clear();
+	m_Oversized.clear();
+
+	m_VisitMarks.clear();
+	m_uiVisitMark = 0;
+}
+
+void CEntityIndex::FindByName( const NameMap_t& map, const char* pszName, std::vector<CBaseEntity*>& results )
+{
+	//Names are interned, so a name that was never interned isn't used by any entity.
+	const char* pszAtom = g_AtomTable.Find( pszName );
+
+	if( !pszAtom )
+		return;
+
+	auto range = map.equal_range( pszAtom );
+
+	for( auto it = range.first; it != range.second; ++it )
+	{
+		results.push_back( it->second );
+	}
+}
+
+void CEntityIndex::FindByClassName( const char* pszClassName, std::vector<CBaseEntity*>& results ) const
+{
+	FindByName( m_ClassNames, pszClassName, results );
+}
+
+void CEntityIndex::FindByTargetName( const char* pszTargetName, std::vector<CBaseEntity*>& results ) const
+{
+	FindByName( m_TargetNames, pszTargetName, results );
+}
+
+void CEntityIndex::FindByTarget( const char* pszTarget, std::vector<CBaseEntity*>& results ) const
+{
+	FindByName( m_Targets, pszTarget, results );
+}
+
+template<typename FUNC>
+void CEntityIndex::VisitCandidates( const Vector& mins, const Vector& maxs, const FUNC& callback )
+{
+	if( ++m_uiVisitMark == 0 )
+	{
+		//Wrapped around; old marks could match the new mark.
+		std::fill( m_VisitMarks.begin(), m_VisitMarks.end(), 0 );
+		m_uiVisitMark = 1;
+	}
+
+	auto visit = [ & ]( const size_t uiIndex )
+	{
+		if( m_VisitMarks[ uiIndex ] == m_uiVisitMark )
+			return;
+
+		m_VisitMarks[ uiIndex ] = m_uiVisitMark;
+
+		callback( m_Bounds[ uiIndex ] );
+	};
+
+	for( auto uiIndex : m_Oversized )
+	{
+		visit( uiIndex );
+	}
+
+	const int iMinX = GetCellCoord( mins[ 0 ] ), iMaxX = GetCellCoord( maxs[ 0 ] );
+	const int iMinY = GetCellCoord( mins[ 1 ] ), iMaxY = GetCellCoord( maxs[ 1 ] );
+	const int iMinZ = GetCellCoord( mins[ 2 ] ), iMaxZ = GetCellCoord( maxs[ 2 ] );
+
+	const double flNumCells = ( iMaxX - iMinX + 1.0 ) * ( iMaxY - iMinY + 1.0 ) * ( iMaxZ - iMinZ + 1.0 );
+
+	//Large queries are cheaper to answer by visiting every occupied cell.
+	if( flNumCells > m_Cells.size() )
+	{
+		for( const auto& cell : m_Cells )
+		{
+			for( auto uiIndex : cell.second )
+			{
+				visit( uiIndex );
+			}
+		}
+
+		return;
+	}
+
+	for( int iX = iMinX; iX <= iMaxX; ++iX )
+	{
+		for( int iY = iMinY; iY <= iMaxY; ++iY )
+		{
+			for( int iZ = iMinZ; iZ <= iMaxZ; ++iZ )
+			{
+				auto it = m_Cells.find( GetCellKey( iX, iY, iZ ) );
+
+				if( it == m_Cells.end() )
+					continue;
+
+				for( auto uiIndex : it->second )
+				{
+					visit( uiIndex );
+				}
+			}
+		}
+	}
+}
+
+void CEntityIndex::FindInBox( const Vector& mins, const Vector& maxs, std::vector<CBaseEntity*>& results )
+{
+	VisitCandidates( mins, maxs, [ & ]( const EntityBounds_t& bounds )
+	{
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			if( bounds.maxs[ iAxis ] < mins[ iAxis ] || bounds.mins[ iAxis ] > maxs[ iAxis ] )
+				return;
+		}
+
+		results.push_back( bounds.pEntity );
+	} );
+}
+
+void CEntityIndex::FindInSphere( const Vector& origin, const float flRadius, std::vector<CBaseEntity*>& results )
+{
+	const float flRadiusSquared = flRadius * flRadius;
+
+	VisitCandidates( origin - Vector( flRadius ), origin + Vector( flRadius ), [ & ]( const EntityBounds_t& bounds )
+	{
+		//Distance from the point to the closest point in the bounds.
+		float flDistanceSquared = 0;
+
+		for( int iAxis = 0; iAxis < 3; ++iAxis )
+		{
+			const float flClosest = std::max( bounds.mins[ iAxis ], std::min( origin[ iAxis ], bounds.maxs[ iAxis ] ) );
+			const float flDelta = origin[ iAxis ] - flClosest;
+
+			flDistanceSquared += flDelta * flDelta;
+		}
+
+		if( flDistanceSquared <= flRadiusSquared )
+			results.push_back( bounds.pEntity );
+	} );
+}
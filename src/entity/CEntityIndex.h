@@ -0,0 +1,117 @@
+#ifndef ENTITY_CENTITYINDEX_H
+#define ENTITY_CENTITYINDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/Mathlib.h"
+
+class CBaseEntity;
+
+/**
+*	Index over a set of entities for fast queries by name and position.
+*	Names are indexed by their interned pointer. Positions are indexed with a uniform grid over the entity bounds:
+*	the bounds of brush entities cover their model, point entities are a point at their origin.
+*	The index is a snapshot; it must be rebuilt when entities change. See CEntityList::GetIndex.
+*	Query results are appended to the given list, in no particular order.
+*/
+class CEntityIndex final
+{
+public:
+	/**
+	*	Size of a grid cell, in units.
+	*/
+	static const int CELL_SIZE = 512;
+
+	/**
+	*	Entities that cover more cells than this are stored in a separate list that every spatial query checks.
+	*/
+	static const size_t MAX_CELLS_PER_ENTITY = 64;
+
+private:
+	typedef std::unordered_multimap<const char*, CBaseEntity*> NameMap_t;
+
+	struct EntityBounds_t
+	{
+		CBaseEntity* pEntity;
+		Vector mins;
+		Vector maxs;
+	};
+
+	typedef std::vector<EntityBounds_t> Bounds_t;
+	typedef std::unordered_map<uint64_t, std::vector<size_t>> Cells_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CEntityIndex() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CEntityIndex() = default;
+
+	/**
+	*	Rebuilds the index.
+	*	@param entities Entities to index.
+	*/
+	void Build( const std::vector<CBaseEntity*>& entities );
+
+	void Clear();
+
+	void FindByClassName( const char* pszClassName, std::vector<CBaseEntity*>& results ) const;
+
+	void FindByTargetName( const char* pszTargetName, std::vector<CBaseEntity*>& results ) const;
+
+	/**
+	*	Finds all entities whose target is the given name.
+	*/
+	void FindByTarget( const char* pszTarget, std::vector<CBaseEntity*>& results ) const;
+
+	/**
+	*	Finds all entities whose bounds intersect the given box.
+	*/
+	void FindInBox( const Vector& mins, const Vector& maxs, std::vector<CBaseEntity*>& results );
+
+	/**
+	*	Finds all entities whose bounds are within the given distance of a point.
+	*/
+	void FindInSphere( const Vector& origin, const float flRadius, std::vector<CBaseEntity*>& results );
+
+private:
+	static void FindByName( const NameMap_t& map, const char* pszName, std::vector<CBaseEntity*>& results );
+
+	/**
+	*	Calls callback for every entity whose bounds might intersect the given box. Every entity is visited at most once.
+	*/
+	template<typename FUNC>
+	void VisitCandidates( const Vector& mins, const Vector& maxs, const FUNC& callback );
+
+private:
+	NameMap_t m_ClassNames;
+	NameMap_t m_TargetNames;
+	NameMap_t m_Targets;
+
+	Bounds_t m_Bounds;
+
+	Cells_t m_Cells;
+
+	/**
+	*	Bounds that cover too many cells.
+	*/
+	std::vector<size_t> m_Oversized;
+
+	/**
+	*	Query number in which each bounds was last visited, to avoid visiting entities that span multiple cells more than once.
+	*/
+	std::vector<uint32_t> m_VisitMarks;
+	uint32_t m_uiVisitMark = 0;
+
+private:
+	CEntityIndex( const CEntityIndex& ) = delete;
+	CEntityIndex& operator=( const CEntityIndex& ) = delete;
+};
+
+#endif //ENTITY_CENTITYINDEX_H
@@ -1,5 +1,11 @@
 #include <cassert>
 #include <cstdio>
+#include <new>
+
+#include "utility/CAtomTable.h"
+#include "utility/CLogger.h"
+
+#include "bsp/BSPRefrag.h"
 
 #include "CBaseEntity.h"
 
@@ -9,20 +15,28 @@ CEntityList g_EntList;
 
 CBaseEntity* CEntityList::GetFirstEntity()
 {
-	return GetNextEntity( nullptr );
+	return !m_Entities.empty() ? m_Entities.front() : nullptr;
 }
 
 CBaseEntity* CEntityList::GetNextEntity( CBaseEntity* pStart )
 {
-	size_t uiIndex = pStart ? pStart->GetEntIndex() + 1 : 0;
+	if( !pStart )
+		return GetFirstEntity();
+
+	const size_t uiIndex = m_Slots[ pStart->GetEntIndex() ].uiDenseIndex + 1;
 
-	for( ; uiIndex < m_Entities.size(); ++uiIndex )
+	return uiIndex < m_Entities.size() ? m_Entities[ uiIndex ] : nullptr;
+}
+
+CEntityIndex& CEntityList::GetIndex()
+{
+	if( m_bIndexDirty )
 	{
-		if( m_Entities[ uiIndex ] )
-			return m_Entities[ uiIndex ];
+		m_Index.Build( m_Entities );
+		m_bIndexDirty = false;
 	}
 
-	return nullptr;
+	return m_Index;
 }
 
 CBaseEntity* CEntityList::Create( const char* const pszClassName )
@@ -31,24 +45,32 @@ CBaseEntity* CEntityList::Create( const char* const pszClassName )
 
 	size_t uiIndex;
 
-	for( uiIndex = 0; uiIndex < m_Entities.size(); ++uiIndex )
+	if( m_uiFirstFree != CBaseEntity::INVALID_ENT_INDEX )
 	{
-		if( !m_Entities[ uiIndex ] )
-			break;
+		uiIndex = m_uiFirstFree;
+		m_uiFirstFree = GetSlot( uiIndex ).uiNextFree;
 	}
+	else
+	{
+		uiIndex = m_Slots.size();
+
+		if( uiIndex % SLOTS_PER_BLOCK == 0 )
+			m_Blocks.emplace_back( new EntitySlot_t[ SLOTS_PER_BLOCK ] );
 
-	if( uiIndex == m_Entities.size() )
-		m_Entities.push_back( nullptr );
+		m_Slots.push_back( { nullptr, 0 } );
+	}
 
-	CBaseEntity* pEntity = new CBaseEntity();
+	CBaseEntity* pEntity = new ( &GetSlot( uiIndex ).storage ) CBaseEntity();
 
-	pEntity->Construct( pszClassName, uiIndex );
+	pEntity->Construct( g_AtomTable.Intern( pszClassName ), uiIndex );
 
 	pEntity->OnCreate();
 
-	m_Entities[ uiIndex ] = pEntity;
+	m_Slots[ uiIndex ] = { pEntity, m_Entities.size() };
 
-	++m_uiCount;
+	m_Entities.push_back( pEntity );
+
+	InvalidateIndex();
 
 	return pEntity;
 }
@@ -60,28 +82,57 @@ void CEntityList::Destroy( CBaseEntity* pEntity )
 
 	const size_t uiIndex = pEntity->GetEntIndex();
 
-	if( m_Entities.size() < uiIndex || m_Entities[ uiIndex ] != pEntity )
+	if( uiIndex >= m_Slots.size() || m_Slots[ uiIndex ].pEntity != pEntity )
 	{
-		printf( "CEntityList::Destroy: Entity index is invalid!\n" );
+		g_Logger.Error( LogCategory::ENTITY, "CEntityList::Destroy: Entity index is invalid!\n" );
 		return;
 	}
 
 	pEntity->OnDestroy();
 
-	delete pEntity;
+	if( pEntity->GetEfrags() )
+		BSP::R_RemoveEfrags( pEntity );
+
+	pEntity->~CBaseEntity();
 
-	m_Entities[ uiIndex ] = nullptr;
+	//Move the last live entity into the destroyed entity's position.
+	const size_t uiDenseIndex = m_Slots[ uiIndex ].uiDenseIndex;
 
-	--m_uiCount;
+	CBaseEntity* pLast = m_Entities.back();
+
+	m_Entities[ uiDenseIndex ] = pLast;
+	m_Slots[ pLast->GetEntIndex() ].uiDenseIndex = uiDenseIndex;
+
+	m_Entities.pop_back();
+
+	m_Slots[ uiIndex ] = { nullptr, 0 };
+
+	GetSlot( uiIndex ).uiNextFree = m_uiFirstFree;
+	m_uiFirstFree = uiIndex;
+
+	InvalidateIndex();
 }
 
 void CEntityList::Clear()
 {
-	for( auto pEntity : m_Entities )
+	while( !m_Entities.empty() )
 	{
-		Destroy( pEntity );
+		Destroy( m_Entities.back() );
 	}
 
 	m_Entities.clear();
 	m_Entities.shrink_to_fit();
+
+	m_Slots.clear();
+	m_Slots.shrink_to_fit();
+
+	m_Blocks.clear();
+	m_Blocks.shrink_to_fit();
+
+	m_uiFirstFree = CBaseEntity::INVALID_ENT_INDEX;
+
+	m_KeyValues.Clear();
+
+	m_Index.Clear();
+	InvalidateIndex();
 }
\ No newline at end of file
@@ -1,28 +1,87 @@
 #ifndef ENTITY_CENTITYLIST_H
 #define ENTITY_CENTITYLIST_H
 
+#include <memory>
+#include <type_traits>
 #include <vector>
 
-class CBaseEntity;
+#include "CBaseEntity.h"
+#include "CEntityIndex.h"
+#include "CKeyValueStore.h"
 
 /**
-*	Nave entity list.
+*	Pooled entity list.
+*	Entities are allocated from fixed size blocks of slots; the entity index is the slot index.
+*	Free slots are linked through the slot storage itself, so creating and destroying an entity is O(1) and doesn't allocate.
+*	Live entities are also kept in a dense array for iteration.
 */
 class CEntityList final
 {
+public:
+	/**
+	*	Number of entity slots per block.
+	*/
+	static const size_t SLOTS_PER_BLOCK = 256;
+
 private:
+	/**
+	*	Storage for a single entity. While the slot is free, it holds the index of the next free slot.
+	*	All entities are CBaseEntity; if entity classes are added, the storage must fit the largest one.
+	*/
+	union EntitySlot_t
+	{
+		std::aligned_storage<sizeof( CBaseEntity ), alignof( CBaseEntity )>::type storage;
+		size_t uiNextFree;
+	};
+
+	typedef std::vector<std::unique_ptr<EntitySlot_t[]>> Blocks_t;
+
+	struct SlotInfo_t
+	{
+		CBaseEntity* pEntity;
+
+		/**
+		*	Index of the entity in the dense array.
+		*/
+		size_t uiDenseIndex;
+	};
+
+	typedef std::vector<SlotInfo_t> Slots_t;
 	typedef std::vector<CBaseEntity*> Entities_t;
 
 public:
 	CEntityList() = default;
-	~CEntityList() = default;
+	~CEntityList()
+	{
+		Clear();
+	}
 
-	size_t GetEntityCount() const { return m_uiCount; }
+	size_t GetEntityCount() const { return m_Entities.size(); }
 
 	CBaseEntity* GetFirstEntity();
 
 	CBaseEntity* GetNextEntity( CBaseEntity* pStart );
 
+	/**
+	*	@return All live entities. Entities keep their position until an entity in front of them is destroyed.
+	*/
+	const Entities_t& GetEntities() const { return m_Entities; }
+
+	/**
+	*	@return The keyvalues of all entities.
+	*/
+	CKeyValueStore& GetKeyValues() { return m_KeyValues; }
+
+	/**
+	*	@return Index for queries by name and position. Rebuilt if entities have changed since it was last built.
+	*/
+	CEntityIndex& GetIndex();
+
+	/**
+	*	Marks the index as out of date. Called when entities are created or destroyed, or when a keyvalue changes.
+	*/
+	void InvalidateIndex() { m_bIndexDirty = true; }
+
 	CBaseEntity* Create( const char* const pszClassName );
 
 	void Destroy( CBaseEntity* pEntity );
@@ -30,9 +89,31 @@ public:
 	void Clear();
 
 private:
+	EntitySlot_t& GetSlot( const size_t uiIndex )
+	{
+		return m_Blocks[ uiIndex / SLOTS_PER_BLOCK ][ uiIndex % SLOTS_PER_BLOCK ];
+	}
+
+private:
+	Blocks_t m_Blocks;
+
+	/**
+	*	Per slot bookkeeping, indexed by entity index.
+	*/
+	Slots_t m_Slots;
+
+	/**
+	*	Live entities.
+	*/
 	Entities_t m_Entities;
 
-	size_t m_uiCount = 0;
+	size_t m_uiFirstFree = CBaseEntity::INVALID_ENT_INDEX;
+
+	CKeyValueStore m_KeyValues;
+
+	CEntityIndex m_Index;
+
+	bool m_bIndexDirty = true;
 
 private:
 	CEntityList( const CEntityList& ) = delete;
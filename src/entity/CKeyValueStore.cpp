@@ -0,0 +1,50 @@
+#include <cassert>
+
+#include "utility/CAtomTable.h"
+
+#include "CKeyValueStore.h"
+
+size_t CKeyValueStore::Add( const char* pszKey, const char* pszValue, const size_t uiTail )
+{
+	assert( pszKey );
+	assert( pszValue );
+	assert( uiTail == INVALID_INDEX || uiTail < m_KeyValues.size() );
+
+	const size_t uiIndex = m_KeyValues.size();
+
+	m_KeyValues.push_back( { g_AtomTable.Intern( pszKey ), m_Values.Add( pszValue ), INVALID_INDEX } );
+
+	if( uiTail != INVALID_INDEX )
+		m_KeyValues[ uiTail ].uiNext = uiIndex;
+
+	return uiIndex;
+}
+
+const char* CKeyValueStore::Find( const size_t uiFirst, const char* pszKey ) const
+{
+	assert( pszKey );
+
+	//Keys are interned, so a key that was never interned was never stored.
+	const char* pszAtom = g_AtomTable.Find( pszKey );
+
+	if( !pszAtom )
+		return nullptr;
+
+	const char* pszValue = nullptr;
+
+	for( size_t uiIndex = uiFirst; uiIndex != INVALID_INDEX; uiIndex = m_KeyValues[ uiIndex ].uiNext )
+	{
+		if( m_KeyValues[ uiIndex ].pszKey == pszAtom )
+			pszValue = m_KeyValues[ uiIndex ].pszValue;
+	}
+
+	return pszValue;
+}
+
+void CKeyValueStore::Clear()
+{
+	m_KeyValues.clear();
+	m_KeyValues.shrink_to_fit();
+
+	m_Values.Clear();
+}
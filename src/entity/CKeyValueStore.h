@@ -0,0 +1,91 @@
+#ifndef ENTITY_CKEYVALUESTORE_H
+#define ENTITY_CKEYVALUESTORE_H
+
+#include <vector>
+
+#include "utility/CStringArena.h"
+
+/**
+*	Stores the keyvalues of all entities in a single flat array. Values are packed into a string arena and keys are interned in g_AtomTable.
+*	The keyvalues of an entity form a chain through the array, in the order they were set.
+*	Keyvalues are only freed when the store is cleared.
+*/
+class CKeyValueStore final
+{
+public:
+	static const size_t INVALID_INDEX = static_cast<size_t>( -1 );
+
+	struct KeyValue_t
+	{
+		/**
+		*	Interned key.
+		*/
+		const char* pszKey;
+
+		const char* pszValue;
+
+		/**
+		*	Index of the next keyvalue in the chain, or INVALID_INDEX.
+		*/
+		size_t uiNext;
+	};
+
+private:
+	typedef std::vector<KeyValue_t> KeyValues_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CKeyValueStore() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CKeyValueStore() = default;
+
+	/**
+	*	@return The number of stored keyvalues.
+	*/
+	size_t GetCount() const { return m_KeyValues.size(); }
+
+	/**
+	*	@return The amount of memory used by keyvalues and values.
+	*/
+	size_t GetMemoryUsage() const { return m_KeyValues.capacity() * sizeof( KeyValue_t ) + m_Values.GetMemoryUsage(); }
+
+	const KeyValue_t& Get( const size_t uiIndex ) const { return m_KeyValues[ uiIndex ]; }
+
+	/**
+	*	Stores a keyvalue.
+	*	@param pszKey Key.
+	*	@param pszValue Value.
+	*	@param uiTail Last keyvalue of the chain to append to, or INVALID_INDEX to start a new chain.
+	*	@return Index of the new keyvalue.
+	*/
+	size_t Add( const char* pszKey, const char* pszValue, const size_t uiTail );
+
+	/**
+	*	Finds the value of a key in a chain. If the key was set more than once, the last value is returned.
+	*	@param uiFirst First keyvalue in the chain.
+	*	@param pszKey Key to find.
+	*	@return The value, or null if the key isn't in the chain.
+	*/
+	const char* Find( const size_t uiFirst, const char* pszKey ) const;
+
+	/**
+	*	Removes all keyvalues.
+	*/
+	void Clear();
+
+private:
+	KeyValues_t m_KeyValues;
+
+	CStringArena m_Values;
+
+private:
+	CKeyValueStore( const CKeyValueStore& ) = delete;
+	CKeyValueStore& operator=( const CKeyValueStore& ) = delete;
+};
+
+#endif //ENTITY_CKEYVALUESTORE_H
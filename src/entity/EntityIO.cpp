@@ -21,10 +21,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 *	@file EntityIO.cpp
 *	Modified version of Quake's entity loading code used to load Half-Life entities into memory for BSP rendering only. - Solokiller
 */
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <future>
 
+#include "utility/CThreadPool.h"
+#include "utility/CTokenizer.h"
 #include "utility/Tokenization.h"
+#include "utility/CLogger.h"
+#include "utility/CProfiler.h"
 
 #include "CBaseEntity.h"
 #include "CEntityList.h"
@@ -44,7 +50,7 @@ bool ED_FindClassName( char* data )
 			break;
 		if( !data )
 		{
-			printf( "ED_ParseEntity: EOF without closing brace\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEntity: EOF without closing brace\n" );
 			return false;
 		}
 
@@ -62,13 +68,13 @@ bool ED_FindClassName( char* data )
 		data = COM_Parse( data );
 		if( !data )
 		{
-			printf( "ED_ParseEntity: EOF without closing brace\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEntity: EOF without closing brace\n" );
 			return false;
 		}
 
 		if( com_token[ 0 ] == '}' )
 		{
-			printf( "ED_ParseEntity: closing brace without data\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEntity: closing brace without data\n" );
 			return false;
 		}
 
@@ -91,7 +97,7 @@ bool ED_ParseEdict( char *data, char*& pszOut, CBaseEntity*& pEnt )
 
 	if( !ED_FindClassName( data ) )
 	{
-		printf( "ED_ParseEdict: couldn't find classname\n" );
+		g_Logger.Error( LogCategory::ENTITY, "ED_ParseEdict: couldn't find classname\n" );
 		return false;
 	}
 
@@ -99,7 +105,7 @@ bool ED_ParseEdict( char *data, char*& pszOut, CBaseEntity*& pEnt )
 
 	if( !pEntity )
 	{
-		printf( "ED_ParseEdict: Couldn't create entity '%s'\n", com_token );
+		g_Logger.Error( LogCategory::ENTITY, "ED_ParseEdict: Couldn't create entity '%s'\n", com_token );
 		return false;
 	}
 
@@ -112,7 +118,7 @@ bool ED_ParseEdict( char *data, char*& pszOut, CBaseEntity*& pEnt )
 			break;
 		if( !data )
 		{
-			printf( "ED_ParseEntity: EOF without closing brace\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEntity: EOF without closing brace\n" );
 			g_EntList.Destroy( pEntity );
 			return false;
 		}
@@ -145,14 +151,14 @@ bool ED_ParseEdict( char *data, char*& pszOut, CBaseEntity*& pEnt )
 		data = COM_Parse( data );
 		if( !data )
 		{
-			printf( "ED_ParseEntity: EOF without closing brace\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEntity: EOF without closing brace\n" );
 			g_EntList.Destroy( pEntity );
 			return false;
 		}
 
 		if( com_token[ 0 ] == '}' )
 		{
-			printf( "ED_ParseEntity: closing brace without data\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEntity: closing brace without data\n" );
 			g_EntList.Destroy( pEntity );
 			return false;
 		}
@@ -174,7 +180,7 @@ bool ED_ParseEdict( char *data, char*& pszOut, CBaseEntity*& pEnt )
 		if( !pEntity->KeyValue( keyname, com_token ) )
 		{
 			/*
-			printf( "ED_ParseEdict: parse error\n" );
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEdict: parse error\n" );
 			g_EntList.Destroy( pEntity );
 			return false;
 			*/
@@ -188,27 +194,211 @@ bool ED_ParseEdict( char *data, char*& pszOut, CBaseEntity*& pEnt )
 	return true;
 }
 
+/**
+*	Finds the start of every entity block. Stops at the first block that isn't closed properly.
+*	@return false if a token other than an opening brace was found where a block was expected.
+*/
+static bool ED_FindEntityBlocks( const char* pszData, std::vector<const char*>& blocks, std::string& szUnexpectedToken )
+{
+	CTokenizer tokenizer( pszData );
+
+	CStringView token;
+
+	while( tokenizer.Next( token ) )
+	{
+		if( token.GetFirst() != '{' )
+		{
+			szUnexpectedToken = token.ToString();
+			return false;
+		}
+
+		blocks.push_back( tokenizer.GetPosition() );
+
+		bool bClosed = false;
+
+		//Skip over the key/value pairs. Errors are reported when the block is parsed.
+		while( tokenizer.Next( token ) )
+		{
+			if( token.GetFirst() == '}' )
+			{
+				bClosed = true;
+				break;
+			}
+
+			if( !tokenizer.Next( token ) || token.GetFirst() == '}' )
+				break;
+		}
+
+		if( !bClosed )
+			break;
+	}
+
+	return true;
+}
+
+/**
+*	Parses the key/values of a single entity block. Matches ED_FindClassName and ED_ParseEdict.
+*/
+static void ED_ParseEntityRecord( const char* pszBlock, EntityRecord_t& record )
+{
+	CTokenizer tokenizer( pszBlock );
+
+	CStringView key;
+	CStringView value;
+
+	while( true )
+	{
+		// parse key
+		const bool bHasKey = tokenizer.Next( key );
+
+		if( key.GetFirst() == '}' )
+			break;
+
+		if( !bHasKey )
+		{
+			record.pszError = "ED_ParseEntity: EOF without closing brace\n";
+			return;
+		}
+
+		// parse value
+		if( !tokenizer.Next( value ) )
+		{
+			record.pszError = "ED_ParseEntity: EOF without closing brace\n";
+			return;
+		}
+
+		if( value.GetFirst() == '}' )
+		{
+			record.pszError = "ED_ParseEntity: closing brace without data\n";
+			return;
+		}
+
+		// anglehack is to allow QuakeEd to write single scalar angles
+		// and allow them to be turned into vectors. (FIXME...)
+		const bool bAngleHack = key == "angle";
+
+		CStringView keyName = key;
+
+		if( bAngleHack )
+			keyName = "angles";
+		// FIXME: change light to _light to get rid of this hack
+		else if( key == "light" )
+			keyName = "light_lev";	// hack for single light def
+
+		// another hack to fix heynames with trailing spaces
+		keyName.TrimEnd();
+
+		if( !record.bHasClassName && keyName == "classname" )
+		{
+			record.szClassName = value.ToString();
+			record.bHasClassName = true;
+		}
+
+		// keynames with a leading underscore are used for utility comments,
+		// and are immediately discarded by quake
+		if( keyName.GetFirst() == '_' )
+			continue;
+
+		EntityKeyValue_t keyValue;
+
+		keyValue.szKey = keyName.ToString();
+
+		if( bAngleHack )
+		{
+			keyValue.szValue = "0 ";
+			keyValue.szValue.append( value.GetData(), value.GetLength() );
+			keyValue.szValue += " 0";
+		}
+		else
+			keyValue.szValue = value.ToString();
+
+		record.keyValues.emplace_back( std::move( keyValue ) );
+	}
+}
+
+bool ED_ParseEntityRecords( const char* pszData, std::vector<EntityRecord_t>& records, std::string& szUnexpectedToken )
+{
+	PROFILE_FUNCTION();
+
+	records.clear();
+	szUnexpectedToken.clear();
+
+	std::vector<const char*> blocks;
+
+	const bool bSuccess = ED_FindEntityBlocks( pszData, blocks, szUnexpectedToken );
+
+	records.resize( blocks.size() );
+
+	std::vector<std::future<void>> tasks;
+
+	tasks.reserve( ( blocks.size() + ENTITY_PARSE_BATCH_SIZE - 1 ) / ENTITY_PARSE_BATCH_SIZE );
+
+	//Each task writes to its own range of records.
+	for( size_t uiFirst = 0; uiFirst < blocks.size(); uiFirst += ENTITY_PARSE_BATCH_SIZE )
+	{
+		const size_t uiLast = std::min( uiFirst + ENTITY_PARSE_BATCH_SIZE, blocks.size() );
+
+		tasks.emplace_back( g_ThreadPool.Enqueue( [ &blocks, &records, uiFirst, uiLast ]()
+		{
+			PROFILE_SCOPE( "Parse entity batch" );
+
+			for( size_t uiIndex = uiFirst; uiIndex < uiLast; ++uiIndex )
+			{
+				ED_ParseEntityRecord( blocks[ uiIndex ], records[ uiIndex ] );
+			}
+		} ) );
+	}
+
+	for( auto& task : tasks )
+	{
+		task.wait();
+	}
+
+	return bSuccess;
+}
+
 bool ED_LoadFromFile( char *data )
 {
+	PROFILE_FUNCTION();
+
 	int inhibit = 0;
 
-	CBaseEntity* pEnt;
+	std::vector<EntityRecord_t> records;
+	std::string szUnexpectedToken;
 
-	// parse ents
-	while( 1 )
+	const bool bFoundAllBlocks = ED_ParseEntityRecords( data, records, szUnexpectedToken );
+
+	//Entities are created in the order they appear in the data so entity indices don't depend on parse order.
+	for( const auto& record : records )
 	{
-		// parse the opening brace	
-		data = COM_Parse( data );
-		if( !data )
-			break;
-		if( com_token[ 0 ] != '{' )
+		if( !record.bHasClassName )
 		{
-			printf( "ED_LoadFromFile: found %s when expecting {", com_token );
+			if( record.pszError )
+				g_Logger.Error( LogCategory::ENTITY, "%s", record.pszError );
+
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEdict: couldn't find classname\n" );
 			return false;
 		}
 
-		if( !ED_ParseEdict( data, data, pEnt ) )
+		CBaseEntity* pEntity = g_EntList.Create( record.szClassName.c_str() );
+
+		if( !pEntity )
+		{
+			g_Logger.Error( LogCategory::ENTITY, "ED_ParseEdict: Couldn't create entity '%s'\n", record.szClassName.c_str() );
 			return false;
+		}
+
+		for( const auto& keyValue : record.keyValues )
+		{
+			pEntity->KeyValue( keyValue.szKey.c_str(), keyValue.szValue.c_str() );
+		}
+
+		if( record.pszError )
+		{
+			g_Logger.Error( LogCategory::ENTITY, "%s", record.pszError );
+			g_EntList.Destroy( pEntity );
+			return false;
+		}
 
 		// remove things from different skill levels or deathmatch
 		/*
@@ -223,10 +413,16 @@ bool ED_LoadFromFile( char *data )
 		}
 		*/
 
-		pEnt->Spawn();
+		pEntity->Spawn();
+	}
+
+	if( !bFoundAllBlocks )
+	{
+		g_Logger.Error( LogCategory::ENTITY, "ED_LoadFromFile: found %s when expecting {\n", szUnexpectedToken.c_str() );
+		return false;
 	}
 
-	printf( "%i entities inhibited\n", inhibit );
+	g_Logger.Info( LogCategory::ENTITY, "%i entities inhibited\n", inhibit );
 
 	return true;
 }
\ No newline at end of file
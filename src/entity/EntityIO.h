@@ -20,8 +20,43 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef ENTITY_ENTITYIO_H
 #define ENTITY_ENTITYIO_H
 
+#include <string>
+#include <vector>
+
 class CBaseEntity;
 
+/**
+*	Number of entity blocks parsed by a single task in ED_ParseEntityRecords.
+*/
+const size_t ENTITY_PARSE_BATCH_SIZE = 64;
+
+struct EntityKeyValue_t
+{
+	std::string szKey;
+	std::string szValue;
+};
+
+/**
+*	Key/values of an entity block, parsed ahead of entity creation.
+*	The angle and light hacks have been applied and keys with a leading underscore have been removed.
+*/
+struct EntityRecord_t
+{
+	std::vector<EntityKeyValue_t> keyValues;
+
+	/**
+	*	Value of the first classname key.
+	*/
+	std::string szClassName;
+
+	bool bHasClassName = false;
+
+	/**
+	*	If the block is malformed, the error message. keyValues contains the pairs before the error.
+	*/
+	const char* pszError = nullptr;
+};
+
 /**
 *	Finds the classname of an entity in the given entity data block.
 *	@return true if a classname was found, false otherwise.
@@ -56,4 +91,15 @@ to call ED_CallSpawnFunctions () to let the objects initialize themselves.
 */
 bool ED_LoadFromFile( char *data );
 
+/**
+*	Parses all entity blocks in the given entity data into records without creating any entities.
+*	Blocks are located first, then parsed in batches on the thread pool. Records are in the same order as the blocks.
+*	Parsing stops at the first malformed block; its record contains the error.
+*	@param pszData Null terminated entity data.
+*	@param records Parsed records.
+*	@param szUnexpectedToken If a token other than an opening brace was found where a block was expected, the token.
+*	@return false if a token other than an opening brace was found, true otherwise.
+*/
+bool ED_ParseEntityRecords( const char* pszData, std::vector<EntityRecord_t>& records, std::string& szUnexpectedToken );
+
 #endif //ENTITY_ENTITYIO_H
\ No newline at end of file
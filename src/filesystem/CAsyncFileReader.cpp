@@ -0,0 +1,32 @@
+#include <cassert>
+#include <string>
+
+#include "CFileSystem.h"
+
+#include "CAsyncFileReader.h"
+
+CAsyncFileReader g_AsyncFileReader;
+
+bool CAsyncFileReader::Initialize( const size_t uiNumThreads )
+{
+	return m_ThreadPool.Initialize( uiNumThreads );
+}
+
+void CAsyncFileReader::Shutdown()
+{
+	m_ThreadPool.Shutdown();
+}
+
+std::future<CFileData> CAsyncFileReader::Read( const char* const pszFileName )
+{
+	assert( pszFileName );
+
+	//The caller's buffer may be gone by the time the read starts.
+	std::string szFileName( pszFileName );
+
+	return m_ThreadPool.Enqueue( [ szFileName ]()
+	{
+		return g_FileSystem.LoadFile( szFileName.c_str() );
+	}
+	);
+}
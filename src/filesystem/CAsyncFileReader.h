@@ -0,0 +1,67 @@
+#ifndef FILESYSTEM_CASYNCFILEREADER_H
+#define FILESYSTEM_CASYNCFILEREADER_H
+
+#include <future>
+
+#include "utility/CThreadPool.h"
+
+#include "CFileData.h"
+
+/**
+*	Reads files in the background so that multiple reads can be in flight at the same time.
+*	Reads are performed by a pool of I/O threads; if the reader isn't initialized, files are read on the calling thread.
+*/
+class CAsyncFileReader final
+{
+public:
+	/**
+	*	Default number of I/O threads. Reads mostly wait on the disk or network, so this doesn't depend on the number of cores.
+	*/
+	static const size_t DEFAULT_NUM_THREADS = 4;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CAsyncFileReader() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CAsyncFileReader() = default;
+
+	/**
+	*	@return Whether the reader is initialized.
+	*/
+	bool IsInitialized() const { return m_ThreadPool.IsInitialized(); }
+
+	/**
+	*	Starts the I/O threads.
+	*	@param uiNumThreads Number of I/O threads.
+	*	@return Whether initialization succeeded.
+	*/
+	bool Initialize( const size_t uiNumThreads = DEFAULT_NUM_THREADS );
+
+	/**
+	*	Waits for all pending reads to finish and stops the I/O threads.
+	*/
+	void Shutdown();
+
+	/**
+	*	Starts reading a file.
+	*	@param pszFileName Name of the file to read.
+	*	@return Future that receives the file data. The data is not valid if the file couldn't be read.
+	*/
+	std::future<CFileData> Read( const char* const pszFileName );
+
+private:
+	CThreadPool m_ThreadPool;
+
+private:
+	CAsyncFileReader( const CAsyncFileReader& ) = delete;
+	CAsyncFileReader& operator=( const CAsyncFileReader& ) = delete;
+};
+
+extern CAsyncFileReader g_AsyncFileReader;
+
+#endif //FILESYSTEM_CASYNCFILEREADER_H
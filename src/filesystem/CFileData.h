@@ -0,0 +1,102 @@
+#ifndef FILESYSTEM_CFILEDATA_H
+#define FILESYSTEM_CFILEDATA_H
+
+#include <memory>
+
+#include "common/Const.h"
+
+#include "CMappedFile.h"
+
+/**
+*	Contents of a file that was loaded into memory.
+*	The contents are either read into a buffer or are a copy-on-write view of a mapped file. Both can be modified in place.
+*/
+class CFileData final
+{
+public:
+	/**
+	*	Constructs empty file data.
+	*/
+	CFileData() = default;
+
+	/**
+	*	Constructor.
+	*	@param data Data to take ownership of.
+	*	@param uiSize Size of the data in bytes.
+	*/
+	CFileData( std::unique_ptr<byte[]>&& data, const size_t uiSize )
+		: m_Buffer( std::move( data ) )
+		, m_pData( m_Buffer.get() )
+		, m_uiSize( uiSize )
+	{
+	}
+
+	/**
+	*	Constructor.
+	*	@param view Mapped view to take ownership of.
+	*/
+	CFileData( std::unique_ptr<CMappedView>&& view )
+		: m_View( std::move( view ) )
+		, m_pData( m_View ? m_View->GetData() : nullptr )
+		, m_uiSize( m_View ? m_View->GetSize() : 0 )
+	{
+	}
+
+	CFileData( CFileData&& other )
+		: m_Buffer( std::move( other.m_Buffer ) )
+		, m_View( std::move( other.m_View ) )
+		, m_pData( other.m_pData )
+		, m_uiSize( other.m_uiSize )
+	{
+		other.m_pData = nullptr;
+		other.m_uiSize = 0;
+	}
+
+	CFileData& operator=( CFileData&& other )
+	{
+		if( this != &other )
+		{
+			m_Buffer = std::move( other.m_Buffer );
+			m_View = std::move( other.m_View );
+			m_pData = other.m_pData;
+			m_uiSize = other.m_uiSize;
+
+			other.m_pData = nullptr;
+			other.m_uiSize = 0;
+		}
+
+		return *this;
+	}
+
+	/**
+	*	@return Whether this contains the contents of a file.
+	*/
+	bool IsValid() const { return m_pData != nullptr; }
+
+	/**
+	*	@return Whether this is a view of a mapped file.
+	*/
+	bool IsMapped() const { return m_View != nullptr; }
+
+	const byte* GetData() const { return m_pData; }
+
+	byte* GetData() { return m_pData; }
+
+	/**
+	*	@return Size of the data in bytes.
+	*/
+	size_t GetSize() const { return m_uiSize; }
+
+private:
+	std::unique_ptr<byte[]> m_Buffer;
+	std::unique_ptr<CMappedView> m_View;
+
+	byte* m_pData = nullptr;
+	size_t m_uiSize = 0;
+
+private:
+	CFileData( const CFileData& ) = delete;
+	CFileData& operator=( const CFileData& ) = delete;
+};
+
+#endif //FILESYSTEM_CFILEDATA_H
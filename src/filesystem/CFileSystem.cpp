@@ -0,0 +1,222 @@
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include "utility/CLogger.h"
+
+#include "CPakFile.h"
+#include "CSearchPath.h"
+#include "FileIO.h"
+
+#include "CFileSystem.h"
+
+CFileSystem g_FileSystem;
+
+CFileSystem::~CFileSystem()
+{
+	Shutdown();
+}
+
+void CFileSystem::AddSearchPath( const char* const pszPath )
+{
+	assert( pszPath );
+
+	if( !pszPath )
+		return;
+
+	auto searchPath = std::make_unique<CSearchPath>( pszPath );
+
+	searchPath->Mount();
+
+	g_Logger.Info( LogCategory::FILESYSTEM, "Added search path \"%s\" (%u pak files, %u loose files)\n", 
+			pszPath, searchPath->GetNumPakFiles(), searchPath->GetNumLooseFiles() );
+
+	std::lock_guard<std::shared_timed_mutex> searchPathsLock( m_SearchPathsMutex );
+
+	m_SearchPaths.emplace_back( std::move( searchPath ) );
+
+	//Files that were missing may be in the new search path.
+	std::lock_guard<std::mutex> lock( m_MissingFilesMutex );
+
+	m_MissingFiles.clear();
+}
+
+void CFileSystem::Refresh()
+{
+	std::lock_guard<std::shared_timed_mutex> searchPathsLock( m_SearchPathsMutex );
+
+	for( auto& searchPath : m_SearchPaths )
+	{
+		searchPath->RefreshDirectoryListing();
+	}
+
+	std::lock_guard<std::mutex> lock( m_MissingFilesMutex );
+
+	m_MissingFiles.clear();
+}
+
+void CFileSystem::Shutdown()
+{
+	std::lock_guard<std::shared_timed_mutex> searchPathsLock( m_SearchPathsMutex );
+
+	m_SearchPaths.clear();
+	m_SearchPaths.shrink_to_fit();
+
+	std::lock_guard<std::mutex> lock( m_MissingFilesMutex );
+
+	m_MissingFiles.clear();
+}
+
+bool CFileSystem::FileExists( const char* const pszFileName ) const
+{
+	assert( pszFileName );
+
+	char szName[ MAX_PATH_LENGTH ];
+
+	if( !NormalizeFileName( pszFileName, szName, sizeof( szName ) ) )
+		return false;
+
+	FileLocation_t location;
+
+	return FindFile( szName, location );
+}
+
+CFileData CFileSystem::LoadFile( const char* const pszFileName ) const
+{
+	assert( pszFileName );
+
+	char szName[ MAX_PATH_LENGTH ];
+
+	if( !NormalizeFileName( pszFileName, szName, sizeof( szName ) ) )
+		return CFileData();
+
+	FileLocation_t location;
+
+	if( !FindFile( szName, location ) )
+		return CFileData();
+
+	if( location.pPakFile )
+		return location.pPakFile->LoadFile( location.pEntry );
+
+	char szPath[ MAX_PATH_LENGTH ];
+
+	if( !GetLoosePath( *location.pSearchPath, szName, szPath, sizeof( szPath ) ) )
+		return CFileData();
+
+	return ::LoadFile( szPath );
+}
+
+bool CFileSystem::ReadFileRange( const char* const pszFileName, const size_t uiOffset, void* pBuffer, const size_t uiSize ) const
+{
+	assert( pszFileName );
+
+	char szName[ MAX_PATH_LENGTH ];
+
+	if( !NormalizeFileName( pszFileName, szName, sizeof( szName ) ) )
+		return false;
+
+	FileLocation_t location;
+
+	if( !FindFile( szName, location ) )
+		return false;
+
+	if( location.pPakFile )
+		return location.pPakFile->ReadFileRange( location.pEntry, uiOffset, pBuffer, uiSize );
+
+	char szPath[ MAX_PATH_LENGTH ];
+
+	if( !GetLoosePath( *location.pSearchPath, szName, szPath, sizeof( szPath ) ) )
+		return false;
+
+	return ::ReadFileRange( szPath, uiOffset, pBuffer, uiSize );
+}
+
+bool CFileSystem::GetLooseFilePath( const char* const pszFileName, char* pszPath, const size_t uiBufferSize, bool& bInPak ) const
+{
+	assert( pszFileName );
+	assert( pszPath );
+
+	bInPak = false;
+
+	char szName[ MAX_PATH_LENGTH ];
+
+	if( !NormalizeFileName( pszFileName, szName, sizeof( szName ) ) )
+		return false;
+
+	FileLocation_t location;
+
+	if( !FindFile( szName, location ) )
+		return false;
+
+	if( location.pPakFile )
+	{
+		bInPak = true;
+		return false;
+	}
+
+	return GetLoosePath( *location.pSearchPath, szName, pszPath, uiBufferSize );
+}
+
+bool CFileSystem::NormalizeFileName( const char* const pszFileName, char* pszBuffer, const size_t uiBufferSize )
+{
+	const size_t uiLength = strlen( pszFileName );
+
+	if( uiLength >= uiBufferSize )
+		return false;
+
+	for( size_t uiIndex = 0; uiIndex <= uiLength; ++uiIndex )
+	{
+		pszBuffer[ uiIndex ] = pszFileName[ uiIndex ] == '\\' ? '/' : tolower( pszFileName[ uiIndex ] );
+	}
+
+	return true;
+}
+
+bool CFileSystem::FindFile( const char* const pszFileName, FileLocation_t& location ) const
+{
+	{
+		std::lock_guard<std::mutex> lock( m_MissingFilesMutex );
+
+		if( m_MissingFiles.find( pszFileName ) != m_MissingFiles.end() )
+			return false;
+	}
+
+	//Held until the file is remembered as missing, so a concurrent refresh can't be undone by a stale result.
+	std::shared_lock<std::shared_timed_mutex> searchPathsLock( m_SearchPathsMutex );
+
+	for( const auto& searchPath : m_SearchPaths )
+	{
+		if( auto pEntry = searchPath->FindPakEntry( pszFileName, location.pPakFile ) )
+		{
+			location.pSearchPath = searchPath.get();
+			location.pEntry = pEntry;
+			return true;
+		}
+
+		if( searchPath->HasLooseFile( pszFileName ) )
+		{
+			location.pSearchPath = searchPath.get();
+			location.pPakFile = nullptr;
+			location.pEntry = nullptr;
+			return true;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock( m_MissingFilesMutex );
+
+	//Keep the set from growing without bound if many different names are looked up.
+	if( m_MissingFiles.size() >= MAX_MISSING_FILES )
+		m_MissingFiles.clear();
+
+	m_MissingFiles.emplace( pszFileName );
+
+	return false;
+}
+
+bool CFileSystem::GetLoosePath( const CSearchPath& searchPath, const char* const pszFileName, char* pszPath, const size_t uiBufferSize )
+{
+	const int iResult = snprintf( pszPath, uiBufferSize, "%s/%s", searchPath.GetPath(), pszFileName );
+
+	return iResult >= 0 && static_cast<size_t>( iResult ) < uiBufferSize;
+}
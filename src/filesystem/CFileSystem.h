@@ -0,0 +1,158 @@
+#ifndef FILESYSTEM_CFILESYSTEM_H
+#define FILESYSTEM_CFILESYSTEM_H
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "core/Platform.h"
+
+#include "CFileData.h"
+#include "PakFile.h"
+
+class CPakFile;
+class CSearchPath;
+
+/**
+*	Provides access to the files in the game directories.
+*	Files are looked up in each search path in the order they were added: first in the search path's pak files,
+*	the last pak file that was mounted being searched first, then as loose files.
+*	Loose files are found using a directory listing that is made when a search path is added,
+*	and files that were not found are remembered, so failed lookups don't touch the disk.
+*	Paths are relative to the search paths. Lookups can be done from any thread, also while search paths are added or refreshed.
+*	Shutdown requires that no lookups are in progress.
+*/
+class CFileSystem final
+{
+private:
+	typedef std::vector<std::unique_ptr<CSearchPath>> SearchPaths_t;
+	typedef std::unordered_set<std::string> MissingFiles_t;
+
+	/**
+	*	Maximum number of missing files that are remembered. The set is cleared when it is full.
+	*/
+	static const size_t MAX_MISSING_FILES = 4096;
+
+	/**
+	*	Where a file was found.
+	*/
+	struct FileLocation_t
+	{
+		const CSearchPath* pSearchPath = nullptr;
+
+		/**
+		*	If not null, the file is in this pak. Otherwise it's a loose file.
+		*/
+		const CPakFile* pPakFile = nullptr;
+		const dpackfile_t* pEntry = nullptr;
+	};
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CFileSystem() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CFileSystem();
+
+	/**
+	*	@return The number of search paths.
+	*/
+	size_t GetNumSearchPaths() const { return m_SearchPaths.size(); }
+
+	/**
+	*	Adds a search path and mounts the pak files in it. Search paths are searched in the order that they were added,
+	*	so the game directory should be added before the directories it falls back to.
+	*	@param pszPath Path to the directory.
+	*/
+	void AddSearchPath( const char* const pszPath );
+
+	/**
+	*	Lists the search path directories again and forgets which files were not found.
+	*	Should be called if files were added to the search paths.
+	*/
+	void Refresh();
+
+	/**
+	*	Removes all search paths. No lookups may be in progress.
+	*/
+	void Shutdown();
+
+	/**
+	*	@return Whether the given file exists.
+	*/
+	bool FileExists( const char* const pszFileName ) const;
+
+	/**
+	*	Loads a file. Files in pak files are not copied, the data is a view of the mapped pak.
+	*	@param pszFileName Name of the file to load.
+	*	@return File data. Not valid if the file could not be found or read.
+	*/
+	CFileData LoadFile( const char* const pszFileName ) const;
+
+	/**
+	*	Reads part of a file into a buffer.
+	*	@param pszFileName Name of the file to read from.
+	*	@param uiOffset Offset in the file to start reading at.
+	*	@param pBuffer Buffer to read into.
+	*	@param uiSize Number of bytes to read.
+	*	@return Whether all bytes were read.
+	*/
+	bool ReadFileRange( const char* const pszFileName, const size_t uiOffset, void* pBuffer, const size_t uiSize ) const;
+
+	/**
+	*	Gets the path on disk of a loose file, for files that have to be opened directly, like memory mapped files.
+	*	@param pszFileName Name of the file.
+	*	@param pszPath Receives the path.
+	*	@param uiBufferSize Size of the path buffer.
+	*	@param bInPak Set to whether the file was found in a pak file. Files in pak files have no path of their own.
+	*	@return Whether the file was found as a loose file and the path fit in the buffer.
+	*/
+	bool GetLooseFilePath( const char* const pszFileName, char* pszPath, const size_t uiBufferSize, bool& bInPak ) const;
+
+private:
+	/**
+	*	Converts a filename to the format used for lookups: lowercase, using forward slashes.
+	*	@return Whether the name fit in the buffer.
+	*/
+	static bool NormalizeFileName( const char* const pszFileName, char* pszBuffer, const size_t uiBufferSize );
+
+	/**
+	*	Finds a file in the search paths.
+	*	@param pszFileName Normalized name of the file.
+	*	@param location Receives the location of the file.
+	*	@return Whether the file was found.
+	*/
+	bool FindFile( const char* const pszFileName, FileLocation_t& location ) const;
+
+	/**
+	*	Builds the path to a loose file.
+	*	@return Whether the path fit in the buffer.
+	*/
+	static bool GetLoosePath( const CSearchPath& searchPath, const char* const pszFileName, char* pszPath, const size_t uiBufferSize );
+
+private:
+	/**
+	*	Lookups hold a shared lock on the search paths and their directory listings, adding and refreshing them an exclusive lock.
+	*/
+	mutable std::shared_timed_mutex m_SearchPathsMutex;
+
+	SearchPaths_t m_SearchPaths;
+
+	mutable std::mutex m_MissingFilesMutex;
+	mutable MissingFiles_t m_MissingFiles;
+
+private:
+	CFileSystem( const CFileSystem& ) = delete;
+	CFileSystem& operator=( const CFileSystem& ) = delete;
+};
+
+extern CFileSystem g_FileSystem;
+
+#endif //FILESYSTEM_CFILESYSTEM_H
@@ -0,0 +1,97 @@
+#include <cassert>
+
+#include "CMappedFile.h"
+
+/**
+*	Views must start at a multiple of the allocation granularity.
+*/
+static size_t GetAllocationGranularity()
+{
+	static size_t uiGranularity = 0;
+
+	if( !uiGranularity )
+	{
+		SYSTEM_INFO info;
+
+		GetSystemInfo( &info );
+
+		uiGranularity = info.dwAllocationGranularity;
+	}
+
+	return uiGranularity;
+}
+
+CMappedView::~CMappedView()
+{
+	UnmapViewOfFile( m_pBase );
+}
+
+bool CMappedFile::Open( const char* const pszFileName )
+{
+	assert( pszFileName );
+
+	Close();
+
+	m_hFile = CreateFileA( pszFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+	if( m_hFile == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER size;
+
+	//Empty files can't be mapped.
+	if( !GetFileSizeEx( m_hFile, &size ) || size.QuadPart == 0 )
+	{
+		Close();
+		return false;
+	}
+
+	//Copy-on-write so views can be modified in place, like a file that was read into memory.
+	m_hMapping = CreateFileMapping( m_hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+
+	if( !m_hMapping )
+	{
+		Close();
+		return false;
+	}
+
+	m_uiSize = static_cast<size_t>( size.QuadPart );
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if( m_hMapping )
+	{
+		CloseHandle( m_hMapping );
+		m_hMapping = nullptr;
+	}
+
+	if( m_hFile != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( m_hFile );
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+
+	m_uiSize = 0;
+}
+
+std::unique_ptr<CMappedView> CMappedFile::MapView( const size_t uiOffset, const size_t uiSize ) const
+{
+	if( !IsOpen() || uiSize == 0 || uiOffset > m_uiSize || uiSize > m_uiSize - uiOffset )
+		return nullptr;
+
+	const size_t uiDelta = uiOffset % GetAllocationGranularity();
+
+	const unsigned long long ullStart = uiOffset - uiDelta;
+
+	void* pBase = MapViewOfFile( m_hMapping, FILE_MAP_COPY, 
+								 static_cast<DWORD>( ullStart >> 32 ), static_cast<DWORD>( ullStart & 0xFFFFFFFF ), 
+								 uiSize + uiDelta );
+
+	if( !pBase )
+		return nullptr;
+
+	return std::make_unique<CMappedView>( pBase, reinterpret_cast<byte*>( pBase ) + uiDelta, uiSize );
+}
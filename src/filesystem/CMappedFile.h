@@ -0,0 +1,113 @@
+#ifndef FILESYSTEM_CMAPPEDFILE_H
+#define FILESYSTEM_CMAPPEDFILE_H
+
+#include <memory>
+
+#include "core/Platform.h"
+#include "common/Const.h"
+
+/**
+*	View of part of a memory mapped file. The view is copy-on-write: writes only affect this view, not the file or other views.
+*	The view stays valid after the file it was mapped from is closed.
+*/
+class CMappedView final
+{
+public:
+	/**
+	*	Constructor.
+	*	@param pBase Address returned by the operating system. This is aligned to the allocation granularity.
+	*	@param pData Start of the requested data within the view.
+	*	@param uiSize Size of the requested data in bytes.
+	*/
+	CMappedView( void* pBase, byte* pData, const size_t uiSize )
+		: m_pBase( pBase )
+		, m_pData( pData )
+		, m_uiSize( uiSize )
+	{
+	}
+
+	/**
+	*	Destructor. Unmaps the view.
+	*/
+	~CMappedView();
+
+	byte* GetData() { return m_pData; }
+
+	const byte* GetData() const { return m_pData; }
+
+	/**
+	*	@return Size of the view in bytes.
+	*/
+	size_t GetSize() const { return m_uiSize; }
+
+private:
+	void* m_pBase;
+	byte* m_pData;
+	size_t m_uiSize;
+
+private:
+	CMappedView( const CMappedView& ) = delete;
+	CMappedView& operator=( const CMappedView& ) = delete;
+};
+
+/**
+*	A file that is mapped into memory. Parts of the file are accessed by mapping views of it.
+*/
+class CMappedFile final
+{
+public:
+	/**
+	*	Constructor.
+	*/
+	CMappedFile() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CMappedFile()
+	{
+		Close();
+	}
+
+	/**
+	*	@return Whether a file is open.
+	*/
+	bool IsOpen() const { return m_hMapping != nullptr; }
+
+	/**
+	*	@return Size of the file in bytes.
+	*/
+	size_t GetSize() const { return m_uiSize; }
+
+	/**
+	*	Opens a file for mapping. Closes the previously opened file, if any.
+	*	@param pszFileName Name of the file to open.
+	*	@return Whether the file was opened.
+	*/
+	bool Open( const char* const pszFileName );
+
+	/**
+	*	Closes the file. Views that are still mapped remain valid.
+	*/
+	void Close();
+
+	/**
+	*	Maps a view of part of the file.
+	*	@param uiOffset Offset in the file.
+	*	@param uiSize Number of bytes to map. Must be larger than 0.
+	*	@return View, or null if the range is invalid or the view could not be mapped.
+	*/
+	std::unique_ptr<CMappedView> MapView( const size_t uiOffset, const size_t uiSize ) const;
+
+private:
+	HANDLE m_hFile = INVALID_HANDLE_VALUE;
+	HANDLE m_hMapping = nullptr;
+
+	size_t m_uiSize = 0;
+
+private:
+	CMappedFile( const CMappedFile& ) = delete;
+	CMappedFile& operator=( const CMappedFile& ) = delete;
+};
+
+#endif //FILESYSTEM_CMAPPEDFILE_H
@@ -0,0 +1,143 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "utility/ByteSwap.h"
+#include "utility/CLogger.h"
+
+#include "CPakFile.h"
+
+bool CPakFile::Open( const char* const pszFileName )
+{
+	assert( pszFileName );
+
+	Close();
+
+	if( !m_File.Open( pszFileName ) )
+		return false;
+
+	dpackheader_t header;
+
+	{
+		auto view = m_File.MapView( 0, sizeof( header ) );
+
+		if( !view )
+		{
+			g_Logger.Error( LogCategory::FILESYSTEM, "CPakFile::Open: File \"%s\" is too small to be a pak file\n", pszFileName );
+			Close();
+			return false;
+		}
+
+		memcpy( &header, view->GetData(), sizeof( header ) );
+	}
+
+	if( strncmp( PAK_ID, header.id, sizeof( header.id ) ) )
+	{
+		g_Logger.Error( LogCategory::FILESYSTEM, "CPakFile::Open: File \"%s\" is not a pak file\n", pszFileName );
+		Close();
+		return false;
+	}
+
+	header.dirofs = LittleValue( header.dirofs );
+	header.dirlen = LittleValue( header.dirlen );
+
+	if( header.dirofs < 0 || header.dirlen < 0 || ( header.dirlen % sizeof( dpackfile_t ) ) )
+	{
+		g_Logger.Error( LogCategory::FILESYSTEM, "CPakFile::Open: Pak file \"%s\" has an invalid directory\n", pszFileName );
+		Close();
+		return false;
+	}
+
+	const size_t uiNumEntries = header.dirlen / sizeof( dpackfile_t );
+
+	if( uiNumEntries > 0 )
+	{
+		auto view = m_File.MapView( header.dirofs, header.dirlen );
+
+		if( !view )
+		{
+			g_Logger.Error( LogCategory::FILESYSTEM, "CPakFile::Open: Pak file \"%s\" has an invalid directory\n", pszFileName );
+			Close();
+			return false;
+		}
+
+		m_Entries.resize( uiNumEntries );
+
+		memcpy( m_Entries.data(), view->GetData(), header.dirlen );
+	}
+
+	m_EntryMap.reserve( uiNumEntries );
+
+	//Entries are not moved after this, so the names can be used as keys.
+	for( size_t uiIndex = 0; uiIndex < uiNumEntries; ++uiIndex )
+	{
+		auto& entry = m_Entries[ uiIndex ];
+
+		entry.name[ sizeof( entry.name ) - 1 ] = '\0';
+		entry.filepos = LittleValue( entry.filepos );
+		entry.filelen = LittleValue( entry.filelen );
+
+		if( entry.filepos < 0 || entry.filelen < 0 || 
+			static_cast<size_t>( entry.filepos ) + static_cast<size_t>( entry.filelen ) > m_File.GetSize() )
+		{
+			g_Logger.Warning( LogCategory::FILESYSTEM, "CPakFile::Open: Pak file \"%s\" entry \"%s\" is out of range, ignoring\n", pszFileName, entry.name );
+			continue;
+		}
+
+		//Later entries override earlier ones.
+		m_EntryMap[ entry.name ] = uiIndex;
+	}
+
+	strncpy( m_szFileName, pszFileName, sizeof( m_szFileName ) );
+	m_szFileName[ sizeof( m_szFileName ) - 1 ] = '\0';
+
+	return true;
+}
+
+void CPakFile::Close()
+{
+	m_EntryMap.clear();
+	m_Entries.clear();
+	m_Entries.shrink_to_fit();
+
+	m_File.Close();
+
+	m_szFileName[ 0 ] = '\0';
+}
+
+const dpackfile_t* CPakFile::FindEntry( const char* const pszFileName ) const
+{
+	assert( pszFileName );
+
+	auto it = m_EntryMap.find( pszFileName );
+
+	if( it != m_EntryMap.end() )
+		return &m_Entries[ it->second ];
+
+	return nullptr;
+}
+
+CFileData CPakFile::LoadFile( const dpackfile_t* pEntry ) const
+{
+	assert( pEntry );
+
+	return CFileData( m_File.MapView( pEntry->filepos, pEntry->filelen ) );
+}
+
+bool CPakFile::ReadFileRange( const dpackfile_t* pEntry, const size_t uiOffset, void* pBuffer, const size_t uiSize ) const
+{
+	assert( pEntry );
+	assert( pBuffer );
+
+	if( uiOffset > static_cast<size_t>( pEntry->filelen ) || uiSize > pEntry->filelen - uiOffset )
+		return false;
+
+	auto view = m_File.MapView( pEntry->filepos + uiOffset, uiSize );
+
+	if( !view )
+		return false;
+
+	memcpy( pBuffer, view->GetData(), uiSize );
+
+	return true;
+}
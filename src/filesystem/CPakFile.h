@@ -0,0 +1,98 @@
+#ifndef FILESYSTEM_CPAKFILE_H
+#define FILESYSTEM_CPAKFILE_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/Platform.h"
+#include "common/StringUtils.h"
+
+#include "CFileData.h"
+#include "CMappedFile.h"
+#include "PakFile.h"
+
+/**
+*	A mounted pak file. The archive is memory mapped; files are served as views of the mapping, so loading them doesn't copy the data.
+*/
+class CPakFile final
+{
+private:
+	typedef std::vector<dpackfile_t> Entries_t;
+	typedef std::unordered_map<const char*, size_t, RawCharHashI, RawCharEqualToI> EntryMap_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CPakFile() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CPakFile() = default;
+
+	/**
+	*	@return Whether a pak file is open.
+	*/
+	bool IsOpen() const { return m_File.IsOpen(); }
+
+	/**
+	*	@return Name of the pak file.
+	*/
+	const char* GetFileName() const { return m_szFileName; }
+
+	/**
+	*	@return Number of files in the pak.
+	*/
+	size_t GetNumEntries() const { return m_Entries.size(); }
+
+	/**
+	*	Opens a pak file and builds the index of its files.
+	*	@param pszFileName Name of the pak file.
+	*	@return Whether the pak file was opened.
+	*/
+	bool Open( const char* const pszFileName );
+
+	/**
+	*	Closes the pak file. Files that were loaded from it remain valid.
+	*/
+	void Close();
+
+	/**
+	*	Finds a file in the pak.
+	*	@param pszFileName Name of the file, using forward slashes. Case insensitive.
+	*	@return Entry, or null if the file isn't in the pak.
+	*/
+	const dpackfile_t* FindEntry( const char* const pszFileName ) const;
+
+	/**
+	*	Loads a file from the pak.
+	*	@param pEntry Entry of the file to load.
+	*	@return File data. Not valid if the file couldn't be mapped.
+	*/
+	CFileData LoadFile( const dpackfile_t* pEntry ) const;
+
+	/**
+	*	Reads part of a file from the pak into a buffer.
+	*	@param pEntry Entry of the file to read from.
+	*	@param uiOffset Offset in the file to start reading at.
+	*	@param pBuffer Buffer to read into.
+	*	@param uiSize Number of bytes to read.
+	*	@return Whether all bytes were read.
+	*/
+	bool ReadFileRange( const dpackfile_t* pEntry, const size_t uiOffset, void* pBuffer, const size_t uiSize ) const;
+
+private:
+	char m_szFileName[ MAX_PATH_LENGTH ] = { '\0' };
+
+	CMappedFile m_File;
+
+	Entries_t m_Entries;
+	EntryMap_t m_EntryMap;
+
+private:
+	CPakFile( const CPakFile& ) = delete;
+	CPakFile& operator=( const CPakFile& ) = delete;
+};
+
+#endif //FILESYSTEM_CPAKFILE_H
@@ -0,0 +1,135 @@
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include "utility/CLogger.h"
+
+#include "CPakFile.h"
+
+#include "CSearchPath.h"
+
+CSearchPath::CSearchPath( const char* const pszPath )
+{
+	assert( pszPath );
+
+	strncpy( m_szPath, pszPath, sizeof( m_szPath ) );
+
+	m_szPath[ sizeof( m_szPath ) - 1 ] = '\0';
+}
+
+CSearchPath::~CSearchPath()
+{
+}
+
+void CSearchPath::Mount()
+{
+	m_PakFiles.clear();
+
+	char szPath[ MAX_PATH_LENGTH ];
+
+	for( int iPak = 0; ; ++iPak )
+	{
+		const int iResult = snprintf( szPath, sizeof( szPath ), "%s/pak%d%s", m_szPath, iPak, PAK_FILE_EXT );
+
+		if( iResult < 0 || static_cast<size_t>( iResult ) >= sizeof( szPath ) )
+			break;
+
+		auto pak = std::make_unique<CPakFile>();
+
+		if( !pak->Open( szPath ) )
+			break;
+
+		g_Logger.Info( LogCategory::FILESYSTEM, "Mounted pak file \"%s\" (%u files)\n", szPath, pak->GetNumEntries() );
+
+		m_PakFiles.emplace_back( std::move( pak ) );
+	}
+
+	RefreshDirectoryListing();
+}
+
+void CSearchPath::RefreshDirectoryListing()
+{
+	m_Files.clear();
+
+	ListDirectory( "" );
+}
+
+const dpackfile_t* CSearchPath::FindPakEntry( const char* const pszFileName, const CPakFile*& pPakFile ) const
+{
+	assert( pszFileName );
+
+	for( auto it = m_PakFiles.rbegin(); it != m_PakFiles.rend(); ++it )
+	{
+		if( auto pEntry = ( *it )->FindEntry( pszFileName ) )
+		{
+			pPakFile = it->get();
+			return pEntry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool CSearchPath::HasLooseFile( const char* const pszFileName ) const
+{
+	assert( pszFileName );
+
+	return m_Files.find( pszFileName ) != m_Files.end();
+}
+
+void CSearchPath::ListDirectory( const char* const pszRelativePath )
+{
+	char szSearch[ MAX_PATH_LENGTH ];
+
+	int iResult;
+
+	if( *pszRelativePath )
+		iResult = snprintf( szSearch, sizeof( szSearch ), "%s/%s/*", m_szPath, pszRelativePath );
+	else
+		iResult = snprintf( szSearch, sizeof( szSearch ), "%s/*", m_szPath );
+
+	if( iResult < 0 || static_cast<size_t>( iResult ) >= sizeof( szSearch ) )
+		return;
+
+	WIN32_FIND_DATAA findData;
+
+	HANDLE hFind = FindFirstFileA( szSearch, &findData );
+
+	if( hFind == INVALID_HANDLE_VALUE )
+		return;
+
+	char szName[ MAX_PATH_LENGTH ];
+
+	do
+	{
+		if( strcmp( findData.cFileName, "." ) == 0 || strcmp( findData.cFileName, ".." ) == 0 )
+			continue;
+
+		if( *pszRelativePath )
+			iResult = snprintf( szName, sizeof( szName ), "%s/%s", pszRelativePath, findData.cFileName );
+		else
+			iResult = snprintf( szName, sizeof( szName ), "%s", findData.cFileName );
+
+		if( iResult < 0 || static_cast<size_t>( iResult ) >= sizeof( szName ) )
+			continue;
+
+		if( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+		{
+			ListDirectory( szName );
+		}
+		else
+		{
+			//Lookups are case insensitive.
+			for( char* pszChar = szName; *pszChar; ++pszChar )
+			{
+				*pszChar = tolower( *pszChar );
+			}
+
+			m_Files.emplace( szName );
+		}
+	}
+	while( FindNextFileA( hFind, &findData ) );
+
+	FindClose( hFind );
+}
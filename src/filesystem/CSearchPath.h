@@ -0,0 +1,95 @@
+#ifndef FILESYSTEM_CSEARCHPATH_H
+#define FILESYSTEM_CSEARCHPATH_H
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "core/Platform.h"
+
+#include "PakFile.h"
+
+class CPakFile;
+
+/**
+*	A directory that is searched for files, along with the pak files in it.
+*	The directory is listed once when it is mounted so looking up loose files doesn't need to touch the disk.
+*/
+class CSearchPath final
+{
+private:
+	typedef std::vector<std::unique_ptr<CPakFile>> PakFiles_t;
+	typedef std::unordered_set<std::string> Files_t;
+
+public:
+	/**
+	*	Constructor.
+	*	@param pszPath Path to the directory.
+	*/
+	CSearchPath( const char* const pszPath );
+
+	/**
+	*	Destructor.
+	*/
+	~CSearchPath();
+
+	/**
+	*	@return Path to the directory.
+	*/
+	const char* GetPath() const { return m_szPath; }
+
+	/**
+	*	@return Number of pak files that are mounted.
+	*/
+	size_t GetNumPakFiles() const { return m_PakFiles.size(); }
+
+	/**
+	*	@return Number of loose files in the directory listing.
+	*/
+	size_t GetNumLooseFiles() const { return m_Files.size(); }
+
+	/**
+	*	Mounts the pak files in the directory. pak0.pak, pak1.pak, etc. are mounted until one is missing.
+	*	Also lists the directory.
+	*/
+	void Mount();
+
+	/**
+	*	Lists all files in the directory and its subdirectories again.
+	*/
+	void RefreshDirectoryListing();
+
+	/**
+	*	Finds a file in the pak files. The last mounted pak is searched first.
+	*	@param pszFileName Normalized name of the file.
+	*	@param pPakFile If the file was found, receives the pak that contains it.
+	*	@return Entry, or null if the file isn't in any pak.
+	*/
+	const dpackfile_t* FindPakEntry( const char* const pszFileName, const CPakFile*& pPakFile ) const;
+
+	/**
+	*	@param pszFileName Normalized name of the file.
+	*	@return Whether the file exists as a loose file in this directory, according to the directory listing.
+	*/
+	bool HasLooseFile( const char* const pszFileName ) const;
+
+private:
+	void ListDirectory( const char* const pszRelativePath );
+
+private:
+	char m_szPath[ MAX_PATH_LENGTH ];
+
+	PakFiles_t m_PakFiles;
+
+	/**
+	*	Relative paths of all loose files, lowercase, using forward slashes.
+	*/
+	Files_t m_Files;
+
+private:
+	CSearchPath( const CSearchPath& ) = delete;
+	CSearchPath& operator=( const CSearchPath& ) = delete;
+};
+
+#endif //FILESYSTEM_CSEARCHPATH_H
@@ -0,0 +1,56 @@
+#include <cassert>
+#include <cstdio>
+
+#include "utility/CLogger.h"
+
+#include "FileIO.h"
+
+CFileData LoadFile( const char* const pszFileName )
+{
+	assert( pszFileName );
+
+	FILE* pFile = fopen( pszFileName, "rb" );
+
+	if( !pFile )
+		return CFileData();
+
+	fseek( pFile, 0, SEEK_END );
+
+	const size_t size = ftell( pFile );
+
+	fseek( pFile, 0, SEEK_SET );
+
+	std::unique_ptr<byte[]> data( new byte[ size ] );
+
+	const size_t readCount = fread( data.get(), 1, size, pFile );
+
+	fclose( pFile );
+
+	if( readCount != size )
+	{
+		g_Logger.Error( LogCategory::FILESYSTEM, "LoadFile: Error reading file \"%s\": expected %u bytes, read %u\n", pszFileName, size, readCount );
+		return CFileData();
+	}
+
+	return CFileData( std::move( data ), size );
+}
+
+bool ReadFileRange( const char* const pszFileName, const size_t uiOffset, void* pBuffer, const size_t uiSize )
+{
+	assert( pszFileName );
+	assert( pBuffer );
+
+	FILE* pFile = fopen( pszFileName, "rb" );
+
+	if( !pFile )
+		return false;
+
+	bool bSuccess = fseek( pFile, static_cast<long>( uiOffset ), SEEK_SET ) == 0;
+
+	if( bSuccess )
+		bSuccess = fread( pBuffer, 1, uiSize, pFile ) == uiSize;
+
+	fclose( pFile );
+
+	return bSuccess;
+}
@@ -0,0 +1,23 @@
+#ifndef FILESYSTEM_FILEIO_H
+#define FILESYSTEM_FILEIO_H
+
+#include "CFileData.h"
+
+/**
+*	Loads a file into memory.
+*	@param pszFileName Name of the file to load.
+*	@return File data. Not valid if the file could not be opened or read.
+*/
+CFileData LoadFile( const char* const pszFileName );
+
+/**
+*	Reads part of a file into a buffer.
+*	@param pszFileName Name of the file to read from.
+*	@param uiOffset Offset in the file to start reading at.
+*	@param pBuffer Buffer to read into.
+*	@param uiSize Number of bytes to read.
+*	@return Whether all bytes were read.
+*/
+bool ReadFileRange( const char* const pszFileName, const size_t uiOffset, void* pBuffer, const size_t uiSize );
+
+#endif //FILESYSTEM_FILEIO_H
@@ -0,0 +1,71 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*
+*	This product contains software technology licensed from Id
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+*	All Rights Reserved.
+*
+****/
+#ifndef FILESYSTEM_PAKFILE_H
+#define FILESYSTEM_PAKFILE_H
+
+/**
+*	File extension for pak files.
+*/
+#define PAK_FILE_EXT ".pak"
+
+/**
+*	Identifier for pak files.
+*/
+#define PAK_ID "PACK"
+
+/**
+*	Maximum size that a pak entry name can be, including the null terminator.
+*/
+#define PAK_MAX_NAME_SIZE 56
+
+/**
+*	Pak file header.
+*/
+struct dpackheader_t
+{
+	/**
+	*	Should be PACK.
+	*/
+	char id[ 4 ];
+
+	/**
+	*	Offset in this file where the directory starts.
+	*/
+	int dirofs;
+
+	/**
+	*	Size of the directory in bytes.
+	*/
+	int dirlen;
+};
+
+/**
+*	A single file entry in the pak directory.
+*/
+struct dpackfile_t
+{
+	/**
+	*	Path of the file, using forward slashes.
+	*	Must be null terminated.
+	*/
+	char name[ PAK_MAX_NAME_SIZE ];
+
+	/**
+	*	Offset in the pak where the file's data starts.
+	*/
+	int filepos;
+
+	/**
+	*	Size of the file's data.
+	*/
+	int filelen;
+};
+
+#endif //FILESYSTEM_PAKFILE_H
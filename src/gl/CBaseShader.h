@@ -1,7 +1,9 @@
 #ifndef GL_CBASESHADER_H
 #define GL_CBASESHADER_H
 
-#include <vector>
+#include <array>
+#include <cstdint>
+#include <utility>
 
 #include <gl/glew.h>
 
@@ -9,6 +11,8 @@
 
 #include "GLUtil.h"
 
+#include "ShaderFeatures.h"
+
 class CBaseEntity;
 
 #define SHADER_BASE_DIR "shaders/"
@@ -37,175 +41,203 @@ enum class AttributeType
 };
 
 /**
-*	Represents a single attribute.
+*	Represents a single attribute or uniform.
+*	Attributes are constant expressions, so a shader's attribute and uniform tables are built at compile time.
 */
-class CBaseShaderAttribute
+class CBaseShaderAttribute final
 {
 public:
-	static const size_t INVALID_INDEX = -1;
-
-public:
-	CBaseShaderAttribute( const char* const pszName, const AttributeType type, const bool bIsVarying )
+	constexpr CBaseShaderAttribute( const char* const pszName, const size_t uiIndex, const AttributeType type, const bool bIsVarying, const uint32_t uiFeatures )
 		: m_pszName( pszName )
+		, m_uiIndex( uiIndex )
 		, m_Type( type )
 		, m_bIsVarying( bIsVarying )
+		, m_uiFeatures( uiFeatures )
 	{
 	}
 
-	const char* GetName() const { return m_pszName; }
+	constexpr const char* GetName() const { return m_pszName; }
 
-	AttributeType GetType() const { return m_Type; }
+	constexpr AttributeType GetType() const { return m_Type; }
 
 	/**
 	*	@return Whether this attribute is varying (true) or uniform (false).
 	*/
-	bool IsVarying() const { return m_bIsVarying; }
+	constexpr bool IsVarying() const { return m_bIsVarying; }
 
-	size_t GetIndex() const { return m_uiIndex; }
+	constexpr size_t GetIndex() const { return m_uiIndex; }
 
-	operator size_t() const { return m_uiIndex; }
+	/**
+	*	@return Features that use this uniform. If 0, every permutation must use it.
+	*	Otherwise only permutations that have one of the features must use it; others may have had it optimized out.
+	*/
+	constexpr uint32_t GetFeatures() const { return m_uiFeatures; }
+
+	constexpr operator size_t() const { return m_uiIndex; }
 
 private:
 	/**
 	*	Name of the attribute as defined in the shader.
 	*/
 	const char* const m_pszName;
+
+	const size_t m_uiIndex;
+
 	const AttributeType m_Type;
 
 	const bool m_bIsVarying;
 
-protected:
-	size_t m_uiIndex = INVALID_INDEX;
+	const uint32_t m_uiFeatures;
 };
 
-class CBaseShaderOutput
+class CBaseShaderOutput final
 {
 public:
-	CBaseShaderOutput( const char* const pszName )
+	constexpr CBaseShaderOutput( const char* const pszName, const size_t uiIndex )
 		: m_pszName( pszName )
+		, m_uiIndex( uiIndex )
 	{
 	}
 
-	const char* GetName() const { return m_pszName; }
+	constexpr const char* GetName() const { return m_pszName; }
+
+	constexpr size_t GetIndex() const { return m_uiIndex; }
 
 private:
 	const char* const m_pszName;
+
+	const size_t m_uiIndex;
 };
 
+/**
+*	Shaders are declared in sections: features, attributes, uniforms, outputs, then the class. Every section is required, even if it is empty.
+*	Each section numbers its entries with __COUNTER__ and specializes kind##At_t for every index,
+*	which the END macro expands into a constexpr table. No registration happens at runtime.
+*/
 #define BEGIN_SHADER( shaderName )											\
 namespace shaderName														\
 {																			\
-	static const char* const g_pszName = #shaderName;						\
-	class CShaderAttribute;													\
-																			\
-	static std::vector<CShaderAttribute*> g_Attributes;						\
-																			\
-	class CShaderAttribute final : public CBaseShaderAttribute				\
-	{																		\
-	public:																	\
-		CShaderAttribute( 													\
-			const char* const pszName, const AttributeType type )			\
-			: CBaseShaderAttribute( pszName, type, true )					\
-		{																	\
-			m_uiIndex = g_Attributes.size();								\
-																			\
-			g_Attributes.push_back( this );									\
-		}																	\
-	};																		\
-																			\
-	class CShaderUniform;													\
-																			\
-	static std::vector<CShaderUniform*> g_Uniforms;							\
-																			\
-	class CShaderUniform final : public CBaseShaderAttribute				\
-	{																		\
-	public:																	\
-		CShaderUniform( 													\
-			const char* const pszName, const AttributeType type )			\
-			: CBaseShaderAttribute( pszName, type, false )					\
-		{																	\
-			m_uiIndex = g_Uniforms.size();									\
-																			\
-			g_Uniforms.push_back( this );									\
-		}																	\
-	};																		\
-																			\
-	class CShaderOutput;													\
-																			\
-	static std::vector<CShaderOutput*> g_Outputs;							\
-																			\
-	class CShaderOutput final : public CBaseShaderOutput					\
-	{																		\
-	public:																	\
-		CShaderOutput( const char* const pszName )							\
-			: CBaseShaderOutput( pszName )									\
-		{																	\
-			g_Outputs.push_back( this );									\
-		}																	\
-	};
+	static const char* const g_pszName = #shaderName;
 
 #define END_SHADER()		\
 	} g_Instance;			\
 }
 
-#define SHADER_ATTRIB( name, type ) static CShaderAttribute name( #name, AttributeType::type );
-
-#define SHADER_UNIFORM( name, type ) static CShaderUniform name( #name, AttributeType::type );
-
-#define SHADER_OUTPUT( name ) static CShaderOutput name( #name );
-
-#define BEGIN_SHADER_ATTRIBS()
-
-#define END_SHADER_ATTRIBS() BEGIN_SHADER_CLASS()
-
-#define BEGIN_SHADER_CLASS()													\
-class CShader : public CBaseShader												\
-{																				\
-public:																			\
-																				\
-	CShader()																	\
-		: CBaseShader()															\
-	{																			\
-	}																			\
-																				\
-	const char* GetName() const override										\
-	{																			\
-		return g_pszName;														\
-	}																			\
-																				\
-	size_t GetNumAttributes() const override									\
-	{																			\
-		return g_Attributes.size();												\
-	}																			\
-																				\
-	CBaseShaderAttribute* GetAttribute( const size_t uiIndex ) const override	\
-	{																			\
-		return g_Attributes[ uiIndex ];											\
-	}																			\
-																				\
-	size_t GetNumUniforms() const override										\
-	{																			\
-		return g_Uniforms.size();												\
-	}																			\
-																				\
-	CBaseShaderAttribute* GetUniform( const size_t uiIndex ) const override		\
-	{																			\
-		return g_Uniforms[ uiIndex ];											\
-	}																			\
-																				\
-	size_t GetNumOutputs() const override										\
-	{																			\
-		return g_Outputs.size();												\
-	}																			\
-																				\
-	CBaseShaderOutput* GetOutput( const size_t uiIndex ) const override			\
-	{																			\
-		return g_Outputs[ uiIndex ];											\
+/**
+*	Declares the ShaderFeature flags that the shader supports. Flags that a shader doesn't support are ignored when selecting a permutation.
+*/
+#define SHADER_FEATURES( features ) static constexpr uint32_t g_uiFeatures = features;
+
+#define BEGIN_SHADER_TABLE( kind )															\
+	static constexpr size_t g_ui##kind##CounterBase = __COUNTER__ + 1;						\
+																							\
+	template<size_t INDEX>																	\
+	struct kind##At_t;
+
+#define END_SHADER_TABLE( kind, type )														\
+	static constexpr size_t g_uiNum##kind##s = __COUNTER__ - g_ui##kind##CounterBase;		\
+																							\
+	template<size_t... INDICES>																\
+	constexpr std::array<const type*, sizeof...( INDICES )>									\
+	Make##kind##Table( std::index_sequence<INDICES...> )									\
+	{																						\
+		return {{ kind##At_t<INDICES>::Get()... }};											\
+	}																						\
+																							\
+	static constexpr std::array<const type*, g_uiNum##kind##s> g_##kind##s =				\
+		Make##kind##Table( std::make_index_sequence<g_uiNum##kind##s>() );
+
+/**
+*	@return Index of the next entry in a table.
+*/
+#define SHADER_TABLE_INDEX( kind ) ( __COUNTER__ - g_ui##kind##CounterBase )
+
+#define SHADER_TABLE_ENTRY( kind, type, name, args )										\
+	static constexpr type name args;														\
+																							\
+	template<>																				\
+	struct kind##At_t<name.GetIndex()>														\
+	{																						\
+		static constexpr const type* Get() { return &name; }								\
+	};
+
+#define BEGIN_SHADER_ATTRIBS() BEGIN_SHADER_TABLE( Attribute )
+
+#define END_SHADER_ATTRIBS() END_SHADER_TABLE( Attribute, CBaseShaderAttribute )
+
+#define BEGIN_SHADER_UNIFORMS() BEGIN_SHADER_TABLE( Uniform )
+
+#define END_SHADER_UNIFORMS() END_SHADER_TABLE( Uniform, CBaseShaderAttribute )
+
+#define BEGIN_SHADER_OUTPUTS() BEGIN_SHADER_TABLE( Output )
+
+#define END_SHADER_OUTPUTS() END_SHADER_TABLE( Output, CBaseShaderOutput )
+
+#define SHADER_ATTRIB( name, type ) SHADER_TABLE_ENTRY( Attribute, CBaseShaderAttribute, name, ( #name, SHADER_TABLE_INDEX( Attribute ), AttributeType::type, true, 0 ) )
+
+#define SHADER_UNIFORM( name, type ) SHADER_FEATURE_UNIFORM( name, type, 0 )
+
+/**
+*	Declares a uniform that is only used by permutations with one of the given features.
+*/
+#define SHADER_FEATURE_UNIFORM( name, type, features ) SHADER_TABLE_ENTRY( Uniform, CBaseShaderAttribute, name, ( #name, SHADER_TABLE_INDEX( Uniform ), AttributeType::type, false, features ) )
+
+#define SHADER_OUTPUT( name ) SHADER_TABLE_ENTRY( Output, CBaseShaderOutput, name, ( #name, SHADER_TABLE_INDEX( Output ) ) )
+
+#define BEGIN_SHADER_CLASS()														\
+class CShader : public CBaseShader													\
+{																					\
+public:																				\
+																					\
+	CShader()																		\
+		: CBaseShader()																\
+	{																				\
+	}																				\
+																					\
+	const char* GetName() const override											\
+	{																				\
+		return g_pszName;															\
+	}																				\
+																					\
+	uint32_t GetFeatures() const override											\
+	{																				\
+		return g_uiFeatures;														\
+	}																				\
+																					\
+	size_t GetNumAttributes() const override										\
+	{																				\
+		return g_uiNumAttributes;													\
+	}																				\
+																					\
+	const CBaseShaderAttribute* GetAttribute( const size_t uiIndex ) const override	\
+	{																				\
+		return g_Attributes[ uiIndex ];												\
+	}																				\
+																					\
+	size_t GetNumUniforms() const override											\
+	{																				\
+		return g_uiNumUniforms;														\
+	}																				\
+																					\
+	const CBaseShaderAttribute* GetUniform( const size_t uiIndex ) const override	\
+	{																				\
+		return g_Uniforms[ uiIndex ];												\
+	}																				\
+																					\
+	size_t GetNumOutputs() const override											\
+	{																				\
+		return g_uiNumOutputs;														\
+	}																				\
+																					\
+	const CBaseShaderOutput* GetOutput( const size_t uiIndex ) const override		\
+	{																				\
+		return g_Outputs[ uiIndex ];												\
 	}
 
 #define SHADER_ACTIVATE void Activate( CShaderInstance* pInstance, const CBaseEntity* pEntity ) override
 
-#define SHADER_DRAW void OnDraw( CShaderInstance* pInstance, const size_t uiNumVerts ) override
+#define SHADER_DRAW void OnDraw( CShaderInstance* pInstance, const GLint* pFirsts, const GLsizei* pCounts, const size_t uiNumDraws ) override
+
 
 class CShaderInstance;
 
@@ -229,18 +261,30 @@ public:
 
 	virtual const char* GetName() const = 0;
 
+	/**
+	*	@return ShaderFeature flags that this shader has permutations for.
+	*/
+	virtual uint32_t GetFeatures() const = 0;
+
 	virtual size_t GetNumAttributes() const = 0;
-	virtual CBaseShaderAttribute* GetAttribute( const size_t uiIndex ) const = 0;
+	virtual const CBaseShaderAttribute* GetAttribute( const size_t uiIndex ) const = 0;
 
 	virtual size_t GetNumUniforms() const = 0;
-	virtual CBaseShaderAttribute* GetUniform( const size_t uiIndex ) const = 0;
+	virtual const CBaseShaderAttribute* GetUniform( const size_t uiIndex ) const = 0;
 
 	virtual size_t GetNumOutputs() const = 0;
-	virtual CBaseShaderOutput* GetOutput( const size_t uiIndex ) const = 0;
+	virtual const CBaseShaderOutput* GetOutput( const size_t uiIndex ) const = 0;
 
 	virtual void Activate( CShaderInstance* pInstance, const CBaseEntity* pEntity ) {}
 
-	virtual void OnDraw( CShaderInstance* pInstance, const size_t uiNumVerts ) = 0;
+	/**
+	*	Draws a batch of vertex ranges from the bound vertex array.
+	*	@param pInstance Shader instance that is drawing.
+	*	@param pFirsts First vertex of each range.
+	*	@param pCounts Number of vertices in each range.
+	*	@param uiNumDraws Number of ranges.
+	*/
+	virtual void OnDraw( CShaderInstance* pInstance, const GLint* pFirsts, const GLsizei* pCounts, const size_t uiNumDraws ) = 0;
 
 private:
 	static CBaseShader* m_pHead;
@@ -0,0 +1,206 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "utility/CLogger.h"
+
+#include "CGLDiagnostics.h"
+
+CGLDiagnostics g_GLDiagnostics;
+
+/**
+*	Id used for debug groups and markers inserted by the application.
+*/
+static const GLuint APPLICATION_MESSAGE_ID = 0;
+
+static const char* GetSourceName( const GLenum source )
+{
+	switch( source )
+	{
+	case GL_DEBUG_SOURCE_API:				return "API";
+	case GL_DEBUG_SOURCE_WINDOW_SYSTEM:		return "Window system";
+	case GL_DEBUG_SOURCE_SHADER_COMPILER:	return "Shader compiler";
+	case GL_DEBUG_SOURCE_THIRD_PARTY:		return "Third party";
+	case GL_DEBUG_SOURCE_APPLICATION:		return "Application";
+	default:								return "Other";
+	}
+}
+
+static const char* GetTypeName( const GLenum type )
+{
+	switch( type )
+	{
+	case GL_DEBUG_TYPE_ERROR:				return "error";
+	case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:	return "deprecated behavior";
+	case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:	return "undefined behavior";
+	case GL_DEBUG_TYPE_PORTABILITY:			return "portability";
+	case GL_DEBUG_TYPE_PERFORMANCE:			return "performance";
+	default:								return "other";
+	}
+}
+
+bool CGLDiagnostics::Initialize()
+{
+	if( m_bActive )
+		return true;
+
+	if( !GLEW_KHR_debug )
+	{
+		g_Logger.Warning( LogCategory::GL, "CGLDiagnostics::Initialize: KHR_debug is not supported, GL errors will not be reported\n" );
+		return false;
+	}
+
+	glEnable( GL_DEBUG_OUTPUT );
+
+#ifndef NDEBUG
+	//Report messages from the call that caused them, so the group stack is accurate. This is slower.
+	glEnable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+	m_bSynchronous = true;
+#else
+	glDisable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+	m_bSynchronous = false;
+
+	//Only errors and high severity messages matter in release builds.
+	glDebugMessageControl( GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_MEDIUM, 0, nullptr, GL_FALSE );
+	glDebugMessageControl( GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_LOW, 0, nullptr, GL_FALSE );
+#endif
+
+	//Notifications are mostly buffer placement information; too frequent to print.
+	glDebugMessageControl( GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE );
+
+	//Groups and markers are for GL debuggers; they don't need to be echoed back.
+	glDebugMessageControl( GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE );
+	glDebugMessageControl( GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE );
+	glDebugMessageControl( GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_MARKER, GL_DONT_CARE, 0, nullptr, GL_FALSE );
+
+	//Errors are always reported.
+	glDebugMessageControl( GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_TRUE );
+
+	glDebugMessageCallback( &CGLDiagnostics::DebugCallback, this );
+
+	m_bActive = true;
+
+	return true;
+}
+
+void CGLDiagnostics::Shutdown()
+{
+	if( !m_bActive )
+		return;
+
+	glDebugMessageCallback( nullptr, nullptr );
+
+	glDisable( GL_DEBUG_OUTPUT );
+
+	m_bActive = false;
+
+	m_GroupStack.clear();
+}
+
+void CGLDiagnostics::BeginFrame()
+{
+	m_uiFrameStartErrors = m_uiTotalErrors;
+}
+
+void CGLDiagnostics::PushGroup( const char* const pszName, const char* const pszFile, const int iLine )
+{
+	assert( pszName );
+
+	if( !m_bActive )
+		return;
+
+	char szMessage[ MAX_MESSAGE_LENGTH ];
+
+	const GLsizei length = FormatName( szMessage, pszName, pszFile, iLine );
+
+	glPushDebugGroup( GL_DEBUG_SOURCE_APPLICATION, APPLICATION_MESSAGE_ID, length, szMessage );
+
+	m_GroupStack.push_back( pszName );
+}
+
+void CGLDiagnostics::PushIgnoreErrorsGroup( const char* const pszName, const char* const pszFile, const int iLine )
+{
+	if( !m_bActive )
+		return;
+
+	PushGroup( pszName, pszFile, iLine );
+
+	//Message control state belongs to the group, so popping the group restores error reporting.
+	glDebugMessageControl( GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_FALSE );
+}
+
+void CGLDiagnostics::PopGroup()
+{
+	if( !m_bActive )
+		return;
+
+	assert( !m_GroupStack.empty() );
+
+	glPopDebugGroup();
+
+	m_GroupStack.pop_back();
+}
+
+void CGLDiagnostics::Marker( const char* const pszName, const char* const pszFile, const int iLine )
+{
+	assert( pszName );
+
+	if( !m_bActive )
+		return;
+
+	char szMessage[ MAX_MESSAGE_LENGTH ];
+
+	const GLsizei length = FormatName( szMessage, pszName, pszFile, iLine );
+
+	glDebugMessageInsert( GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_MARKER, APPLICATION_MESSAGE_ID, GL_DEBUG_SEVERITY_NOTIFICATION, length, szMessage );
+}
+
+void GLAPIENTRY CGLDiagnostics::DebugCallback(
+	GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei, const GLchar* pszMessage, const void* pUserParam )
+{
+	reinterpret_cast<CGLDiagnostics*>( const_cast<void*>( pUserParam ) )->OnMessage( source, type, id, severity, pszMessage );
+}
+
+void CGLDiagnostics::OnMessage( GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* pszMessage )
+{
+	if( type == GL_DEBUG_TYPE_ERROR )
+		++m_uiTotalErrors;
+
+	const char* const pszSeverity = severity == GL_DEBUG_SEVERITY_HIGH ? "high" : severity == GL_DEBUG_SEVERITY_MEDIUM ? "medium" : "low";
+
+	const LogLevel level = type == GL_DEBUG_TYPE_ERROR ? LogLevel::ERR : LogLevel::WARNING;
+
+	//Without synchronous output, the stack may belong to a later point in the frame.
+	if( m_bSynchronous && !m_GroupStack.empty() )
+	{
+		g_Logger.Log( LogCategory::GL, level, "GL %s %s (%s severity, id %u) in \"%s\": %s\n",
+			GetSourceName( source ), GetTypeName( type ), pszSeverity, id, m_GroupStack.back(), pszMessage );
+	}
+	else
+	{
+		g_Logger.Log( LogCategory::GL, level, "GL %s %s (%s severity, id %u): %s\n",
+			GetSourceName( source ), GetTypeName( type ), pszSeverity, id, pszMessage );
+	}
+}
+
+GLsizei CGLDiagnostics::FormatName( char* pszBuffer, const char* const pszName, const char* const pszFile, const int iLine ) const
+{
+	//Only the file name is interesting.
+	const char* pszFileName = pszFile;
+
+	for( const char* pszChar = pszFile; *pszChar; ++pszChar )
+	{
+		if( *pszChar == '/' || *pszChar == '\\' )
+			pszFileName = pszChar + 1;
+	}
+
+	const int iResult = snprintf( pszBuffer, MAX_MESSAGE_LENGTH, "%s (%s:%d)", pszName, pszFileName, iLine );
+
+	if( iResult < 0 )
+	{
+		pszBuffer[ 0 ] = '\0';
+		return 0;
+	}
+
+	return static_cast<GLsizei>( strlen( pszBuffer ) );
+}
@@ -0,0 +1,168 @@
+#ifndef GL_CGLDIAGNOSTICS_H
+#define GL_CGLDIAGNOSTICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <gl/glew.h>
+
+/**
+*	Reports GL errors through KHR_debug instead of polling glGetError.
+*	The driver calls back when it generates a message, so the render loop doesn't need to synchronize with it.
+*	Debug groups and markers annotate the command stream with source locations; they show up in messages
+*	and in GL debuggers.
+*	Debug builds use a debug context and synchronous output, so messages are reported from the call that caused them.
+*	Release builds keep the callback for errors, but check_gl_error is compiled out.
+*	If KHR_debug is not available, nothing is reported and debug builds fall back to polling.
+*/
+class CGLDiagnostics final
+{
+public:
+	/**
+	*	Maximum length of a debug group name or marker, including the source location.
+	*/
+	static const size_t MAX_MESSAGE_LENGTH = 256;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CGLDiagnostics() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CGLDiagnostics() = default;
+
+	/**
+	*	Installs the debug message callback. Requires a current context.
+	*	@return Whether debug output is active.
+	*/
+	bool Initialize();
+
+	/**
+	*	Removes the debug message callback.
+	*/
+	void Shutdown();
+
+	/**
+	*	@return Whether debug output is active.
+	*/
+	bool IsActive() const { return m_bActive; }
+
+	/**
+	*	Starts counting the errors for a new frame.
+	*/
+	void BeginFrame();
+
+	/**
+	*	@return Number of errors reported since the last call to BeginFrame.
+	*/
+	size_t GetFrameErrors() const { return m_uiTotalErrors - m_uiFrameStartErrors; }
+
+	/**
+	*	@return Number of errors reported since initialization.
+	*/
+	size_t GetTotalErrors() const { return m_uiTotalErrors; }
+
+	/**
+	*	Pushes a debug group. Every message generated until the group is popped is reported as part of it.
+	*	@param pszName Name of the group. Must remain valid until the group is popped.
+	*	@param pszFile Source file that pushed the group.
+	*	@param iLine Line in the source file.
+	*/
+	void PushGroup( const char* const pszName, const char* const pszFile, const int iLine );
+
+	/**
+	*	Pushes a debug group in which errors are expected and are not reported.
+	*	@see PushGroup
+	*/
+	void PushIgnoreErrorsGroup( const char* const pszName, const char* const pszFile, const int iLine );
+
+	/**
+	*	Pops the last pushed debug group.
+	*/
+	void PopGroup();
+
+	/**
+	*	Inserts a marker into the command stream.
+	*	@param pszName Name of the marker.
+	*	@param pszFile Source file that inserted the marker.
+	*	@param iLine Line in the source file.
+	*/
+	void Marker( const char* const pszName, const char* const pszFile, const int iLine );
+
+private:
+	static void GLAPIENTRY DebugCallback(
+		GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* pszMessage, const void* pUserParam );
+
+	void OnMessage( GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* pszMessage );
+
+	/**
+	*	Formats a group or marker name with its source location.
+	*	@return Length of the formatted message.
+	*/
+	GLsizei FormatName( char* pszBuffer, const char* const pszName, const char* const pszFile, const int iLine ) const;
+
+private:
+	bool m_bActive = false;
+
+	/**
+	*	Whether the callback is called from the thread that made the GL call. Only then can the group stack be read.
+	*/
+	bool m_bSynchronous = false;
+
+	/**
+	*	Names of the pushed groups. Only used for printing messages.
+	*/
+	std::vector<const char*> m_GroupStack;
+
+	/**
+	*	The callback can be called from driver threads when output is not synchronous.
+	*/
+	std::atomic<size_t> m_uiTotalErrors{ 0 };
+	size_t m_uiFrameStartErrors = 0;
+
+private:
+	CGLDiagnostics( const CGLDiagnostics& ) = delete;
+	CGLDiagnostics& operator=( const CGLDiagnostics& ) = delete;
+};
+
+extern CGLDiagnostics g_GLDiagnostics;
+
+/**
+*	Pushes a debug group for the lifetime of the object.
+*/
+class CGLDebugGroup final
+{
+public:
+	CGLDebugGroup( const char* const pszName, const char* const pszFile, const int iLine )
+	{
+		g_GLDiagnostics.PushGroup( pszName, pszFile, iLine );
+	}
+
+	~CGLDebugGroup()
+	{
+		g_GLDiagnostics.PopGroup();
+	}
+
+private:
+	CGLDebugGroup( const CGLDebugGroup& ) = delete;
+	CGLDebugGroup& operator=( const CGLDebugGroup& ) = delete;
+};
+
+#define GLDIAG_CONCAT_IMPL( a, b ) a##b
+#define GLDIAG_CONCAT( a, b ) GLDIAG_CONCAT_IMPL( a, b )
+
+/**
+*	Pushes a debug group until the end of the current scope.
+*/
+#define GLDIAG_GROUP( pszName ) CGLDebugGroup GLDIAG_CONCAT( glDebugGroup_, __LINE__ )( pszName, __FILE__, __LINE__ )
+
+/**
+*	Inserts a marker into the command stream.
+*/
+#define GLDIAG_MARKER( pszName ) g_GLDiagnostics.Marker( pszName, __FILE__, __LINE__ )
+
+#endif //GL_CGLDIAGNOSTICS_H
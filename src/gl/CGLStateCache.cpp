@@ -0,0 +1,353 @@
+#include <cassert>
+#include <cstring>
+
+#include "GLUtil.h"
+
+#include "CGLStateCache.h"
+
+CGLStateCache g_GLState;
+
+static const GLenum INVALID_ENUM_VALUE = 0;
+
+static const GLint INVALID_ENV_MODE = -1;
+
+CGLStateCache::CGLStateCache()
+{
+	Invalidate();
+}
+
+void CGLStateCache::BeginFrame()
+{
+	m_uiIssuedCalls = 0;
+	m_uiDroppedCalls = 0;
+
+	Invalidate();
+}
+
+void CGLStateCache::Invalidate()
+{
+	m_bProgramValid = false;
+	m_Program = 0;
+
+	m_iActiveUnit = -1;
+
+	for( auto& unit : m_Units )
+	{
+		unit.target = INVALID_ENUM_VALUE;
+		unit.texture = 0;
+		unit.envMode = INVALID_ENV_MODE;
+	}
+
+	for( auto& iCap : m_iCaps )
+	{
+		iCap = -1;
+	}
+
+	m_BlendSrc = INVALID_ENUM_VALUE;
+	m_BlendDst = INVALID_ENUM_VALUE;
+
+	m_iDepthMask = -1;
+
+	for( size_t uiIndex = 0; uiIndex < NUM_BUFFER_TARGETS; ++uiIndex )
+	{
+		m_bBufferValid[ uiIndex ] = false;
+		m_Buffers[ uiIndex ] = 0;
+	}
+
+	m_bVertexArrayValid = false;
+	m_VertexArray = 0;
+
+	m_Uniforms.clear();
+}
+
+void CGLStateCache::UseProgram( const GLuint program )
+{
+	if( m_bProgramValid && m_Program == program )
+	{
+		Dropped();
+		return;
+	}
+
+	glUseProgram( program );
+
+	check_gl_error();
+
+	m_bProgramValid = true;
+	m_Program = program;
+
+	Issued();
+}
+
+void CGLStateCache::ActiveTexture( const GLuint uiUnit )
+{
+	if( m_iActiveUnit == static_cast<GLint>( uiUnit ) )
+	{
+		Dropped();
+		return;
+	}
+
+	glActiveTexture( GL_TEXTURE0 + uiUnit );
+
+	check_gl_error();
+
+	m_iActiveUnit = static_cast<GLint>( uiUnit );
+
+	Issued();
+}
+
+void CGLStateCache::BindTexture( const GLuint uiUnit, const GLenum target, const GLuint texture )
+{
+	if( uiUnit < MAX_TEXTURE_UNITS )
+	{
+		auto& unit = m_Units[ uiUnit ];
+
+		if( unit.target == target && unit.texture == texture )
+		{
+			Dropped();
+			return;
+		}
+
+		unit.target = target;
+		unit.texture = texture;
+	}
+
+	ActiveTexture( uiUnit );
+
+	glBindTexture( target, texture );
+
+	check_gl_error();
+
+	Issued();
+}
+
+void CGLStateCache::TexEnvMode( const GLuint uiUnit, const GLint mode )
+{
+	if( uiUnit < MAX_TEXTURE_UNITS )
+	{
+		auto& unit = m_Units[ uiUnit ];
+
+		if( unit.envMode == mode )
+		{
+			Dropped();
+			return;
+		}
+
+		unit.envMode = mode;
+	}
+
+	ActiveTexture( uiUnit );
+
+	glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode );
+
+	check_gl_error();
+
+	Issued();
+}
+
+void CGLStateCache::Enable( const GLenum cap )
+{
+	SetCapability( cap, true );
+}
+
+void CGLStateCache::Disable( const GLenum cap )
+{
+	SetCapability( cap, false );
+}
+
+void CGLStateCache::BlendFunc( const GLenum sfactor, const GLenum dfactor )
+{
+	if( m_BlendSrc == sfactor && m_BlendDst == dfactor )
+	{
+		Dropped();
+		return;
+	}
+
+	glBlendFunc( sfactor, dfactor );
+
+	check_gl_error();
+
+	m_BlendSrc = sfactor;
+	m_BlendDst = dfactor;
+
+	Issued();
+}
+
+void CGLStateCache::DepthMask( const GLboolean flag )
+{
+	const int iMask = flag != GL_FALSE ? 1 : 0;
+
+	if( m_iDepthMask == iMask )
+	{
+		Dropped();
+		return;
+	}
+
+	glDepthMask( flag );
+
+	check_gl_error();
+
+	m_iDepthMask = iMask;
+
+	Issued();
+}
+
+void CGLStateCache::BindBuffer( const GLenum target, const GLuint buffer )
+{
+	int iTarget;
+
+	switch( target )
+	{
+	case GL_ARRAY_BUFFER:			iTarget = BUFFER_ARRAY; break;
+	case GL_ELEMENT_ARRAY_BUFFER:	iTarget = BUFFER_ELEMENT_ARRAY; break;
+	case GL_UNIFORM_BUFFER:			iTarget = BUFFER_UNIFORM; break;
+	default:						iTarget = -1; break;
+	}
+
+	if( iTarget != -1 )
+	{
+		if( m_bBufferValid[ iTarget ] && m_Buffers[ iTarget ] == buffer )
+		{
+			Dropped();
+			return;
+		}
+
+		m_bBufferValid[ iTarget ] = true;
+		m_Buffers[ iTarget ] = buffer;
+	}
+
+	glBindBuffer( target, buffer );
+
+	check_gl_error();
+
+	Issued();
+}
+
+void CGLStateCache::BindVertexArray( const GLuint vertexArray )
+{
+	if( m_bVertexArrayValid && m_VertexArray == vertexArray )
+	{
+		Dropped();
+		return;
+	}
+
+	glBindVertexArray( vertexArray );
+
+	check_gl_error();
+
+	m_bVertexArrayValid = true;
+	m_VertexArray = vertexArray;
+
+	m_bBufferValid[ BUFFER_ELEMENT_ARRAY ] = false;
+
+	Issued();
+}
+
+void CGLStateCache::Uniform1i( const GLint location, const GLint iValue )
+{
+	//Store the bits so integers can share the float storage.
+	GLfloat flValue;
+
+	static_assert( sizeof( flValue ) == sizeof( iValue ), "GLint and GLfloat must have the same size" );
+
+	memcpy( &flValue, &iValue, sizeof( flValue ) );
+
+	if( !UpdateUniform( location, &flValue, 1 ) )
+	{
+		Dropped();
+		return;
+	}
+
+	glUniform1i( location, iValue );
+
+	check_gl_error();
+
+	Issued();
+}
+
+void CGLStateCache::Uniform1f( const GLint location, const GLfloat flValue )
+{
+	if( !UpdateUniform( location, &flValue, 1 ) )
+	{
+		Dropped();
+		return;
+	}
+
+	glUniform1f( location, flValue );
+
+	check_gl_error();
+
+	Issued();
+}
+
+void CGLStateCache::UniformMatrix4fv( const GLint location, const GLfloat* pflValues )
+{
+	assert( pflValues );
+
+	if( !UpdateUniform( location, pflValues, 16 ) )
+	{
+		Dropped();
+		return;
+	}
+
+	glUniformMatrix4fv( location, 1, GL_FALSE, pflValues );
+
+	check_gl_error();
+
+	Issued();
+}
+
+void CGLStateCache::SetCapability( const GLenum cap, const bool bEnable )
+{
+	int iCap;
+
+	switch( cap )
+	{
+	case GL_BLEND:		iCap = CAP_BLEND; break;
+	case GL_DEPTH_TEST:	iCap = CAP_DEPTH_TEST; break;
+	case GL_CULL_FACE:	iCap = CAP_CULL_FACE; break;
+	default:			iCap = -1; break;
+	}
+
+	if( iCap != -1 )
+	{
+		if( m_iCaps[ iCap ] == ( bEnable ? 1 : 0 ) )
+		{
+			Dropped();
+			return;
+		}
+
+		m_iCaps[ iCap ] = bEnable ? 1 : 0;
+	}
+
+	if( bEnable )
+		glEnable( cap );
+	else
+		glDisable( cap );
+
+	check_gl_error();
+
+	Issued();
+}
+
+bool CGLStateCache::UpdateUniform( const GLint location, const GLfloat* pflValues, const size_t uiCount )
+{
+	assert( uiCount <= 16 );
+
+	//Uniforms belong to the program in use; they can't be tracked if it isn't known.
+	//Location -1 is silently ignored by GL, so there's nothing to track.
+	if( !m_bProgramValid || location < 0 )
+		return true;
+
+	const uint64_t uiKey = ( static_cast<uint64_t>( m_Program ) << 32 ) | static_cast<uint32_t>( location );
+
+	auto result = m_Uniforms.insert( std::make_pair( uiKey, UniformValue_t() ) );
+
+	GLfloat* pflCached = result.first->second.flValues;
+
+	if( !result.second && memcmp( pflCached, pflValues, sizeof( GLfloat ) * uiCount ) == 0 )
+		return false;
+
+	memcpy( pflCached, pflValues, sizeof( GLfloat ) * uiCount );
+
+	return true;
+}
@@ -0,0 +1,195 @@
+#ifndef GL_CGLSTATECACHE_H
+#define GL_CGLSTATECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include <gl/glew.h>
+
+/**
+*	Shadows GL state so that calls that would not change anything are not sent to the driver.
+*	Tracks the program, the active texture unit, textures bound per unit, the texture environment mode per unit,
+*	the blend, depth test and cull face capabilities, the blend function, the depth mask, bound buffers, the vertex array
+*	and uniform values.
+*	State changed with direct GL calls is not seen by the cache; call Invalidate after doing so.
+*	Counts issued and dropped calls, reset by BeginFrame.
+*/
+class CGLStateCache final
+{
+public:
+	/**
+	*	Number of texture units that are tracked. Binds on other units are always issued.
+	*/
+	static const GLuint MAX_TEXTURE_UNITS = 8;
+
+private:
+	/**
+	*	Capabilities that are tracked. Other capabilities are always issued.
+	*/
+	enum Capability
+	{
+		CAP_BLEND = 0,
+		CAP_DEPTH_TEST,
+		CAP_CULL_FACE,
+
+		NUM_CAPS
+	};
+
+	/**
+	*	Buffer targets that are tracked. Other targets are always issued.
+	*/
+	enum BufferTarget
+	{
+		BUFFER_ARRAY = 0,
+		BUFFER_ELEMENT_ARRAY,
+		BUFFER_UNIFORM,
+
+		NUM_BUFFER_TARGETS
+	};
+
+	struct TextureUnit_t
+	{
+		GLenum target;
+		GLuint texture;
+		GLint envMode;
+	};
+
+	/**
+	*	Last value set for a uniform. Only as many floats as the uniform has are used.
+	*/
+	struct UniformValue_t
+	{
+		GLfloat flValues[ 16 ];
+	};
+
+	/**
+	*	Uniforms are identified by program and location.
+	*/
+	typedef std::unordered_map<uint64_t, UniformValue_t> Uniforms_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CGLStateCache();
+
+	/**
+	*	Destructor.
+	*/
+	~CGLStateCache() = default;
+
+	/**
+	*	Resets the call counters and invalidates all state.
+	*/
+	void BeginFrame();
+
+	/**
+	*	Forgets all shadowed state. The next call for each piece of state is always issued.
+	*/
+	void Invalidate();
+
+	/**
+	*	@return Number of calls sent to GL since the last call to BeginFrame.
+	*/
+	size_t GetIssuedCalls() const { return m_uiIssuedCalls; }
+
+	/**
+	*	@return Number of calls dropped since the last call to BeginFrame.
+	*/
+	size_t GetDroppedCalls() const { return m_uiDroppedCalls; }
+
+	void UseProgram( const GLuint program );
+
+	/**
+	*	@param uiUnit Texture unit index, not GL_TEXTURE0 based.
+	*/
+	void ActiveTexture( const GLuint uiUnit );
+
+	/**
+	*	Binds a texture to a texture unit. Makes the unit active if needed.
+	*/
+	void BindTexture( const GLuint uiUnit, const GLenum target, const GLuint texture );
+
+	/**
+	*	Sets GL_TEXTURE_ENV_MODE for a texture unit. Makes the unit active if needed.
+	*/
+	void TexEnvMode( const GLuint uiUnit, const GLint mode );
+
+	void Enable( const GLenum cap );
+
+	void Disable( const GLenum cap );
+
+	void BlendFunc( const GLenum sfactor, const GLenum dfactor );
+
+	void DepthMask( const GLboolean flag );
+
+	void BindBuffer( const GLenum target, const GLuint buffer );
+
+	/**
+	*	Binds a vertex array object. The element array buffer binding is part of the vertex array, so it becomes unknown.
+	*/
+	void BindVertexArray( const GLuint vertexArray );
+
+	void Uniform1i( const GLint location, const GLint iValue );
+
+	void Uniform1f( const GLint location, const GLfloat flValue );
+
+	void UniformMatrix4fv( const GLint location, const GLfloat* pflValues );
+
+private:
+	void SetCapability( const GLenum cap, const bool bEnable );
+
+	/**
+	*	Checks a uniform value against the shadowed value and updates it.
+	*	@return Whether the value changed.
+	*/
+	bool UpdateUniform( const GLint location, const GLfloat* pflValues, const size_t uiCount );
+
+	void Issued() { ++m_uiIssuedCalls; }
+
+	void Dropped() { ++m_uiDroppedCalls; }
+
+private:
+	bool m_bProgramValid;
+	GLuint m_Program;
+
+	/**
+	*	-1 if unknown.
+	*/
+	GLint m_iActiveUnit;
+
+	TextureUnit_t m_Units[ MAX_TEXTURE_UNITS ];
+
+	/**
+	*	-1 if unknown, otherwise 0 or 1.
+	*/
+	int m_iCaps[ NUM_CAPS ];
+
+	GLenum m_BlendSrc;
+	GLenum m_BlendDst;
+
+	/**
+	*	-1 if unknown.
+	*/
+	int m_iDepthMask;
+
+	bool m_bBufferValid[ NUM_BUFFER_TARGETS ];
+	GLuint m_Buffers[ NUM_BUFFER_TARGETS ];
+
+	bool m_bVertexArrayValid;
+	GLuint m_VertexArray;
+
+	Uniforms_t m_Uniforms;
+
+	size_t m_uiIssuedCalls = 0;
+	size_t m_uiDroppedCalls = 0;
+
+private:
+	CGLStateCache( const CGLStateCache& ) = delete;
+	CGLStateCache& operator=( const CGLStateCache& ) = delete;
+};
+
+extern CGLStateCache g_GLState;
+
+#endif //GL_CGLSTATECACHE_H
@@ -0,0 +1,261 @@
+#include <cassert>
+
+#include "utility/CLogger.h"
+
+#include "GLUtil.h"
+
+#include "CGPUProfiler.h"
+
+CGPUProfiler g_GPUProfiler;
+
+const size_t CGPUProfiler::NUM_QUERY_FRAMES;
+
+bool CGPUProfiler::Initialize()
+{
+	if( m_bActive )
+		return true;
+
+	if( !GLEW_VERSION_3_3 && !GLEW_ARB_timer_query )
+	{
+		g_Logger.Info( LogCategory::GL, "CGPUProfiler::Initialize: Timer queries are not supported, GPU time will not be measured\n" );
+		return false;
+	}
+
+	//Implementations without a GPU timer report 0 bits; their results are meaningless.
+	GLint iTimestampBits = 0;
+	GLint iElapsedBits = 0;
+
+	glGetQueryiv( GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &iTimestampBits );
+	glGetQueryiv( GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &iElapsedBits );
+
+	if( iTimestampBits == 0 || iElapsedBits == 0 )
+	{
+		g_Logger.Info( LogCategory::GL, "CGPUProfiler::Initialize: The implementation has no GPU timer, GPU time will not be measured\n" );
+		return false;
+	}
+
+	for( auto& frame : m_Frames )
+	{
+		glGenQueries( 1, &frame.beginQuery );
+		glGenQueries( 1, &frame.endQuery );
+
+		for( auto& zone : frame.zones )
+		{
+			zone.pszName = nullptr;
+
+			glGenQueries( 1, &zone.elapsedQuery );
+			glGenQueries( 1, &zone.timestampQuery );
+		}
+
+		frame.uiNumZones = 0;
+		frame.bPending = false;
+	}
+
+	check_gl_error();
+
+	m_uiFrame = 0;
+	m_pCurrentFrame = nullptr;
+	m_bInZone = false;
+	m_bHasResults = false;
+	m_uiNumZoneResults = 0;
+	m_uiDroppedFrames = 0;
+
+	m_bActive = true;
+
+	return true;
+}
+
+void CGPUProfiler::Shutdown()
+{
+	if( !m_bActive )
+		return;
+
+	for( auto& frame : m_Frames )
+	{
+		glDeleteQueries( 1, &frame.beginQuery );
+		glDeleteQueries( 1, &frame.endQuery );
+
+		for( auto& zone : frame.zones )
+		{
+			glDeleteQueries( 1, &zone.elapsedQuery );
+			glDeleteQueries( 1, &zone.timestampQuery );
+		}
+	}
+
+	m_pCurrentFrame = nullptr;
+
+	m_bActive = false;
+}
+
+void CGPUProfiler::BeginFrame()
+{
+	if( !m_bActive )
+		return;
+
+	assert( !m_pCurrentFrame );
+
+	Frame_t& frame = m_Frames[ m_uiFrame % NUM_QUERY_FRAMES ];
+
+	++m_uiFrame;
+
+	if( frame.bPending )
+	{
+		//Waiting would stall the pipeline; issuing the queries again discards the old results.
+		if( AreResultsAvailable( frame ) )
+			ReadResults( frame );
+		else
+			++m_uiDroppedFrames;
+
+		frame.bPending = false;
+	}
+
+	frame.uiNumZones = 0;
+
+	glQueryCounter( frame.beginQuery, GL_TIMESTAMP );
+
+	m_pCurrentFrame = &frame;
+}
+
+void CGPUProfiler::EndFrame()
+{
+	if( !m_pCurrentFrame )
+		return;
+
+	EndZone();
+
+	glQueryCounter( m_pCurrentFrame->endQuery, GL_TIMESTAMP );
+
+	m_pCurrentFrame->bPending = true;
+
+	m_pCurrentFrame = nullptr;
+}
+
+void CGPUProfiler::BeginZone( const char* const pszName )
+{
+	assert( pszName );
+
+	if( !m_pCurrentFrame )
+		return;
+
+	//GL_TIME_ELAPSED queries can't be nested.
+	assert( !m_bInZone );
+
+	if( m_bInZone )
+		EndZone();
+
+	if( m_pCurrentFrame->uiNumZones >= MAX_ZONES )
+		return;
+
+	Zone_t& zone = m_pCurrentFrame->zones[ m_pCurrentFrame->uiNumZones++ ];
+
+	zone.pszName = pszName;
+
+	glQueryCounter( zone.timestampQuery, GL_TIMESTAMP );
+	glBeginQuery( GL_TIME_ELAPSED, zone.elapsedQuery );
+
+	m_bInZone = true;
+}
+
+void CGPUProfiler::EndZone()
+{
+	if( !m_bInZone )
+		return;
+
+	glEndQuery( GL_TIME_ELAPSED );
+
+	m_bInZone = false;
+}
+
+bool CGPUProfiler::AreResultsAvailable( const Frame_t& frame ) const
+{
+	GLuint available = GL_FALSE;
+
+	//The end timestamp was issued last, so check it first.
+	glGetQueryObjectuiv( frame.endQuery, GL_QUERY_RESULT_AVAILABLE, &available );
+
+	if( !available )
+		return false;
+
+	glGetQueryObjectuiv( frame.beginQuery, GL_QUERY_RESULT_AVAILABLE, &available );
+
+	if( !available )
+		return false;
+
+	for( size_t uiIndex = 0; uiIndex < frame.uiNumZones; ++uiIndex )
+	{
+		glGetQueryObjectuiv( frame.zones[ uiIndex ].elapsedQuery, GL_QUERY_RESULT_AVAILABLE, &available );
+
+		if( !available )
+			return false;
+
+		glGetQueryObjectuiv( frame.zones[ uiIndex ].timestampQuery, GL_QUERY_RESULT_AVAILABLE, &available );
+
+		if( !available )
+			return false;
+	}
+
+	return true;
+}
+
+void CGPUProfiler::ReadResults( const Frame_t& frame )
+{
+	GLuint64 uiBegin = 0;
+	GLuint64 uiEnd = 0;
+
+	glGetQueryObjectui64v( frame.beginQuery, GL_QUERY_RESULT, &uiBegin );
+	glGetQueryObjectui64v( frame.endQuery, GL_QUERY_RESULT, &uiEnd );
+
+	//Results are in nanoseconds.
+	m_flFrameMilliseconds = ( uiEnd - uiBegin ) / 1000000.0;
+
+	const bool bRecord = g_Profiler.IsRecording();
+
+	if( bRecord )
+	{
+		//Tracks allocate their event buffer, so only create it once it's needed.
+		if( !m_pTrack )
+			m_pTrack = g_Profiler.CreateTrack( "GPU" );
+
+		//The clocks drift apart, so calibrate every time. This doesn't wait for the GPU.
+		GLint64 iGPUTime = 0;
+
+		glGetInteger64v( GL_TIMESTAMP, &iGPUTime );
+
+		m_iClockOffset = static_cast<int64_t>( g_Profiler.GetTimestamp() ) - iGPUTime;
+
+		g_Profiler.AddEvent( m_pTrack, "GPU frame", ToProfilerTime( uiBegin ), ToProfilerTime( uiEnd ) );
+	}
+
+	for( size_t uiIndex = 0; uiIndex < frame.uiNumZones; ++uiIndex )
+	{
+		const Zone_t& zone = frame.zones[ uiIndex ];
+
+		GLuint64 uiElapsed = 0;
+		GLuint64 uiStart = 0;
+
+		glGetQueryObjectui64v( zone.elapsedQuery, GL_QUERY_RESULT, &uiElapsed );
+		glGetQueryObjectui64v( zone.timestampQuery, GL_QUERY_RESULT, &uiStart );
+
+		m_ZoneResults[ uiIndex ].pszName = zone.pszName;
+		m_ZoneResults[ uiIndex ].flMilliseconds = uiElapsed / 1000000.0;
+
+		if( bRecord )
+		{
+			const uint64_t uiProfilerStart = ToProfilerTime( uiStart );
+
+			g_Profiler.AddEvent( m_pTrack, zone.pszName, uiProfilerStart, uiProfilerStart + uiElapsed );
+		}
+	}
+
+	m_uiNumZoneResults = frame.uiNumZones;
+
+	m_bHasResults = true;
+}
+
+uint64_t CGPUProfiler::ToProfilerTime( const GLuint64 uiGPUTime ) const
+{
+	const int64_t iTime = static_cast<int64_t>( uiGPUTime ) + m_iClockOffset;
+
+	//Events from before the profiler was created can't be represented.
+	return iTime > 0 ? static_cast<uint64_t>( iTime ) : 0;
+}
@@ -0,0 +1,187 @@
+#ifndef GL_CGPUPROFILER_H
+#define GL_CGPUPROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gl/glew.h>
+
+#include "utility/CProfiler.h"
+
+/**
+*	Measures GPU time per frame and per zone with timer queries.
+*	Every zone gets a GL_TIME_ELAPSED query for its duration and a GL_TIMESTAMP query for its position on the GPU timeline;
+*	the frame is bracketed by timestamps.
+*	Queries are double buffered: a frame's results are read when its query set comes around again, by which time the GPU has normally
+*	finished it. Results that aren't available yet are dropped instead of waiting for them, so reading never stalls the pipeline.
+*	While the CPU profiler records, results are added to its trace on a separate GPU track, mapped onto the CPU timeline.
+*	If timer queries are not supported, or the implementation has no timer (some software implementations), nothing is measured.
+*/
+class CGPUProfiler final
+{
+public:
+	/**
+	*	Number of frames whose queries can be in flight.
+	*/
+	static const size_t NUM_QUERY_FRAMES = 2;
+
+	/**
+	*	Maximum number of zones per frame. Zones beyond this are not measured.
+	*/
+	static const size_t MAX_ZONES = 16;
+
+	struct ZoneResult_t
+	{
+		const char* pszName;
+
+		/**
+		*	Time spent on the GPU, in milliseconds.
+		*/
+		double flMilliseconds;
+	};
+
+private:
+	struct Zone_t
+	{
+		const char* pszName;
+
+		GLuint elapsedQuery;
+		GLuint timestampQuery;
+	};
+
+	struct Frame_t
+	{
+		GLuint beginQuery;
+		GLuint endQuery;
+
+		Zone_t zones[ MAX_ZONES ];
+		size_t uiNumZones;
+
+		/**
+		*	Whether the queries have been issued and the results haven't been read yet.
+		*/
+		bool bPending;
+	};
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CGPUProfiler() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CGPUProfiler() = default;
+
+	/**
+	*	Creates the queries. Requires a current context.
+	*	@return Whether timer queries are supported.
+	*/
+	bool Initialize();
+
+	/**
+	*	Deletes the queries.
+	*/
+	void Shutdown();
+
+	/**
+	*	@return Whether timer queries are used.
+	*/
+	bool IsActive() const { return m_bActive; }
+
+	/**
+	*	Starts a new frame. Reads the results of the frame that last used this frame's queries.
+	*/
+	void BeginFrame();
+
+	/**
+	*	Ends the current frame.
+	*/
+	void EndFrame();
+
+	/**
+	*	Starts measuring a zone. Zones can't be nested.
+	*	@param pszName Name of the zone. Must be a string literal.
+	*/
+	void BeginZone( const char* const pszName );
+
+	/**
+	*	Stops measuring the current zone.
+	*/
+	void EndZone();
+
+	/**
+	*	@return Whether results are available for a previous frame.
+	*/
+	bool HasResults() const { return m_bHasResults; }
+
+	/**
+	*	@return GPU time of the last frame with results, in milliseconds. Results are NUM_QUERY_FRAMES frames old.
+	*/
+	double GetFrameTime() const { return m_flFrameMilliseconds; }
+
+	size_t GetNumZoneResults() const { return m_uiNumZoneResults; }
+
+	const ZoneResult_t& GetZoneResult( const size_t uiIndex ) const { return m_ZoneResults[ uiIndex ]; }
+
+	/**
+	*	@return Number of frames whose results were dropped because they weren't available in time.
+	*/
+	size_t GetNumDroppedFrames() const { return m_uiDroppedFrames; }
+
+private:
+	/**
+	*	@return Whether all of a frame's queries have results.
+	*/
+	bool AreResultsAvailable( const Frame_t& frame ) const;
+
+	/**
+	*	Reads a frame's results. They must be available.
+	*/
+	void ReadResults( const Frame_t& frame );
+
+	/**
+	*	@return The GPU timestamp with the given value, in nanoseconds on the CPU profiler's timeline.
+	*/
+	uint64_t ToProfilerTime( const GLuint64 uiGPUTime ) const;
+
+private:
+	bool m_bActive = false;
+
+	Frame_t m_Frames[ NUM_QUERY_FRAMES ];
+
+	/**
+	*	Number of frames started since initialization.
+	*/
+	size_t m_uiFrame = 0;
+
+	/**
+	*	Frame being recorded, or null if outside BeginFrame/EndFrame.
+	*/
+	Frame_t* m_pCurrentFrame = nullptr;
+
+	bool m_bInZone = false;
+
+	bool m_bHasResults = false;
+	double m_flFrameMilliseconds = 0;
+	ZoneResult_t m_ZoneResults[ MAX_ZONES ];
+	size_t m_uiNumZoneResults = 0;
+
+	size_t m_uiDroppedFrames = 0;
+
+	/**
+	*	Difference between the CPU profiler's clock and the GPU clock, in nanoseconds.
+	*/
+	int64_t m_iClockOffset = 0;
+
+	CProfiler::Track_t* m_pTrack = nullptr;
+
+private:
+	CGPUProfiler( const CGPUProfiler& ) = delete;
+	CGPUProfiler& operator=( const CGPUProfiler& ) = delete;
+};
+
+extern CGPUProfiler g_GPUProfiler;
+
+#endif //GL_CGPUPROFILER_H
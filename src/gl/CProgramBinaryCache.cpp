@@ -0,0 +1,256 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "utility/CLogger.h"
+
+#include "core/Platform.h"
+
+#include "GLUtil.h"
+
+#include "CBaseShader.h"
+#include "CGLDiagnostics.h"
+
+#include "CProgramBinaryCache.h"
+
+CProgramBinaryCache g_ProgramBinaryCache;
+
+/**
+*	Identifies program binary files. "PBIN" in little endian.
+*/
+static const uint32_t PROGRAM_BINARY_MAGIC = 'P' | ( 'B' << 8 ) | ( 'I' << 16 ) | ( 'N' << 24 );
+
+/**
+*	Increment when the file format or the key changes.
+*/
+static const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+struct ProgramBinaryHeader_t
+{
+	uint32_t uiMagic;
+	uint32_t uiVersion;
+	uint64_t uiKey;
+	uint32_t format;
+	uint32_t uiLength;
+};
+
+static const uint64_t FNV1A_64_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV1A_64_PRIME = 1099511628211ULL;
+
+/**
+*	64 bit FNV-1a. Includes the null terminator, so consecutive strings can't run into each other.
+*/
+static uint64_t HashString( const char* pszString, uint64_t uiHash )
+{
+	if( !pszString )
+		pszString = "";
+
+	do
+	{
+		uiHash ^= static_cast<unsigned char>( *pszString );
+		uiHash *= FNV1A_64_PRIME;
+	}
+	while( *pszString++ );
+
+	return uiHash;
+}
+
+static void GetCacheFileName( const char* const pszName, char* pszFileName, const size_t uiSize )
+{
+	snprintf( pszFileName, uiSize, "%s%s%s", PROGRAM_BINARY_CACHE_DIR, pszName, PROGRAM_BINARY_EXT );
+}
+
+bool CProgramBinaryCache::Initialize()
+{
+	m_bEnabled = false;
+
+	if( !GLEW_ARB_get_program_binary )
+	{
+		g_Logger.Warning( LogCategory::GL, "Program binaries not supported, shaders will be compiled at startup\n" );
+		return false;
+	}
+
+	GLint iNumFormats = 0;
+
+	glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &iNumFormats );
+
+	check_gl_error();
+
+	if( iNumFormats <= 0 )
+	{
+		g_Logger.Warning( LogCategory::GL, "Driver has no program binary formats, shaders will be compiled at startup\n" );
+		return false;
+	}
+
+	if( !CreateDirectoryA( PROGRAM_BINARY_CACHE_DIR, nullptr ) && GetLastError() != ERROR_ALREADY_EXISTS )
+	{
+		g_Logger.Error( LogCategory::GL, "Couldn't create program binary cache directory \"%s\"\n", PROGRAM_BINARY_CACHE_DIR );
+		return false;
+	}
+
+	const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+
+	m_uiDriverHash = FNV1A_64_OFFSET_BASIS;
+
+	for( auto name : strings )
+	{
+		m_uiDriverHash = HashString( reinterpret_cast<const char*>( glGetString( name ) ), m_uiDriverHash );
+	}
+
+	check_gl_error();
+
+	m_bEnabled = true;
+
+	return true;
+}
+
+uint64_t CProgramBinaryCache::ComputeKey( const CBaseShader* pShader, const char* const pszVertexSource, const char* const pszFragSource ) const
+{
+	assert( pShader );
+
+	uint64_t uiKey = m_uiDriverHash;
+
+	uiKey ^= PROGRAM_BINARY_VERSION;
+	uiKey *= FNV1A_64_PRIME;
+
+	uiKey = HashString( pszVertexSource, uiKey );
+	uiKey = HashString( pszFragSource, uiKey );
+
+	for( size_t uiIndex = 0; uiIndex < pShader->GetNumAttributes(); ++uiIndex )
+	{
+		uiKey = HashString( pShader->GetAttribute( uiIndex )->GetName(), uiKey );
+	}
+
+	for( size_t uiIndex = 0; uiIndex < pShader->GetNumOutputs(); ++uiIndex )
+	{
+		uiKey = HashString( pShader->GetOutput( uiIndex )->GetName(), uiKey );
+	}
+
+	return uiKey;
+}
+
+bool CProgramBinaryCache::Load( const char* const pszName, const uint64_t uiKey, const GLuint program ) const
+{
+	assert( pszName );
+
+	if( !m_bEnabled )
+		return false;
+
+	char szFileName[ MAX_PATH_LENGTH ];
+
+	GetCacheFileName( pszName, szFileName, sizeof( szFileName ) );
+
+	FILE* pFile = fopen( szFileName, "rb" );
+
+	if( !pFile )
+		return false;
+
+	ProgramBinaryHeader_t header;
+
+	bool bSuccess = fread( &header, sizeof( header ), 1, pFile ) == 1;
+
+	//A different key means the sources or the driver changed.
+	bSuccess = bSuccess &&
+		header.uiMagic == PROGRAM_BINARY_MAGIC &&
+		header.uiVersion == PROGRAM_BINARY_VERSION &&
+		header.uiKey == uiKey &&
+		header.uiLength > 0;
+
+	std::unique_ptr<char[]> binary;
+
+	if( bSuccess )
+	{
+		binary.reset( new char[ header.uiLength ] );
+
+		bSuccess = fread( binary.get(), header.uiLength, 1, pFile ) == 1;
+	}
+
+	fclose( pFile );
+
+	if( !bSuccess )
+		return false;
+
+	//The driver can reject binaries, for example after an update that didn't change the version string.
+	g_GLDiagnostics.PushIgnoreErrorsGroup( "Load program binary", __FILE__, __LINE__ );
+
+	glProgramBinary( program, header.format, binary.get(), static_cast<GLsizei>( header.uiLength ) );
+
+	g_GLDiagnostics.PopGroup();
+
+	ignore_gl_errors();
+
+	GLint iLinkStatus = GL_FALSE;
+
+	glGetProgramiv( program, GL_LINK_STATUS, &iLinkStatus );
+
+	check_gl_error();
+
+	return iLinkStatus == GL_TRUE;
+}
+
+bool CProgramBinaryCache::Save( const char* const pszName, const uint64_t uiKey, const GLuint program ) const
+{
+	assert( pszName );
+
+	if( !m_bEnabled )
+		return false;
+
+	GLint iLength = 0;
+
+	glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &iLength );
+
+	check_gl_error();
+
+	if( iLength <= 0 )
+		return false;
+
+	std::unique_ptr<char[]> binary( new char[ iLength ] );
+
+	GLenum format = 0;
+
+	GLsizei iWritten = 0;
+
+	glGetProgramBinary( program, iLength, &iWritten, &format, binary.get() );
+
+	check_gl_error();
+
+	if( iWritten <= 0 )
+		return false;
+
+	ProgramBinaryHeader_t header;
+
+	header.uiMagic = PROGRAM_BINARY_MAGIC;
+	header.uiVersion = PROGRAM_BINARY_VERSION;
+	header.uiKey = uiKey;
+	header.format = format;
+	header.uiLength = static_cast<uint32_t>( iWritten );
+
+	char szFileName[ MAX_PATH_LENGTH ];
+
+	GetCacheFileName( pszName, szFileName, sizeof( szFileName ) );
+
+	FILE* pFile = fopen( szFileName, "wb" );
+
+	if( !pFile )
+	{
+		g_Logger.Error( LogCategory::GL, "Couldn't open \"%s\" for writing\n", szFileName );
+		return false;
+	}
+
+	bool bSuccess = fwrite( &header, sizeof( header ), 1, pFile ) == 1;
+
+	bSuccess = bSuccess && fwrite( binary.get(), header.uiLength, 1, pFile ) == 1;
+
+	fclose( pFile );
+
+	if( !bSuccess )
+	{
+		g_Logger.Error( LogCategory::GL, "Couldn't write \"%s\"\n", szFileName );
+
+		//Don't leave a truncated binary behind.
+		remove( szFileName );
+	}
+
+	return bSuccess;
+}
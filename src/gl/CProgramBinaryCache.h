@@ -0,0 +1,80 @@
+#ifndef GL_CPROGRAMBINARYCACHE_H
+#define GL_CPROGRAMBINARYCACHE_H
+
+#include <cstdint>
+
+#include <gl/glew.h>
+
+class CBaseShader;
+
+#define PROGRAM_BINARY_CACHE_DIR "shadercache/"
+#define PROGRAM_BINARY_EXT ".bin"
+
+/**
+*	Stores linked programs on disk using GL_ARB_get_program_binary, so they don't have to be compiled again on the next launch.
+*	Binaries are keyed by a hash of the shader sources, the shader interface and the driver's vendor, renderer and version strings.
+*	A binary with a different key, or one the driver rejects, is ignored; the program is compiled and the binary replaced.
+*/
+class CProgramBinaryCache final
+{
+public:
+	/**
+	*	Constructor.
+	*/
+	CProgramBinaryCache() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CProgramBinaryCache() = default;
+
+	/**
+	*	Checks whether the driver supports program binaries and creates the cache directory. Requires a GL context.
+	*	@return Whether the cache can be used. If not, all programs are compiled.
+	*/
+	bool Initialize();
+
+	bool IsEnabled() const { return m_bEnabled; }
+
+	/**
+	*	Computes the key of a program.
+	*	@param pShader Shader. Its attribute and output names are part of the key, since they are bound before linking.
+	*	@param pszVertexSource Vertex shader source.
+	*	@param pszFragSource Fragment shader source.
+	*/
+	uint64_t ComputeKey( const CBaseShader* pShader, const char* const pszVertexSource, const char* const pszFragSource ) const;
+
+	/**
+	*	Loads a program binary into a program.
+	*	@param pszName Shader name.
+	*	@param uiKey Key of the program.
+	*	@param program Program to load the binary into.
+	*	@return Whether a binary with the given key was found and the program was linked successfully.
+	*/
+	bool Load( const char* const pszName, const uint64_t uiKey, const GLuint program ) const;
+
+	/**
+	*	Saves the binary of a linked program.
+	*	@param pszName Shader name.
+	*	@param uiKey Key of the program.
+	*	@param program Linked program. Should have GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+	*	@return Whether the binary was saved.
+	*/
+	bool Save( const char* const pszName, const uint64_t uiKey, const GLuint program ) const;
+
+private:
+	bool m_bEnabled = false;
+
+	/**
+	*	Hash of the driver strings, used as the seed for program keys.
+	*/
+	uint64_t m_uiDriverHash = 0;
+
+private:
+	CProgramBinaryCache( const CProgramBinaryCache& ) = delete;
+	CProgramBinaryCache& operator=( const CProgramBinaryCache& ) = delete;
+};
+
+extern CProgramBinaryCache g_ProgramBinaryCache;
+
+#endif //GL_CPROGRAMBINARYCACHE_H
@@ -0,0 +1,134 @@
+#include <cassert>
+#include <cstring>
+
+#include "CShaderInstance.h"
+
+#include "CRenderQueue.h"
+
+static_assert( CRenderQueue::PASS_BITS + CRenderQueue::SHADER_BITS + CRenderQueue::TEXTURE_BITS + CRenderQueue::LIGHTMAP_BITS + CRenderQueue::DEPTH_BITS <= 64,
+	"Render queue keys do not fit in 64 bits" );
+
+static_assert( static_cast<int>( RenderPass::NUM ) <= ( 1 << CRenderQueue::PASS_BITS ), "Too many render passes for the pass bits" );
+
+const char* GetRenderPassName( const RenderPass pass )
+{
+	switch( pass )
+	{
+	case RenderPass::NORMAL:	return "Normal pass";
+	case RenderPass::ALPHATEST:	return "Alpha test pass";
+	case RenderPass::WATER:		return "Water pass";
+	case RenderPass::BLENDED:	return "Blended pass";
+	default:					return "Unknown pass";
+	}
+}
+
+/**
+*	Number of bits sorted per radix pass.
+*/
+static const int RADIX_BITS = 8;
+static const size_t RADIX_SIZE = 1 << RADIX_BITS;
+static const int NUM_RADIX_PASSES = 64 / RADIX_BITS;
+
+static inline uint64_t MaskBits( const uint64_t uiValue, const int iBits )
+{
+	return uiValue & ( ( static_cast<uint64_t>( 1 ) << iBits ) - 1 );
+}
+
+void CRenderQueue::Begin( const float flMaxDepth )
+{
+	m_Items.clear();
+
+	m_flDepthScale = flMaxDepth > 0 ? ( ( 1 << DEPTH_BITS ) - 1 ) / flMaxDepth : 0;
+}
+
+void CRenderQueue::Add( const RenderPass pass, CShaderInstance* pShader, const uint32_t texture, const uint32_t lightmap, const float flDepth, msurface_t* pSurface, CBaseEntity* pEntity )
+{
+	assert( pShader );
+	assert( pSurface );
+	assert( pEntity );
+
+	float flScaledDepth = flDepth * m_flDepthScale;
+
+	if( flScaledDepth < 0 )
+		flScaledDepth = 0;
+
+	const uint64_t uiMaxDepth = ( static_cast<uint64_t>( 1 ) << DEPTH_BITS ) - 1;
+
+	uint64_t uiDepth = static_cast<uint64_t>( flScaledDepth );
+
+	if( uiDepth > uiMaxDepth )
+		uiDepth = uiMaxDepth;
+
+	const uint64_t uiState =
+		( MaskBits( pShader->GetIndex(), SHADER_BITS ) << ( TEXTURE_BITS + LIGHTMAP_BITS ) ) |
+		( MaskBits( texture, TEXTURE_BITS ) << LIGHTMAP_BITS ) |
+		MaskBits( lightmap, LIGHTMAP_BITS );
+
+	uint64_t uiKey = static_cast<uint64_t>( pass ) << ( 64 - PASS_BITS );
+
+	if( pass == RenderPass::BLENDED )
+	{
+		//Far surfaces first.
+		uiKey |= ( uiMaxDepth - uiDepth ) << ( 64 - PASS_BITS - DEPTH_BITS );
+		uiKey |= uiState << ( 64 - PASS_BITS - DEPTH_BITS - SHADER_BITS - TEXTURE_BITS - LIGHTMAP_BITS );
+	}
+	else
+	{
+		//Near surfaces first, so the depth test rejects more fragments.
+		uiKey |= uiState << ( 64 - PASS_BITS - SHADER_BITS - TEXTURE_BITS - LIGHTMAP_BITS );
+		uiKey |= uiDepth << ( 64 - PASS_BITS - SHADER_BITS - TEXTURE_BITS - LIGHTMAP_BITS - DEPTH_BITS );
+	}
+
+	m_Items.push_back( { uiKey, pShader, pSurface, pEntity } );
+}
+
+void CRenderQueue::Sort()
+{
+	const size_t uiCount = m_Items.size();
+
+	if( uiCount < 2 )
+		return;
+
+	//Count the digits for all passes at once.
+	size_t counts[ NUM_RADIX_PASSES ][ RADIX_SIZE ];
+
+	memset( counts, 0, sizeof( counts ) );
+
+	for( const auto& item : m_Items )
+	{
+		for( int iPass = 0; iPass < NUM_RADIX_PASSES; ++iPass )
+		{
+			++counts[ iPass ][ ( item.uiKey >> ( iPass * RADIX_BITS ) ) & ( RADIX_SIZE - 1 ) ];
+		}
+	}
+
+	m_SortBuffer.resize( uiCount );
+
+	for( int iPass = 0; iPass < NUM_RADIX_PASSES; ++iPass )
+	{
+		size_t* pCounts = counts[ iPass ];
+
+		const int iShift = iPass * RADIX_BITS;
+
+		//Every item has the same digit, so this pass wouldn't change the order.
+		if( pCounts[ ( m_Items[ 0 ].uiKey >> iShift ) & ( RADIX_SIZE - 1 ) ] == uiCount )
+			continue;
+
+		//Convert counts to offsets.
+		size_t uiOffset = 0;
+
+		for( size_t uiDigit = 0; uiDigit < RADIX_SIZE; ++uiDigit )
+		{
+			const size_t uiDigitCount = pCounts[ uiDigit ];
+			pCounts[ uiDigit ] = uiOffset;
+			uiOffset += uiDigitCount;
+		}
+
+		for( const auto& item : m_Items )
+		{
+			m_SortBuffer[ pCounts[ ( item.uiKey >> iShift ) & ( RADIX_SIZE - 1 ) ]++ ] = item;
+		}
+
+		m_Items.swap( m_SortBuffer );
+	}
+}
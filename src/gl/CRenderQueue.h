@@ -0,0 +1,136 @@
+#ifndef GL_CRENDERQUEUE_H
+#define GL_CRENDERQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct msurface_t;
+class CBaseEntity;
+class CShaderInstance;
+
+/**
+*	Render passes, in the order that they are drawn.
+*/
+enum class RenderPass
+{
+	FIRST		= 0,
+
+	/**
+	*	Opaque surfaces.
+	*/
+	NORMAL		= FIRST,
+
+	/**
+	*	'{' textures.
+	*/
+	ALPHATEST,
+
+	/**
+	*	'!' textures.
+	*/
+	WATER,
+
+	/**
+	*	Entities with a blending render mode. Drawn back to front.
+	*/
+	BLENDED,
+
+	LAST		= BLENDED,
+
+	NUM
+};
+
+/**
+*	@return Name of a render pass, for debugging.
+*/
+const char* GetRenderPassName( const RenderPass pass );
+
+/**
+*	Collects the surfaces to draw in a frame and sorts them with a single 64 bit key per draw.
+*	From most to least significant bits, keys contain:
+*	Non-blended passes: pass, shader, texture, lightmap, depth (front to back).
+*	Blended pass: pass, inverted depth (back to front), shader, texture, lightmap.
+*	Sorting by key gives the correct pass order and blending order, and groups draws that use the same state.
+*	Texture and lightmap bits are taken from the low bits of their GL names, so different textures can share a key;
+*	this only makes grouping less optimal, the draw loop still compares the actual state.
+*/
+class CRenderQueue final
+{
+public:
+	static const int PASS_BITS		= 2;
+	static const int SHADER_BITS	= 8;
+	static const int TEXTURE_BITS	= 16;
+	static const int LIGHTMAP_BITS	= 8;
+	static const int DEPTH_BITS		= 24;
+
+	struct DrawItem_t
+	{
+		uint64_t uiKey;
+		CShaderInstance* pShader;
+		msurface_t* pSurface;
+		CBaseEntity* pEntity;
+	};
+
+	typedef std::vector<DrawItem_t> DrawItems_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CRenderQueue() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CRenderQueue() = default;
+
+	/**
+	*	Removes all items and starts a new frame.
+	*	@param flMaxDepth Largest depth that will be added. Depths are quantized over the range [ 0, flMaxDepth ].
+	*/
+	void Begin( const float flMaxDepth );
+
+	/**
+	*	Adds a surface to draw.
+	*	@param pass Pass to draw the surface in.
+	*	@param pShader Shader permutation to draw the surface with.
+	*	@param texture GL name of the texture.
+	*	@param lightmap GL name of the lightmap page.
+	*	@param flDepth Distance from the camera to the surface.
+	*	@param pSurface Surface to draw.
+	*	@param pEntity Entity that the surface belongs to.
+	*/
+	void Add( const RenderPass pass, CShaderInstance* pShader, const uint32_t texture, const uint32_t lightmap, const float flDepth, msurface_t* pSurface, CBaseEntity* pEntity );
+
+	/**
+	*	Sorts the items by key using an LSD radix sort. Digits that are the same for every item are skipped.
+	*/
+	void Sort();
+
+	const DrawItems_t& GetItems() const { return m_Items; }
+
+	/**
+	*	@return The pass that a key belongs to.
+	*/
+	static RenderPass GetPass( const uint64_t uiKey )
+	{
+		return static_cast<RenderPass>( uiKey >> ( 64 - PASS_BITS ) );
+	}
+
+private:
+	DrawItems_t m_Items;
+
+	/**
+	*	Scratch space for the sort.
+	*/
+	DrawItems_t m_SortBuffer;
+
+	float m_flDepthScale = 0;
+
+private:
+	CRenderQueue( const CRenderQueue& ) = delete;
+	CRenderQueue& operator=( const CRenderQueue& ) = delete;
+};
+
+#endif //GL_CRENDERQUEUE_H
@@ -1,12 +1,17 @@
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
-#include <glm/gtc/type_ptr.hpp>
+#include "utility/CLogger.h"
 
 #include "GLUtil.h"
 
+#include "CGLStateCache.h"
+#include "CProgramBinaryCache.h"
+
 #include "CBaseShader.h"
+#include "ShaderUniformBlocks.h"
 
 #include "CShaderInstance.h"
 
@@ -55,6 +60,33 @@ static const char* const TypeToString[ static_cast<size_t>( AttributeType::NUM_T
 	"sampler2D",	//SAMPLER_TEXTURE
 };
 
+/**
+*	Logs a shader or program info log one line at a time, so long logs aren't truncated to a single log record.
+*/
+static void LogInfoLog( const char* pszLog )
+{
+	char szLine[ CLogger::STRING_BUFFER_SIZE ];
+
+	while( *pszLog )
+	{
+		const char* pszEnd = strchr( pszLog, '\n' );
+
+		const size_t uiLength = pszEnd ? static_cast<size_t>( pszEnd - pszLog ) : strlen( pszLog );
+
+		const size_t uiCount = uiLength < sizeof( szLine ) ? uiLength : sizeof( szLine ) - 1;
+
+		memcpy( szLine, pszLog, uiCount );
+		szLine[ uiCount ] = '\0';
+
+		g_Logger.Error( LogCategory::GL, "%s\n", szLine );
+
+		pszLog += uiLength;
+
+		if( *pszLog == '\n' )
+			++pszLog;
+	}
+}
+
 CShaderInstance::CShaderInstance()
 {
 }
@@ -71,28 +103,89 @@ CShaderInstance::~CShaderInstance()
 	}
 }
 
-bool CShaderInstance::Initialize( CBaseShader* pShader )
+bool CShaderInstance::Initialize( CBaseShader* pShader, const uint32_t uiFeatures, const size_t uiIndex )
 {
 	assert( pShader );
 	assert( m_Program == 0 );
+	assert( ( uiFeatures & ~pShader->GetFeatures() ) == 0 );
 
 	m_pShader = pShader;
+	m_uiFeatures = uiFeatures;
+	m_uiIndex = uiIndex;
 
 	const char* const pszName = pShader->GetName();
 
-	std::unique_ptr<char[]> vertex( LoadShaderFile( pszName, SHADER_VERTEX_EXT ) );
-	std::unique_ptr<char[]> frag( LoadShaderFile( pszName, SHADER_FRAG_EXT ) );
+	std::unique_ptr<char[]> vertexFile( LoadShaderFile( pszName, SHADER_VERTEX_EXT ) );
+	std::unique_ptr<char[]> fragFile( LoadShaderFile( pszName, SHADER_FRAG_EXT ) );
+
+	if( !vertexFile || !fragFile )
+		return false;
+
+	const std::string vertex = AddFeatureDefines( vertexFile.get() );
+	const std::string frag = AddFeatureDefines( fragFile.get() );
+
+	//Every permutation has its own binary.
+	char szCacheName[ 256 ];
+
+	snprintf( szCacheName, sizeof( szCacheName ), "%s_%X", pszName, uiFeatures );
+
+	//Binaries are only valid for the same sources and driver.
+	const bool bUseCache = g_ProgramBinaryCache.IsEnabled();
+
+	const uint64_t uiKey = bUseCache ? g_ProgramBinaryCache.ComputeKey( pShader, vertex.c_str(), frag.c_str() ) : 0;
+
+	bool bLoadedBinary = false;
+
+	if( bUseCache )
+	{
+		m_Program = glCreateProgram();
+
+		check_gl_error();
+
+		bLoadedBinary = g_ProgramBinaryCache.Load( szCacheName, uiKey, m_Program );
+
+		if( !bLoadedBinary )
+		{
+			glDeleteProgram( m_Program );
+
+			check_gl_error();
+
+			m_Program = 0;
+		}
+	}
+
+	if( !bLoadedBinary && !CompileAndLink( vertex.c_str(), frag.c_str() ) )
+		return false;
+
+	if( !OnPostLink() )
+	{
+		g_Logger.Error( LogCategory::GL, "Error post-linking shader program \"%s\" (%d)!\n", pszName, m_Program );
+		glDeleteProgram( m_Program );
+
+		check_gl_error();
+
+		m_Program = 0;
 
-	if( !vertex || !frag )
 		return false;
+	}
+
+	if( bUseCache && !bLoadedBinary )
+		g_ProgramBinaryCache.Save( szCacheName, uiKey, m_Program );
+
+	return true;
+}
+
+bool CShaderInstance::CompileAndLink( const char* const pszVertexSource, const char* const pszFragSource )
+{
+	const char* const pszName = m_pShader->GetName();
 
 	GLuint vertexShader;
 	GLuint fragShader;
 
-	if( !CreateShader( pszName, vertex.get(), GL_VERTEX_SHADER, vertexShader ) )
+	if( !CreateShader( pszName, pszVertexSource, GL_VERTEX_SHADER, vertexShader ) )
 		return false;
 
-	if( !CreateShader( pszName, frag.get(), GL_FRAGMENT_SHADER, fragShader ) )
+	if( !CreateShader( pszName, pszFragSource, GL_FRAGMENT_SHADER, fragShader ) )
 	{
 		glDeleteShader( vertexShader );
 
@@ -115,6 +208,13 @@ bool CShaderInstance::Initialize( CBaseShader* pShader )
 
 	OnPreLink();
 
+	if( g_ProgramBinaryCache.IsEnabled() )
+	{
+		glProgramParameteri( m_Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+
+		check_gl_error();
+	}
+
 	//Link program
 	glLinkProgram( m_Program );
 
@@ -137,7 +237,7 @@ bool CShaderInstance::Initialize( CBaseShader* pShader )
 
 	if( programSuccess != GL_TRUE )
 	{
-		printf( "Error linking shader program \"%s\" (%d)!\n", pszName, m_Program );
+		g_Logger.Error( LogCategory::GL, "Error linking shader program \"%s\" (%d)!\n", pszName, m_Program );
 		PrintProgramLog( m_Program );
 
 		glDeleteProgram( m_Program );
@@ -149,18 +249,6 @@ bool CShaderInstance::Initialize( CBaseShader* pShader )
 		return false;
 	}
 
-	if( !OnPostLink() )
-	{
-		printf( "Error post-linking shader program \"%s\" (%d)!\n", pszName, m_Program );
-		glDeleteProgram( m_Program );
-
-		check_gl_error();
-
-		m_Program = 0;
-
-		return false;
-	}
-
 	return true;
 }
 
@@ -168,16 +256,12 @@ void CShaderInstance::Bind()
 {
 	assert( IsValid() );
 
-	glUseProgram( m_Program );
-
-	check_gl_error();
+	g_GLState.UseProgram( m_Program );
 }
 
 void CShaderInstance::Unbind()
 {
-	glUseProgram( 0 );
-
-	check_gl_error();
+	g_GLState.UseProgram( 0 );
 }
 
 void CShaderInstance::EnableVAA()
@@ -200,39 +284,6 @@ void CShaderInstance::DisableVAA()
 	}
 }
 
-void CShaderInstance::SetupParams( const glm::mat4x4& projection, const glm::mat4x4& view, const glm::mat4x4& model )
-{
-	glUniformMatrix4fv( m_MatProjUniform, 1, GL_FALSE, glm::value_ptr( projection ) );
-
-	check_gl_error();
-
-	glUniformMatrix4fv( m_MatViewUniform, 1, GL_FALSE, glm::value_ptr( view ) );
-
-	check_gl_error();
-
-	glUniformMatrix4fv( m_MatModelUniform, 1, GL_FALSE, glm::value_ptr( model ) );
-
-	check_gl_error();
-
-	//Set samplers.
-	//TODO: apparently these can be set in the shader file itself. Consider replacing this with that.
-	CBaseShaderAttribute* pUniform;
-
-	GLint iSampler = 0;
-
-	for( size_t uiIndex = 0; uiIndex < m_uiNumUniforms; ++uiIndex )
-	{
-		pUniform = m_pShader->GetUniform( uiIndex );
-
-		if( pUniform->GetType() == AttributeType::SAMPLER_TEXTURE )
-		{
-			glUniform1i( m_pUniforms[ uiIndex ], iSampler++ );
-
-			check_gl_error();
-		}
-	}
-}
-
 void CShaderInstance::Activate( const CBaseEntity* pEntity )
 {
 	m_pShader->Activate( this, pEntity );
@@ -240,7 +291,7 @@ void CShaderInstance::Activate( const CBaseEntity* pEntity )
 
 void CShaderInstance::SetupVertexAttribs()
 {
-	CBaseShaderAttribute* pAttrib;
+	const CBaseShaderAttribute* pAttrib;
 
 	size_t uiOffset = 0;
 
@@ -262,16 +313,23 @@ void CShaderInstance::SetupVertexAttribs()
 	}
 }
 
-void CShaderInstance::Draw( const size_t uiNumVerts )
+void CShaderInstance::Draw( const GLint* pFirsts, const GLsizei* pCounts, const size_t uiNumDraws )
 {
-	m_pShader->OnDraw( this, uiNumVerts );
+	m_pShader->OnDraw( this, pFirsts, pCounts, uiNumDraws );
 }
 
 void CShaderInstance::OnPreLink()
 {
+	const size_t uiNumAttributes = m_pShader->GetNumAttributes();
+
+	for( size_t uiIndex = 0; uiIndex < uiNumAttributes; ++uiIndex )
+	{
+		glBindAttribLocation( m_Program, static_cast<GLuint>( uiIndex ), m_pShader->GetAttribute( uiIndex )->GetName() );
+	}
+
 	const size_t uiCount = m_pShader->GetNumOutputs();
 
-	CBaseShaderOutput* pOutput;
+	const CBaseShaderOutput* pOutput;
 
 	for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
 	{
@@ -285,7 +343,7 @@ bool CShaderInstance::OnPostLink()
 {
 	m_uiNumAttributes = m_pShader->GetNumAttributes();
 
-	CBaseShaderAttribute* pAttrib;
+	const CBaseShaderAttribute* pAttrib;
 
 	m_pAttributes = new GLint[ m_uiNumAttributes ];
 
@@ -299,34 +357,22 @@ bool CShaderInstance::OnPostLink()
 
 		if( m_pAttributes[ uiIndex ] == -1 )
 		{
-			printf( "Failed to find shader attribute \"%s %s\" (Index %u)\n", TypeToString[ static_cast<size_t>( pAttrib->GetType() ) ], pAttrib->GetName(), pAttrib->GetIndex() );
+			g_Logger.Error( LogCategory::GL, "Failed to find shader attribute \"%s %s\" (Index %u)\n", TypeToString[ static_cast<size_t>( pAttrib->GetType() ) ], pAttrib->GetName(), pAttrib->GetIndex() );
 
 			bSuccess = false;
 		}
 	}
 
-	struct MatData
-	{
-		GLint& index;
-		const char* const pszName;
-	};
-
-	MatData mats[ 3 ] = 
+	for( GLuint uiBinding = 0; uiBinding < NUM_UNIFORM_BLOCKS; ++uiBinding )
 	{
-		{ m_MatProjUniform, "matProj" },
-		{ m_MatViewUniform, "matView" },
-		{ m_MatModelUniform, "matModel" }
-	};
+		const GLuint blockIndex = glGetUniformBlockIndex( m_Program, UNIFORM_BLOCK_NAMES[ uiBinding ] );
 
-	for( auto& mat : mats )
-	{
-		mat.index = glGetUniformLocation( m_Program, mat.pszName );
-
-		if( mat.index == -1 )
+		//Shaders that don't need a block can leave it out.
+		if( blockIndex != GL_INVALID_INDEX )
 		{
-			printf( "Failed to find shader uniform \"%s %s\"\n", TypeToString[ static_cast<size_t>( AttributeType::MAT4X4 ) ], mat.pszName );
+			glUniformBlockBinding( m_Program, blockIndex, uiBinding );
 
-			bSuccess = false;
+			check_gl_error();
 		}
 	}
 
@@ -340,9 +386,10 @@ bool CShaderInstance::OnPostLink()
 
 		m_pUniforms[ uiIndex ] = glGetUniformLocation( m_Program, pAttrib->GetName() );
 
-		if( m_pUniforms[ uiIndex ] == -1 )
+		//Uniforms that belong to features this permutation doesn't have are optimized out.
+		if( m_pUniforms[ uiIndex ] == -1 && ( !pAttrib->GetFeatures() || ( pAttrib->GetFeatures() & m_uiFeatures ) ) )
 		{
-			printf( "Failed to find shader uniform \"%s %s\" (Index %u)\n", TypeToString[ static_cast<size_t>( pAttrib->GetType() ) ], pAttrib->GetName(), pAttrib->GetIndex() );
+			g_Logger.Error( LogCategory::GL, "Failed to find shader uniform \"%s %s\" (Index %u)\n", TypeToString[ static_cast<size_t>( pAttrib->GetType() ) ], pAttrib->GetName(), pAttrib->GetIndex() );
 
 			bSuccess = false;
 		}
@@ -353,7 +400,7 @@ bool CShaderInstance::OnPostLink()
 		//Precalculate the per-vertex data size.
 		m_uiAttribSizeInBytes = 0;
 
-		CBaseShaderAttribute* pAttrib;
+		const CBaseShaderAttribute* pAttrib;
 
 		for( size_t uiIndex = 0; uiIndex < m_uiNumAttributes; ++uiIndex )
 		{
@@ -363,9 +410,65 @@ bool CShaderInstance::OnPostLink()
 		}
 	}
 
+	if( bSuccess )
+	{
+		//Samplers use texture units in the order they are declared.
+		glUseProgram( m_Program );
+
+		GLint iSampler = 0;
+
+		for( size_t uiIndex = 0; uiIndex < m_uiNumUniforms; ++uiIndex )
+		{
+			if( m_pShader->GetUniform( uiIndex )->GetType() == AttributeType::SAMPLER_TEXTURE )
+				glUniform1i( m_pUniforms[ uiIndex ], iSampler++ );
+		}
+
+		glUseProgram( 0 );
+
+		check_gl_error();
+	}
+
 	return bSuccess;
 }
 
+std::string CShaderInstance::AddFeatureDefines( const char* const pszSource ) const
+{
+	assert( pszSource );
+
+	std::string defines;
+
+	for( size_t uiBit = 0; uiBit < NUM_SHADER_FEATURES; ++uiBit )
+	{
+		if( m_uiFeatures & ( 1 << uiBit ) )
+		{
+			defines += "#define ";
+			defines += SHADER_FEATURE_NAMES[ uiBit ];
+			defines += " 1\n";
+		}
+	}
+
+	//#version must be the first directive, so the defines go after it.
+	const char* pszInsert = pszSource;
+
+	if( strncmp( pszSource, "#version", 8 ) == 0 )
+	{
+		pszInsert = strchr( pszSource, '\n' );
+
+		pszInsert = pszInsert ? pszInsert + 1 : pszSource + strlen( pszSource );
+	}
+
+	std::string source( pszSource, pszInsert );
+
+	//A version line without a newline at the end of the file.
+	if( pszInsert > pszSource && pszInsert[ -1 ] != '\n' )
+		source += '\n';
+
+	source += defines;
+	source += pszInsert;
+
+	return source;
+}
+
 char* CShaderInstance::LoadShaderFile( const char* const pszName, const char* const pszExt )
 {
 	assert( pszName );
@@ -402,7 +505,7 @@ char* CShaderInstance::LoadShaderFile( const char* const pszName, const char* co
 		delete[] pszData;
 	}
 
-	printf( "Failed to load shader file \"%s\"\n", szBuffer );
+	g_Logger.Error( LogCategory::GL, "Failed to load shader file \"%s\"\n", szBuffer );
 
 	return nullptr;
 }
@@ -422,7 +525,7 @@ bool CShaderInstance::CreateShader( const char* const pszName, const char* const
 		return true;
 
 	//TODO: handle all shader types - Solokiller
-	printf( "Failed to compile %s shader \"%s\"\n", type == GL_VERTEX_SHADER ? "vertex" : "fragment", pszName );
+	g_Logger.Error( LogCategory::GL, "Failed to compile %s shader \"%s\"\n", type == GL_VERTEX_SHADER ? "vertex" : "fragment", pszName );
 
 	PrintShaderLog( shader );
 
@@ -453,7 +556,7 @@ void CShaderInstance::PrintShaderLog( GLuint shader )
 		if( infoLogLength > 0 )
 		{
 			//Print Log
-			printf( "%s\n", infoLog );
+			LogInfoLog( infoLog );
 		}
 
 		//Deallocate string
@@ -461,7 +564,7 @@ void CShaderInstance::PrintShaderLog( GLuint shader )
 	}
 	else
 	{
-		printf( "Name %d is not a shader\n", shader );
+		g_Logger.Error( LogCategory::GL, "Name %d is not a shader\n", shader );
 	}
 }
 
@@ -485,7 +588,7 @@ void CShaderInstance::PrintProgramLog( GLuint program )
 		if( infoLogLength > 0 )
 		{
 			//Print Log
-			printf( "%s\n", infoLog );
+			LogInfoLog( infoLog );
 		}
 
 		//Deallocate string
@@ -493,6 +596,6 @@ void CShaderInstance::PrintProgramLog( GLuint program )
 	}
 	else
 	{
-		printf( "Name %d is not a program\n", program );
+		g_Logger.Error( LogCategory::GL, "Name %d is not a program\n", program );
 	}
 }
\ No newline at end of file
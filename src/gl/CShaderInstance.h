@@ -1,6 +1,9 @@
 #ifndef GL_CSHADERINSTANCE_H
 #define GL_CSHADERINSTANCE_H
 
+#include <cstdint>
+#include <string>
+
 #include <glm/mat4x4.hpp>
 
 #include <gl/glew.h>
@@ -19,7 +22,18 @@ public:
 	*/
 	bool IsValid() const { return m_Program != 0; }
 
-	bool Initialize( CBaseShader* pShader );
+	/**
+	*	Creates the program. Loads it from the program binary cache if possible, otherwise compiles and links it.
+	*	@param pShader Shader to instantiate.
+	*	@param uiFeatures ShaderFeature flags of the permutation to create. Must be supported by the shader.
+	*	@param uiIndex Index of this instance in the shader manager.
+	*/
+	bool Initialize( CBaseShader* pShader, const uint32_t uiFeatures, const size_t uiIndex );
+
+	/**
+	*	@return Index of this instance in the shader manager. Indices are small, so they can be used in sort keys.
+	*/
+	size_t GetIndex() const { return m_uiIndex; }
 
 	/**
 	*	Binds this shader.
@@ -41,11 +55,6 @@ public:
 	*/
 	void DisableVAA();
 
-	/**
-	*	Set up parameters for drawing.
-	*/
-	void SetupParams( const glm::mat4x4& projection, const glm::mat4x4& view, const glm::mat4x4& model );
-
 	/**
 	*	Activates the shader for the given entity.
 	*/
@@ -57,26 +66,47 @@ public:
 	void SetupVertexAttribs();
 
 	/**
-	*	Draw current data.
+	*	Draws a batch of vertex ranges from the bound vertex array.
+	*	@see CBaseShader::OnDraw
 	*/
-	void Draw( const size_t uiNumVerts );
+	void Draw( const GLint* pFirsts, const GLsizei* pCounts, const size_t uiNumDraws );
+
+	CBaseShader* GetShader() const { return m_pShader; }
+
+	/**
+	*	@return ShaderFeature flags that this permutation was compiled with.
+	*/
+	uint32_t GetFeatures() const { return m_uiFeatures; }
 
 	const GLint* GetAttributes() const { return m_pAttributes; }
 
 	const GLint* GetUniforms() const { return m_pUniforms; }
 
 private:
+	/**
+	*	Compiles the sources and links them into m_Program.
+	*	@return true on success, false otherwise.
+	*/
+	bool CompileAndLink( const char* const pszVertexSource, const char* const pszFragSource );
+
 	/**
 	*	Called after compilation, before linking.
+	*	Binds attribute i to location i, so shaders with the same attribute layout can share vertex array objects.
 	*/
 	void OnPreLink();
 
 	/**
 	*	Called after linking has succeeded.
+	*	Binds the shared uniform blocks and assigns texture units to samplers, neither of which change afterwards.
 	*	@return true if the shader is valid, false otherwise.
 	*/
 	bool OnPostLink();
 
+	/**
+	*	Defines the features of this permutation in a shader's source. The defines are inserted after the #version directive.
+	*/
+	std::string AddFeatureDefines( const char* const pszSource ) const;
+
 	/**
 	*	Loads a shader file.
 	*	@param pszName Shader name.
@@ -107,15 +137,15 @@ private:
 private:
 	CBaseShader* m_pShader = nullptr;
 
+	uint32_t m_uiFeatures = 0;
+
+	size_t m_uiIndex = 0;
+
 	GLuint m_Program = 0;
 
 	size_t m_uiNumAttributes = 0;
 	GLint* m_pAttributes = nullptr;
 
-	GLint m_MatProjUniform = -1;
-	GLint m_MatViewUniform = -1;
-	GLint m_MatModelUniform = -1;
-
 	size_t m_uiNumUniforms = 0;
 	GLint* m_pUniforms = nullptr;
 
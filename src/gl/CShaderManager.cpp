@@ -1,10 +1,16 @@
 #include <cassert>
 #include <cstdio>
 
+#include "utility/CLogger.h"
+
 #include "GLUtil.h"
 
 #include "CBaseShader.h"
+#include "CGLDiagnostics.h"
+#include "CGLStateCache.h"
+#include "CProgramBinaryCache.h"
 #include "CShaderInstance.h"
+#include "ShaderUniformBlocks.h"
 
 #include "CShaderManager.h"
 
@@ -12,27 +18,103 @@ CShaderManager g_ShaderManager;
 
 bool CShaderManager::LoadShaders()
 {
+	//Falls back to compiling everything if binaries aren't supported.
+	g_ProgramBinaryCache.Initialize();
+
 	for( auto pShader = CBaseShader::GetHead(); pShader; pShader = pShader->GetNext() )
 	{
 		if( !AddShader( pShader ) )
 			return false;
 	}
 
+	m_FrameBuffer = CreateUniformBuffer( UNIFORM_BLOCK_FRAME, sizeof( FrameUniforms_t ) );
+	m_ObjectBuffer = CreateUniformBuffer( UNIFORM_BLOCK_OBJECT, sizeof( ObjectUniforms_t ) );
+
+	m_bObjectDataValid = false;
+
 	return true;
 }
 
-CShaderInstance* CShaderManager::GetShader( const char* const pszName )
+void CShaderManager::Shutdown()
+{
+	DeactivateActiveShader();
+
+	for( auto pInstance : m_Instances )
+	{
+		delete pInstance;
+	}
+
+	m_Instances.clear();
+	m_Permutations.clear();
+	m_Shaders.clear();
+
+	//Nothing was created if there is no context.
+	if( m_FrameBuffer || m_ObjectBuffer )
+	{
+		GLuint buffers[] = { m_FrameBuffer, m_ObjectBuffer };
+
+		glDeleteBuffers( 2, buffers );
+
+		check_gl_error();
+	}
+
+	m_FrameBuffer = 0;
+	m_ObjectBuffer = 0;
+
+	m_bObjectDataValid = false;
+
+	g_GLState.Invalidate();
+}
+
+CShaderInstance* CShaderManager::GetShader( const char* const pszName, const uint32_t uiFeatures )
 {
 	assert( pszName );
 
 	auto it = m_Shaders.find( pszName );
 
 	if( it != m_Shaders.end() )
-		return it->second;
+		return GetPermutation( it->second, uiFeatures );
 
 	return nullptr;
 }
 
+CShaderInstance* CShaderManager::GetPermutation( CBaseShader* pShader, uint32_t uiFeatures )
+{
+	assert( pShader );
+
+	uiFeatures &= pShader->GetFeatures();
+
+	auto it = m_Permutations.find( { pShader, uiFeatures } );
+
+	if( it == m_Permutations.end() )
+	{
+		GLDIAG_GROUP( pShader->GetName() );
+
+		CShaderInstance* pInstance = new CShaderInstance();
+
+		if( !pInstance->Initialize( pShader, uiFeatures, m_Instances.size() ) )
+		{
+			g_Logger.Error( LogCategory::GL, "CShaderManager::GetPermutation: Permutation %X of shader \"%s\" failed to load!\n", uiFeatures, pShader->GetName() );
+
+			delete pInstance;
+
+			pInstance = nullptr;
+		}
+		else
+		{
+			m_Instances.push_back( pInstance );
+		}
+
+		it = m_Permutations.insert( std::make_pair( PermutationKey_t{ pShader, uiFeatures }, pInstance ) ).first;
+	}
+
+	//Draw with the base permutation rather than not at all.
+	if( !it->second && uiFeatures )
+		return GetPermutation( pShader, 0 );
+
+	return it->second;
+}
+
 bool CShaderManager::AddShader( CBaseShader* pShader )
 {
 	assert( pShader );
@@ -41,27 +123,35 @@ bool CShaderManager::AddShader( CBaseShader* pShader )
 
 	if( it != m_Shaders.end() )
 	{
-		printf( "CShaderManager::AddShader: Duplicate shader \"%s\"!\n", pShader->GetName() );
+		g_Logger.Error( LogCategory::GL, "CShaderManager::AddShader: Duplicate shader \"%s\"!\n", pShader->GetName() );
 		return false;
 	}
 
-	CShaderInstance* pInstance = new CShaderInstance();
-
-	if( !pInstance->Initialize( pShader ) )
+	//Compile the base permutation now to catch errors in the sources, other permutations are compiled on demand.
+	if( !GetPermutation( pShader, 0 ) )
 	{
-		printf( "CShaderManager::AddShader: Shader \"%s\" failed to load!\n", pShader->GetName() );
-
-		delete pInstance;
+		g_Logger.Error( LogCategory::GL, "CShaderManager::AddShader: Shader \"%s\" failed to load!\n", pShader->GetName() );
 
 		return false;
 	}
 
-	m_Shaders.insert( std::make_pair( pShader->GetName(), pInstance ) );
+	m_Shaders.insert( std::make_pair( pShader->GetName(), pShader ) );
 
 	return true;
 }
 
-void CShaderManager::ActivateShader( CShaderInstance* pShader, const glm::mat4x4& projection, const glm::mat4x4& view, const glm::mat4x4& model, const CBaseEntity* pEntity )
+void CShaderManager::SetFrameData( const glm::mat4x4& projection, const glm::mat4x4& view, const float flTime )
+{
+	FrameUniforms_t data;
+
+	data.matProj = projection;
+	data.matView = view;
+	data.realtime = flTime;
+
+	UpdateUniformBuffer( m_FrameBuffer, &data, sizeof( data ) );
+}
+
+void CShaderManager::ActivateShader( CShaderInstance* pShader, const glm::mat4x4& model, const CBaseEntity* pEntity )
 {
 	assert( pShader );
 
@@ -70,22 +160,24 @@ void CShaderManager::ActivateShader( CShaderInstance* pShader, const glm::mat4x4
 
 	if( m_pActiveShader != pShader )
 	{
-		if( m_pActiveShader )
-			DeactivateActiveShader();
-
 		m_pActiveShader = pShader;
 
+		//Vertex attribute arrays are enabled in the vertex array objects and shared uniforms are in uniform buffers,
+		//so switching shaders only switches programs.
 		m_pActiveShader->Bind();
+	}
 
-		check_gl_error();
-
-		m_pActiveShader->EnableVAA();
+	//Objects are drawn grouped by state, not by object, so the same transform is often activated several times in a row.
+	if( !m_bObjectDataValid || m_ObjectModelMatrix != model )
+	{
+		ObjectUniforms_t data;
 
-		check_gl_error();
+		data.matModel = model;
 
-		m_pActiveShader->SetupParams( projection, view, model );
+		UpdateUniformBuffer( m_ObjectBuffer, &data, sizeof( data ) );
 
-		check_gl_error();
+		m_ObjectModelMatrix = model;
+		m_bObjectDataValid = true;
 	}
 
 	m_pActiveShader->Activate( pEntity );
@@ -96,9 +188,34 @@ void CShaderManager::DeactivateActiveShader()
 	if( !m_pActiveShader )
 		return;
 
-	m_pActiveShader->DisableVAA();
-
 	CShaderInstance::Unbind();
 
 	m_pActiveShader = nullptr;
+}
+
+GLuint CShaderManager::CreateUniformBuffer( const GLuint uiBinding, const size_t uiSize )
+{
+	GLuint buffer;
+
+	glGenBuffers( 1, &buffer );
+
+	g_GLState.BindBuffer( GL_UNIFORM_BUFFER, buffer );
+
+	glBufferData( GL_UNIFORM_BUFFER, uiSize, nullptr, GL_DYNAMIC_DRAW );
+
+	//Also binds the buffer to the generic binding point, which g_GLState already knows about.
+	glBindBufferBase( GL_UNIFORM_BUFFER, uiBinding, buffer );
+
+	check_gl_error();
+
+	return buffer;
+}
+
+void CShaderManager::UpdateUniformBuffer( const GLuint buffer, const void* pData, const size_t uiSize )
+{
+	g_GLState.BindBuffer( GL_UNIFORM_BUFFER, buffer );
+
+	glBufferSubData( GL_UNIFORM_BUFFER, 0, uiSize, pData );
+
+	check_gl_error();
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
 #ifndef GL_CSHADERMANAGER_H
 #define GL_CSHADERMANAGER_H
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include <gl/glew.h>
 
 #include <glm/mat4x4.hpp>
 
@@ -16,32 +21,117 @@ class CShaderManager final
 {
 private:
 
-	typedef std::unordered_map<const char*, CShaderInstance*, RawCharHash, RawCharEqualTo> Shaders_t;
+	typedef std::unordered_map<const char*, CBaseShader*, RawCharHash, RawCharEqualTo> Shaders_t;
+
+	/**
+	*	Identifies a permutation of a shader.
+	*/
+	struct PermutationKey_t
+	{
+		const CBaseShader* pShader;
+		uint32_t uiFeatures;
+
+		bool operator==( const PermutationKey_t& other ) const
+		{
+			return pShader == other.pShader && uiFeatures == other.uiFeatures;
+		}
+	};
+
+	struct PermutationKeyHash
+	{
+		size_t operator()( const PermutationKey_t& key ) const
+		{
+			return std::hash<const CBaseShader*>()( key.pShader ) ^ ( key.uiFeatures * 0x9E3779B9U );
+		}
+	};
+
+	/**
+	*	Permutations that failed to compile are stored as null, so they aren't compiled again.
+	*/
+	typedef std::unordered_map<PermutationKey_t, CShaderInstance*, PermutationKeyHash> Permutations_t;
 
 public:
 	CShaderManager() = default;
 	~CShaderManager() = default;
 
+	/**
+	*	Loads the base permutation of all shaders and creates the shared uniform buffers.
+	*/
 	bool LoadShaders();
 
-	CShaderInstance* GetShader( const char* const pszName );
+	/**
+	*	Frees all shaders and uniform buffers.
+	*/
+	void Shutdown();
+
+	/**
+	*	Gets a permutation of a shader by name.
+	*	@see GetPermutation
+	*/
+	CShaderInstance* GetShader( const char* const pszName, const uint32_t uiFeatures = 0 );
+
+	/**
+	*	Gets a permutation of a shader. Permutations are compiled the first time they are requested.
+	*	@param pShader Shader.
+	*	@param uiFeatures ShaderFeature flags. Flags that the shader doesn't support are ignored.
+	*	@return The permutation. If it failed to compile, the base permutation.
+	*/
+	CShaderInstance* GetPermutation( CBaseShader* pShader, uint32_t uiFeatures );
+
+	/**
+	*	@return The number of permutations that have been created.
+	*/
+	size_t GetNumPermutations() const { return m_Instances.size(); }
 
 	CShaderInstance* GetActiveShader() const { return m_pActiveShader; }
 
-	//TODO: the matrices should come from somewhere else.
+	/**
+	*	Updates the FrameData uniform block shared by all shaders. Call once per frame.
+	*	@param projection Projection matrix.
+	*	@param view View matrix.
+	*	@param flTime Time since the app started, in seconds.
+	*/
+	void SetFrameData( const glm::mat4x4& projection, const glm::mat4x4& view, const float flTime );
+
+	/**
+	*	Activates a shader for an entity. The ObjectData uniform block is only updated if the model matrix changed.
+	*/
 	//TODO: shouldn't be directly referencing entities.
-	void ActivateShader( CShaderInstance* pShader, const glm::mat4x4& projection, const glm::mat4x4& view, const glm::mat4x4& model, const CBaseEntity* pEntity );
+	void ActivateShader( CShaderInstance* pShader, const glm::mat4x4& model, const CBaseEntity* pEntity );
 
 	void DeactivateActiveShader();
 
 private:
 	bool AddShader( CBaseShader* pShader );
 
+	/**
+	*	Creates a uniform buffer and binds it to a uniform block binding point.
+	*/
+	static GLuint CreateUniformBuffer( const GLuint uiBinding, const size_t uiSize );
+
+	static void UpdateUniformBuffer( const GLuint buffer, const void* pData, const size_t uiSize );
+
 private:
 	Shaders_t m_Shaders;
 
+	Permutations_t m_Permutations;
+
+	/**
+	*	All permutations, indexed by CShaderInstance::GetIndex.
+	*/
+	std::vector<CShaderInstance*> m_Instances;
+
 	CShaderInstance* m_pActiveShader = nullptr;
 
+	GLuint m_FrameBuffer = 0;
+	GLuint m_ObjectBuffer = 0;
+
+	/**
+	*	Model matrix in the ObjectData block.
+	*/
+	glm::mat4x4 m_ObjectModelMatrix;
+	bool m_bObjectDataValid = false;
+
 private:
 	CShaderManager( const CShaderManager& ) = delete;
 	CShaderManager& operator=( const CShaderManager& ) = delete;
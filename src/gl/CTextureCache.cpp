@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <memory>
+
+#include "utility/CLogger.h"
+#include "utility/CProfiler.h"
+
+#include "wad/WadFile.h"
+
+#include "GLMiptex.h"
+#include "GLUtil.h"
+
+#include "CTextureCache.h"
+
+CTextureCache g_TextureCache;
+
+const size_t CTextureCache::INITIAL_PAGE_LAYERS;
+
+static const uint64_t FNV1A_OFFSET_BASIS	= 14695981039346656037ULL;
+static const uint64_t FNV1A_PRIME			= 1099511628211ULL;
+
+static uint64_t HashBytes( uint64_t uiHash, const byte* pData, const size_t uiSize )
+{
+	for( size_t uiIndex = 0; uiIndex < uiSize; ++uiIndex )
+	{
+		uiHash ^= pData[ uiIndex ];
+		uiHash *= FNV1A_PRIME;
+	}
+
+	return uiHash;
+}
+
+/**
+*	Hashes everything that affects the uploaded texture: the name (determines the format), the dimensions, the pixels and the palette.
+*	Mipmap offsets are left out since the same texture can be stored at different offsets in different files.
+*/
+static uint64_t HashMiptex( const miptex_t& miptex )
+{
+	const byte* pBase = reinterpret_cast<const byte*>( &miptex );
+
+	uint64_t uiHash = FNV1A_OFFSET_BASIS;
+
+	uiHash = HashBytes( uiHash, reinterpret_cast<const byte*>( miptex.name ), sizeof( miptex.name ) );
+	uiHash = HashBytes( uiHash, reinterpret_cast<const byte*>( &miptex.width ), sizeof( miptex.width ) );
+	uiHash = HashBytes( uiHash, reinterpret_cast<const byte*>( &miptex.height ), sizeof( miptex.height ) );
+
+	//Pixels for all mip levels, followed by the palette size and the palette itself.
+	uiHash = HashBytes( uiHash, pBase + miptex.offsets[ 0 ], GetMiptexPixelSize( miptex ) + sizeof( short ) + 256 * 3 );
+
+	return uiHash;
+}
+
+size_t CTextureCache::GetNumPages() const
+{
+	size_t uiCount = 0;
+
+	for( const auto& page : m_Pages )
+	{
+		if( page.texture )
+			++uiCount;
+	}
+
+	return uiCount;
+}
+
+bool CTextureCache::Acquire( const miptex_t* pMiptex, GLuint& texture, GLint& layer )
+{
+	assert( pMiptex );
+
+	if( !pMiptex )
+		return false;
+
+	const uint64_t uiKey = HashMiptex( *pMiptex );
+
+	auto it = m_Entries.find( uiKey );
+
+	if( it != m_Entries.end() )
+	{
+		++it->second.uiRefCount;
+		it->second.uiLastUsed = ++m_uiUseCounter;
+
+		texture = it->second.texture;
+		layer = it->second.layer;
+
+		return true;
+	}
+
+	int iWidth, iHeight;
+
+	std::unique_ptr<byte[]> image = ConvertMiptex( pMiptex, iWidth, iHeight );
+
+	if( !image )
+		return false;
+
+	CacheEntry_t entry;
+
+	if( !AllocLayer( iWidth, iHeight, entry.uiPage, entry.layer ) )
+		return false;
+
+	auto& page = m_Pages[ entry.uiPage ];
+
+	PROFILE_SCOPE( "Upload texture" );
+
+	glBindTexture( GL_TEXTURE_2D_ARRAY, page.texture );
+
+	glTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, 0, 0, entry.layer, iWidth, iHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, image.get() );
+
+	check_gl_error();
+
+	page.bMipmapsDirty = true;
+
+	entry.texture = page.texture;
+	entry.uiRefCount = 1;
+	entry.uiLastUsed = ++m_uiUseCounter;
+
+	m_Entries.insert( std::make_pair( uiKey, entry ) );
+	m_TextureKeys.insert( std::make_pair( GetTextureKey( entry.texture, entry.layer ), uiKey ) );
+
+	texture = entry.texture;
+	layer = entry.layer;
+
+	return true;
+}
+
+void CTextureCache::Release( const GLuint texture, const GLint layer )
+{
+	if( texture == 0 )
+		return;
+
+	auto it = m_TextureKeys.find( GetTextureKey( texture, layer ) );
+
+	if( it == m_TextureKeys.end() )
+	{
+		g_Logger.Error( LogCategory::GL, "CTextureCache::Release: Texture %u layer %d is not cached\n", texture, layer );
+		return;
+	}
+
+	auto& entry = m_Entries[ it->second ];
+
+	assert( entry.uiRefCount > 0 );
+
+	if( entry.uiRefCount > 0 )
+		--entry.uiRefCount;
+}
+
+void CTextureCache::GenerateMipmaps()
+{
+	PROFILE_FUNCTION();
+
+	for( auto& page : m_Pages )
+	{
+		if( !page.bMipmapsDirty )
+			continue;
+
+		glBindTexture( GL_TEXTURE_2D_ARRAY, page.texture );
+
+		//Regenerates every layer, which is why this is done once per batch instead of once per upload.
+		glGenerateMipmap( GL_TEXTURE_2D_ARRAY );
+
+		check_gl_error();
+
+		page.bMipmapsDirty = false;
+	}
+}
+
+void CTextureCache::Trim()
+{
+	//Memory is only given back when a page is deleted, so evict whole pages instead of single textures.
+	std::vector<size_t> lastUsed;
+	std::vector<bool> referenced;
+
+	while( m_uiMemoryUsage > m_uiMemoryBudget )
+	{
+		lastUsed.assign( m_Pages.size(), 0 );
+		referenced.assign( m_Pages.size(), false );
+
+		for( const auto& entry : m_Entries )
+		{
+			const size_t uiPage = entry.second.uiPage;
+
+			if( entry.second.uiLastUsed > lastUsed[ uiPage ] )
+				lastUsed[ uiPage ] = entry.second.uiLastUsed;
+
+			if( entry.second.uiRefCount )
+				referenced[ uiPage ] = true;
+		}
+
+		size_t uiOldest = m_Pages.size();
+
+		for( size_t uiIndex = 0; uiIndex < m_Pages.size(); ++uiIndex )
+		{
+			if( !m_Pages[ uiIndex ].texture || referenced[ uiIndex ] )
+				continue;
+
+			if( uiOldest == m_Pages.size() || lastUsed[ uiIndex ] < lastUsed[ uiOldest ] )
+				uiOldest = uiIndex;
+		}
+
+		//Every page that's left has textures in use.
+		if( uiOldest == m_Pages.size() )
+			break;
+
+		//Freeing the last layer deletes the page.
+		for( auto it = m_Entries.begin(); it != m_Entries.end(); )
+		{
+			if( it->second.uiPage == uiOldest )
+			{
+				FreeLayer( it->second.uiPage, it->second.layer );
+
+				m_TextureKeys.erase( GetTextureKey( it->second.texture, it->second.layer ) );
+				it = m_Entries.erase( it );
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+}
+
+void CTextureCache::Clear()
+{
+	for( auto& page : m_Pages )
+	{
+		if( page.texture )
+			glDeleteTextures( 1, &page.texture );
+	}
+
+	m_Pages.clear();
+
+	m_Entries.clear();
+	m_TextureKeys.clear();
+
+	m_uiMemoryUsage = 0;
+}
+
+bool CTextureCache::AllocLayer( const int iWidth, const int iHeight, size_t& uiPage, GLint& layer )
+{
+	const size_t uiMaxLayers = GetMaxPageLayers( iWidth, iHeight );
+
+	size_t uiFreePage = m_Pages.size();
+	size_t uiGrowPage = m_Pages.size();
+
+	for( size_t uiIndex = 0; uiIndex < m_Pages.size(); ++uiIndex )
+	{
+		auto& page = m_Pages[ uiIndex ];
+
+		if( !page.texture )
+		{
+			uiFreePage = uiIndex;
+			continue;
+		}
+
+		if( page.iWidth != iWidth || page.iHeight != iHeight )
+			continue;
+
+		if( !page.freeLayers.empty() )
+		{
+			uiPage = uiIndex;
+			layer = page.freeLayers.back();
+
+			page.freeLayers.pop_back();
+
+			return true;
+		}
+
+		if( page.uiNumLayers < uiMaxLayers )
+			uiGrowPage = uiIndex;
+	}
+
+	if( uiGrowPage != m_Pages.size() )
+	{
+		auto& page = m_Pages[ uiGrowPage ];
+
+		const size_t uiNumLayers = std::min( page.uiNumLayers * 2, uiMaxLayers );
+
+		if( GrowPage( page, uiNumLayers ) )
+		{
+			uiPage = uiGrowPage;
+			layer = page.freeLayers.back();
+
+			page.freeLayers.pop_back();
+
+			return true;
+		}
+
+		//Try a new page instead; it's smaller.
+	}
+
+	const size_t uiNumLayers = std::min( INITIAL_PAGE_LAYERS, uiMaxLayers );
+
+	GLuint texture;
+
+	glGenTextures( 1, &texture );
+
+	if( !AllocPageStorage( texture, iWidth, iHeight, uiNumLayers ) )
+	{
+		g_Logger.Error( LogCategory::GL, "CTextureCache::AllocLayer: Couldn't allocate a %dx%dx%u texture array\n", iWidth, iHeight, uiNumLayers );
+
+		glDeleteTextures( 1, &texture );
+
+		return false;
+	}
+
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT );
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT );
+
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+
+	check_gl_error();
+
+	if( uiFreePage == m_Pages.size() )
+		m_Pages.emplace_back();
+
+	auto& page = m_Pages[ uiFreePage ];
+
+	page.texture = texture;
+	page.iWidth = iWidth;
+	page.iHeight = iHeight;
+	page.uiNumLayers = uiNumLayers;
+	page.bMipmapsDirty = false;
+
+	//Hand out layers in ascending order.
+	page.freeLayers.clear();
+
+	for( size_t uiLayer = uiNumLayers; uiLayer-- > 1; )
+	{
+		page.freeLayers.push_back( static_cast<GLint>( uiLayer ) );
+	}
+
+	m_uiMemoryUsage += GetPageMemorySize( iWidth, iHeight, uiNumLayers );
+
+	uiPage = uiFreePage;
+	layer = 0;
+
+	return true;
+}
+
+bool CTextureCache::GrowPage( Page_t& page, const size_t uiNumLayers )
+{
+	PROFILE_FUNCTION();
+
+	assert( uiNumLayers > page.uiNumLayers );
+
+	const GLsizei iOldLayers = static_cast<GLsizei>( page.uiNumLayers );
+
+	bool bSuccess;
+
+	//Textures refer to the page by its name, so the storage is respecified in place and the existing layers are copied back into it.
+	//If respecifying fails the GL ran out of memory, after which its state is undefined; the page isn't restored.
+	if( GLEW_VERSION_4_3 || GLEW_ARB_copy_image )
+	{
+		GLuint copy;
+
+		glGenTextures( 1, &copy );
+
+		bSuccess = AllocPageStorage( copy, page.iWidth, page.iHeight, page.uiNumLayers );
+
+		if( bSuccess )
+		{
+			//Copies require complete textures; the copy has no mipmaps.
+			glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+
+			glCopyImageSubData(
+				page.texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+				copy, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+				page.iWidth, page.iHeight, iOldLayers );
+
+			bSuccess = AllocPageStorage( page.texture, page.iWidth, page.iHeight, uiNumLayers );
+
+			if( bSuccess )
+			{
+				glCopyImageSubData(
+					copy, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+					page.texture, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+					page.iWidth, page.iHeight, iOldLayers );
+			}
+		}
+
+		glDeleteTextures( 1, &copy );
+	}
+	else
+	{
+		//Without copy_image the layers make a round trip through system memory. This only happens while loading.
+		std::unique_ptr<byte[]> pixels( new byte[ static_cast<size_t>( page.iWidth ) * page.iHeight * 4 * page.uiNumLayers ] );
+
+		glBindTexture( GL_TEXTURE_2D_ARRAY, page.texture );
+
+		glGetTexImage( GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.get() );
+
+		bSuccess = AllocPageStorage( page.texture, page.iWidth, page.iHeight, uiNumLayers );
+
+		if( bSuccess )
+			glTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, page.iWidth, page.iHeight, iOldLayers, GL_RGBA, GL_UNSIGNED_BYTE, pixels.get() );
+	}
+
+	check_gl_error();
+
+	if( !bSuccess )
+	{
+		g_Logger.Error( LogCategory::GL, "CTextureCache::GrowPage: Couldn't grow a %dx%d texture array to %u layers\n", page.iWidth, page.iHeight, uiNumLayers );
+		return false;
+	}
+
+	//Hand out the new layers in ascending order.
+	for( size_t uiLayer = uiNumLayers; uiLayer-- > page.uiNumLayers; )
+	{
+		page.freeLayers.push_back( static_cast<GLint>( uiLayer ) );
+	}
+
+	m_uiMemoryUsage += GetPageMemorySize( page.iWidth, page.iHeight, uiNumLayers ) - GetPageMemorySize( page.iWidth, page.iHeight, page.uiNumLayers );
+
+	page.uiNumLayers = uiNumLayers;
+
+	//Only the base level was kept.
+	page.bMipmapsDirty = true;
+
+	return true;
+}
+
+size_t CTextureCache::GetMaxPageLayers( const int iWidth, const int iHeight )
+{
+	if( !m_iMaxLayers )
+	{
+		glGetIntegerv( GL_MAX_ARRAY_TEXTURE_LAYERS, &m_iMaxLayers );
+
+		if( m_iMaxLayers < 1 )
+			m_iMaxLayers = 1;
+	}
+
+	size_t uiNumLayers = PAGE_MEMORY_SIZE / ( static_cast<size_t>( iWidth ) * iHeight * 4 );
+
+	if( uiNumLayers < 1 )
+		uiNumLayers = 1;
+
+	if( uiNumLayers > static_cast<size_t>( m_iMaxLayers ) )
+		uiNumLayers = static_cast<size_t>( m_iMaxLayers );
+
+	return uiNumLayers;
+}
+
+bool CTextureCache::AllocPageStorage( const GLuint texture, const int iWidth, const int iHeight, const size_t uiNumLayers )
+{
+	glBindTexture( GL_TEXTURE_2D_ARRAY, texture );
+
+	//Errors from earlier calls would otherwise be mistaken for an allocation failure.
+	clear_gl_errors();
+
+	glTexImage3D( GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, iWidth, iHeight, static_cast<GLsizei>( uiNumLayers ), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+
+	return glGetError() == GL_NO_ERROR;
+}
+
+void CTextureCache::FreeLayer( const size_t uiPage, const GLint layer )
+{
+	assert( uiPage < m_Pages.size() );
+
+	auto& page = m_Pages[ uiPage ];
+
+	page.freeLayers.push_back( layer );
+
+	if( page.freeLayers.size() == page.uiNumLayers )
+	{
+		m_uiMemoryUsage -= GetPageMemorySize( page.iWidth, page.iHeight, page.uiNumLayers );
+
+		glDeleteTextures( 1, &page.texture );
+
+		page.texture = 0;
+		page.freeLayers.clear();
+	}
+}
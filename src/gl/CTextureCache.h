@@ -0,0 +1,221 @@
+#ifndef GL_CTEXTURECACHE_H
+#define GL_CTEXTURECACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <gl/glew.h>
+
+struct miptex_t;
+
+/**
+*	Caches uploaded textures so they can be shared between maps.
+*	Textures are identified by a hash of the miptex name, dimensions, pixels and palette, so a texture that comes from a different wad
+*	or that is embedded in a different BSP is only uploaded again if its contents differ.
+*	Unreferenced textures stay uploaded until Trim evicts them.
+*	Textures are stored as layers of GL_TEXTURE_2D_ARRAY pages. Every page holds textures of a single size,
+*	so surfaces with different textures of the same size can be drawn without binding another texture.
+*	Pages start out small and double in size when they are full, keeping their texture name, up to PAGE_MEMORY_SIZE.
+*	Memory usage counts the storage of the pages, so Trim evicts whole pages.
+*/
+class CTextureCache final
+{
+public:
+	/**
+	*	Default amount of texture memory that pages may use before pages without referenced textures are evicted.
+	*/
+	static const size_t DEFAULT_MEMORY_BUDGET = 128 * 1024 * 1024;
+
+	/**
+	*	Amount of texture memory that a page can grow to, not counting mipmaps. Pages of small textures are capped by GL_MAX_ARRAY_TEXTURE_LAYERS.
+	*/
+	static const size_t PAGE_MEMORY_SIZE = 16 * 1024 * 1024;
+
+	/**
+	*	Number of layers that a new page has.
+	*/
+	static const size_t INITIAL_PAGE_LAYERS = 4;
+
+private:
+	struct Page_t
+	{
+		/**
+		*	Texture array. 0 if this page is unused.
+		*/
+		GLuint texture;
+
+		int iWidth;
+		int iHeight;
+
+		size_t uiNumLayers;
+
+		/**
+		*	Layers that don't contain a texture.
+		*/
+		std::vector<GLint> freeLayers;
+
+		/**
+		*	Whether layers were uploaded since the mipmaps were last generated.
+		*/
+		bool bMipmapsDirty;
+	};
+
+	struct CacheEntry_t
+	{
+		size_t uiPage;
+
+		GLuint texture;
+		GLint layer;
+
+		size_t uiRefCount;
+
+		/**
+		*	Value of the use counter when this texture was last acquired.
+		*/
+		size_t uiLastUsed;
+	};
+
+	typedef std::unordered_map<uint64_t, CacheEntry_t> Entries_t;
+
+	/**
+	*	Maps texture << 32 | layer to entry keys.
+	*/
+	typedef std::unordered_map<uint64_t, uint64_t> TextureKeys_t;
+
+	typedef std::vector<Page_t> Pages_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CTextureCache() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CTextureCache() = default;
+
+	/**
+	*	@return The number of textures in the cache.
+	*/
+	size_t GetNumTextures() const { return m_Entries.size(); }
+
+	/**
+	*	@return The amount of texture memory that pages may use.
+	*/
+	size_t GetMemoryBudget() const { return m_uiMemoryBudget; }
+
+	/**
+	*	Sets the amount of texture memory that pages may use.
+	*/
+	void SetMemoryBudget( const size_t uiMemoryBudget ) { m_uiMemoryBudget = uiMemoryBudget; }
+
+	/**
+	*	@return The estimated amount of texture memory used by all pages, including mipmaps.
+	*/
+	size_t GetMemoryUsage() const { return m_uiMemoryUsage; }
+
+	/**
+	*	@return The number of texture array pages.
+	*/
+	size_t GetNumPages() const;
+
+	/**
+	*	Gets the texture for the given miptex, uploading it if it isn't cached yet. Adds a reference to the texture.
+	*	Call GenerateMipmaps after acquiring a batch of textures.
+	*	@param pMiptex Texture data.
+	*	@param[ out ] texture Texture array that contains the texture.
+	*	@param[ out ] layer Layer of the texture in the array.
+	*	@return Whether the texture was uploaded.
+	*/
+	bool Acquire( const miptex_t* pMiptex, GLuint& texture, GLint& layer );
+
+	/**
+	*	Removes a reference from a texture that was acquired earlier. The texture stays cached.
+	*	@param texture Texture array of the texture to release.
+	*	@param layer Layer of the texture to release.
+	*/
+	void Release( const GLuint texture, const GLint layer );
+
+	/**
+	*	Generates mipmaps for pages that had textures uploaded to them.
+	*/
+	void GenerateMipmaps();
+
+	/**
+	*	Deletes pages that contain no referenced textures, least recently used first, until the memory usage fits in the budget.
+	*/
+	void Trim();
+
+	/**
+	*	Deletes all textures. Must be called while the OpenGL context is still current.
+	*/
+	void Clear();
+
+private:
+	/**
+	*	Allocates a layer for a texture of the given size. Grows a page of that size if they are all full,
+	*	or creates a new page if they can't grow any further.
+	*	@return Whether a layer was allocated.
+	*/
+	bool AllocLayer( const int iWidth, const int iHeight, size_t& uiPage, GLint& layer );
+
+	/**
+	*	Resizes a page to the given number of layers, keeping its texture name and the contents of its existing layers.
+	*	The mipmaps have to be generated again afterwards.
+	*	@return Whether the page was resized.
+	*/
+	bool GrowPage( Page_t& page, const size_t uiNumLayers );
+
+	/**
+	*	@return The number of layers that a page of textures of the given size can grow to.
+	*/
+	size_t GetMaxPageLayers( const int iWidth, const int iHeight );
+
+	/**
+	*	(Re)specifies the storage of a texture array. Leaves the texture bound.
+	*	@return Whether the storage was allocated.
+	*/
+	static bool AllocPageStorage( const GLuint texture, const int iWidth, const int iHeight, const size_t uiNumLayers );
+
+	/**
+	*	@return Estimated amount of texture memory used by a page, including mipmaps.
+	*/
+	static size_t GetPageMemorySize( const int iWidth, const int iHeight, const size_t uiNumLayers )
+	{
+		//RGBA, plus a third for the mipmaps.
+		return ( static_cast<size_t>( iWidth ) * iHeight * 4 * uiNumLayers * 4 ) / 3;
+	}
+
+	/**
+	*	Frees a layer. Deletes the page if it is empty.
+	*/
+	void FreeLayer( const size_t uiPage, const GLint layer );
+
+	static uint64_t GetTextureKey( const GLuint texture, const GLint layer )
+	{
+		return ( static_cast<uint64_t>( texture ) << 32 ) | static_cast<uint32_t>( layer );
+	}
+
+private:
+	Entries_t m_Entries;
+	TextureKeys_t m_TextureKeys;
+
+	Pages_t m_Pages;
+
+	GLint m_iMaxLayers = 0;
+
+	size_t m_uiMemoryBudget = DEFAULT_MEMORY_BUDGET;
+	size_t m_uiMemoryUsage = 0;
+
+	size_t m_uiUseCounter = 0;
+
+private:
+	CTextureCache( const CTextureCache& ) = delete;
+	CTextureCache& operator=( const CTextureCache& ) = delete;
+};
+
+extern CTextureCache g_TextureCache;
+
+#endif //GL_CTEXTURECACHE_H
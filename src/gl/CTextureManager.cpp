@@ -2,11 +2,13 @@
 #include <cstdio>
 #include <cstring>
 
-#include "wad/CWadManager.h"
+#include "utility/CLogger.h"
 
-#include "GLMiptex.h"
+#include "wad/CWadManager.h"
 
 #include "CShaderManager.h"
+#include "CTextureCache.h"
+#include "ShaderFeatures.h"
 
 #include "CTextureManager.h"
 
@@ -17,7 +19,7 @@ bool CTextureManager::Initialize( const size_t uiNumTextures )
 	//Forgot to call Shutdown.
 	if( m_bInitialized )
 	{
-		printf( "CTextureManager::Initialize: Manager was not shut down!\n" );
+		g_Logger.Error( LogCategory::GL, "CTextureManager::Initialize: Manager was not shut down!\n" );
 		Shutdown();
 	}
 
@@ -44,10 +46,10 @@ void CTextureManager::Shutdown()
 	//Force clear the memory used by the map.
 	m_TexMap.swap( TexMap_t() );
 
-	//Free all textures.
+	//Release all textures. They stay cached so the next map can reuse them.
 	for( auto& tex : m_Textures )
 	{
-		glDeleteTextures( 1, &tex.gl_texturenum );
+		g_TextureCache.Release( tex.gl_texturenum, tex.gl_texturelayer );
 	}
 
 	m_Textures.clear();
@@ -91,13 +93,13 @@ texture_t* CTextureManager::LoadTexture( const char* const pszName, const miptex
 	//Should never happen since all textures come from lumps.
 	if( uiLength >= WAD_MAX_LUMP_NAME_SIZE )
 	{
-		printf( "CTextureManager::LoadTexture: Texture name too long (max %u, got %u)\n", WAD_MAX_LUMP_NAME_SIZE, uiLength );
+		g_Logger.Error( LogCategory::GL, "CTextureManager::LoadTexture: Texture name too long (max %u, got %u)\n", WAD_MAX_LUMP_NAME_SIZE, uiLength );
 		return nullptr;
 	}
 
 	if( m_uiTexturesInUse >= m_Textures.size() )
 	{
-		printf( "CTextureManager::LoadTexture: Out of texture IDs (max: %u)\n", m_Textures.size() );
+		g_Logger.Error( LogCategory::GL, "CTextureManager::LoadTexture: Out of texture IDs (max: %u)\n", m_Textures.size() );
 		return nullptr;
 	}
 
@@ -106,13 +108,14 @@ texture_t* CTextureManager::LoadTexture( const char* const pszName, const miptex
 
 	if( !pMiptex )
 	{
-		printf( "CTextureManager::LoadTexture: Couldn't find texture \"%s\"\n", pszName );
+		g_Logger.Error( LogCategory::GL, "CTextureManager::LoadTexture: Couldn't find texture \"%s\"\n", pszName );
 		return nullptr;
 	}
 
-	GLuint tex = UploadMiptex( pMiptex );
+	GLuint tex;
+	GLint layer;
 
-	if( tex == 0 )
+	if( !g_TextureCache.Acquire( pMiptex, tex, layer ) )
 		return nullptr;
 
 	const size_t uiIndex = m_uiTexturesInUse;
@@ -126,29 +129,27 @@ texture_t* CTextureManager::LoadTexture( const char* const pszName, const miptex
 	pTexture->height = pMiptex->height;
 
 	pTexture->gl_texturenum = tex;
+	pTexture->gl_texturelayer = layer;
 
-	const char* pszShaderName = "LightMappedGeneric";
+	uint32_t uiFeatures = 0;
 
 	if( pszName[ 0 ] == '{' )
-		pszShaderName = "LightMappedAlphaTest";
+		uiFeatures = SHADER_FEATURE_ALPHA_TEST;
 	else if( pszName[ 0 ] == '!' )
-		pszShaderName = "LightMappedWater";
+		uiFeatures = SHADER_FEATURE_WARP;
 
-	pTexture->pShader = g_ShaderManager.GetShader( pszShaderName );
+	pTexture->pShader = g_ShaderManager.GetShader( "LightMapped", uiFeatures );
 
 	if( !pTexture->pShader )
-	{
-		printf( "Shader \"%s\" not found, falling back to generic\n", pszName );
-		pTexture->pShader = g_ShaderManager.GetShader( "LightMappedGeneric" );
-	}
+		g_Logger.Error( LogCategory::GL, "Shader \"LightMapped\" not found for texture \"%s\"\n", pszName );
 
 	auto result = m_TexMap.insert( std::make_pair( pTexture->name, uiIndex ) );
 
 	if( !result.second )
 	{
 		//Insertion failed; remove texture.
-		printf( "CTextureManager::LoadTexture: Failed to insert texture \"%s\" into map\n", pszName );
-		glDeleteTextures( 1, &pTexture->gl_texturenum );
+		g_Logger.Error( LogCategory::GL, "CTextureManager::LoadTexture: Failed to insert texture \"%s\" into map\n", pszName );
+		g_TextureCache.Release( pTexture->gl_texturenum, pTexture->gl_texturelayer );
 
 		memset( pTexture, 0, sizeof( texture_t ) );
 		return nullptr;
@@ -207,7 +208,7 @@ bool CTextureManager::SetupAnimatingTextures()
 		}
 		else
 		{
-			printf( "Bad animating texture %s\n", texture.name );
+			g_Logger.Error( LogCategory::GL, "Bad animating texture %s\n", texture.name );
 			return false;
 		}
 
@@ -240,7 +241,7 @@ bool CTextureManager::SetupAnimatingTextures()
 			}
 			else
 			{
-				printf( "Bad animating texture %s\n", texture.name );
+				g_Logger.Error( LogCategory::GL, "Bad animating texture %s\n", texture.name );
 				return false;
 			}
 		}
@@ -251,7 +252,7 @@ bool CTextureManager::SetupAnimatingTextures()
 			auto texture2 = anims[ j ];
 			if( !texture2 )
 			{
-				printf( "Missing frame %i of %s\n", j, texture.name );
+				g_Logger.Warning( LogCategory::GL, "Missing frame %i of %s\n", j, texture.name );
 				return false;
 			}
 
@@ -268,7 +269,7 @@ bool CTextureManager::SetupAnimatingTextures()
 			auto texture2 = altanims[ j ];
 			if( !texture2 )
 			{
-				printf( "Missing frame %i of %s\n", j, texture.name );
+				g_Logger.Warning( LogCategory::GL, "Missing frame %i of %s\n", j, texture.name );
 				return false;
 			}
 
@@ -0,0 +1,91 @@
+#include <cassert>
+
+#include "GLUtil.h"
+
+#include "CGLStateCache.h"
+#include "CShaderInstance.h"
+
+#include "CVertexArrayCache.h"
+
+CVertexArrayCache g_VertexArrayCache;
+
+GLuint CVertexArrayCache::GetVertexArray( CShaderInstance* pShader, const GLuint buffer )
+{
+	assert( pShader );
+
+	const uint64_t uiKey = ( static_cast<uint64_t>( GetLayoutIndex( pShader ) ) << 32 ) | buffer;
+
+	auto it = m_VertexArrays.find( uiKey );
+
+	if( it != m_VertexArrays.end() )
+		return it->second;
+
+	GLuint vertexArray;
+
+	glGenVertexArrays( 1, &vertexArray );
+
+	check_gl_error();
+
+	//Buffers are created with direct GL calls, so the state cache can't be relied on here.
+	glBindVertexArray( vertexArray );
+
+	glBindBuffer( GL_ARRAY_BUFFER, buffer );
+
+	check_gl_error();
+
+	//Attribute arrays and pointers are stored in the vertex array object.
+	pShader->EnableVAA();
+
+	pShader->SetupVertexAttribs();
+
+	glBindVertexArray( 0 );
+
+	check_gl_error();
+
+	g_GLState.Invalidate();
+
+	m_VertexArrays.insert( std::make_pair( uiKey, vertexArray ) );
+
+	return vertexArray;
+}
+
+void CVertexArrayCache::Clear()
+{
+	glBindVertexArray( 0 );
+
+	for( const auto& vertexArray : m_VertexArrays )
+	{
+		glDeleteVertexArrays( 1, &vertexArray.second );
+	}
+
+	check_gl_error();
+
+	m_VertexArrays.clear();
+	m_Layouts.clear();
+
+	g_GLState.Invalidate();
+}
+
+size_t CVertexArrayCache::GetLayoutIndex( const CShaderInstance* pShader )
+{
+	const CBaseShader* pBaseShader = pShader->GetShader();
+
+	Layout_t layout;
+
+	layout.reserve( pBaseShader->GetNumAttributes() );
+
+	for( size_t uiIndex = 0; uiIndex < pBaseShader->GetNumAttributes(); ++uiIndex )
+	{
+		layout.push_back( pBaseShader->GetAttribute( uiIndex )->GetType() );
+	}
+
+	for( size_t uiIndex = 0; uiIndex < m_Layouts.size(); ++uiIndex )
+	{
+		if( m_Layouts[ uiIndex ] == layout )
+			return uiIndex;
+	}
+
+	m_Layouts.emplace_back( std::move( layout ) );
+
+	return m_Layouts.size() - 1;
+}
@@ -0,0 +1,76 @@
+#ifndef GL_CVERTEXARRAYCACHE_H
+#define GL_CVERTEXARRAYCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <gl/glew.h>
+
+#include "CBaseShader.h"
+
+class CShaderInstance;
+
+/**
+*	Creates and caches vertex array objects for pairs of vertex layout and vertex buffer.
+*	Shaders bind their attributes to fixed locations before linking, so all shaders with the same attribute types
+*	in the same order share vertex array objects.
+*/
+class CVertexArrayCache final
+{
+private:
+	typedef std::vector<AttributeType> Layout_t;
+	typedef std::vector<Layout_t> Layouts_t;
+
+	/**
+	*	Vertex arrays by layout index and buffer.
+	*/
+	typedef std::unordered_map<uint64_t, GLuint> VertexArrays_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CVertexArrayCache() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CVertexArrayCache() = default;
+
+	/**
+	*	@return The number of vertex array objects.
+	*/
+	size_t GetNumVertexArrays() const { return m_VertexArrays.size(); }
+
+	/**
+	*	Gets the vertex array object that feeds a vertex buffer to a shader. Creates it if it doesn't exist yet.
+	*	Creating a vertex array object changes the bound vertex array and array buffer, and invalidates g_GLState.
+	*	@param pShader Shader whose attribute layout to use.
+	*	@param buffer Vertex buffer.
+	*	@return The vertex array object.
+	*/
+	GLuint GetVertexArray( CShaderInstance* pShader, const GLuint buffer );
+
+	/**
+	*	Deletes all vertex array objects.
+	*/
+	void Clear();
+
+private:
+	size_t GetLayoutIndex( const CShaderInstance* pShader );
+
+private:
+	Layouts_t m_Layouts;
+
+	VertexArrays_t m_VertexArrays;
+
+private:
+	CVertexArrayCache( const CVertexArrayCache& ) = delete;
+	CVertexArrayCache& operator=( const CVertexArrayCache& ) = delete;
+};
+
+extern CVertexArrayCache g_VertexArrayCache;
+
+#endif //GL_CVERTEXARRAYCACHE_H
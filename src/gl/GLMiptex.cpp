@@ -1,6 +1,9 @@
 #include <cassert>
 #include <memory>
 
+#include "utility/CLogger.h"
+#include "utility/CProfiler.h"
+
 #include "GLUtil.h"
 
 #include "GLMiptex.h"
@@ -136,19 +139,11 @@ bool CalculateImageDimensions( const int iWidth, const int iHeight, int& iOutWid
 	return true;
 }
 
-GLuint UploadMiptex( const miptex_t* pMiptex )
+std::unique_ptr<byte[]> ConvertMiptex( const miptex_t* pMiptex, int& outwidth, int& outheight )
 {
-	assert( pMiptex );
-
-	GLuint tex;
-
-	glGenTextures( 1, &tex );
-
-	check_gl_error();
+	PROFILE_FUNCTION();
 
-	glBindTexture( GL_TEXTURE_2D, tex );
-
-	check_gl_error();
+	assert( pMiptex );
 
 	byte rgba[ PALETTE_ENTRIES * 4 ];
 
@@ -158,7 +153,7 @@ GLuint UploadMiptex( const miptex_t* pMiptex )
 
 	if( *( reinterpret_cast<const short*>( pPal ) ) != 256 )
 	{
-		printf( "Invalid miptex\n" );
+		g_Logger.Error( LogCategory::GL, "Invalid miptex\n" );
 	}
 
 	pPal += sizeof( short );
@@ -172,23 +167,20 @@ GLuint UploadMiptex( const miptex_t* pMiptex )
 	Convert8To32Bit( pPal, rgba, format );
 
 	// convert texture to power of 2. Otherwise it ends up having weird lines.
-	int outwidth;
-	int outheight;
-
 	if( !CalculateImageDimensions( pMiptex->width, pMiptex->height, outwidth, outheight ) )
-		return 0;
+		return nullptr;
 
 	const size_t uiSize = outwidth * outheight * 4;
 
 	//Needs at least one pixel (satisfies code analysis)
 	if( uiSize < 4 )
-		return 0;
+		return nullptr;
 
 	std::unique_ptr<byte[]> image = std::make_unique<byte[]>( uiSize );
 
 	if( !image )
 	{
-		return 0;
+		return nullptr;
 	}
 
 	int row1[ MAX_TEXTURE_DIMS ], row2[ MAX_TEXTURE_DIMS ], col1[ MAX_TEXTURE_DIMS ], col2[ MAX_TEXTURE_DIMS ];
@@ -228,27 +220,5 @@ GLuint UploadMiptex( const miptex_t* pMiptex )
 		}
 	}
 
-	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, outwidth, outheight, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.get() );
-
-	check_gl_error();
-
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
-
-	check_gl_error();
-
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
-
-	check_gl_error();
-
-	glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
-
-	check_gl_error();
-
-	glGenerateMipmap( GL_TEXTURE_2D );
-
-	check_gl_error();
-
-	return tex;
+	return image;
 }
\ No newline at end of file
@@ -1,11 +1,26 @@
 #ifndef GL_GLMIPTEX_H
 #define GL_GLMIPTEX_H
 
+#include <memory>
+
 #include <gl/glew.h>
 
 #include "common/Const.h"
 #include "wad/WadFile.h"
 
-GLuint UploadMiptex( const miptex_t* pMiptex );
+/**
+*	Calculates the power of 2 dimensions that a texture of the given size is uploaded with.
+*	@return Whether the input dimensions are valid.
+*/
+bool CalculateImageDimensions( const int iWidth, const int iHeight, int& iOutWidth, int& iOutHeight );
+
+/**
+*	Converts a miptex to a 32 bit RGBA image, scaled to the dimensions returned by CalculateImageDimensions.
+*	@param pMiptex Texture to convert.
+*	@param[ out ] iOutWidth Width of the image.
+*	@param[ out ] iOutHeight Height of the image.
+*	@return Image, or null if the miptex is invalid.
+*/
+std::unique_ptr<byte[]> ConvertMiptex( const miptex_t* pMiptex, int& iOutWidth, int& iOutHeight );
 
 #endif //GL_GLMIPTEX_H
\ No newline at end of file
@@ -2,10 +2,24 @@
 
 #include <iostream>
 
+#include "CGLDiagnostics.h"
+
 #include "GLUtil.h"
 
+void clear_gl_errors()
+{
+	//A lost context can report errors indefinitely, so don't loop forever.
+	for( int iCount = 0; iCount < 32 && glGetError() != GL_NO_ERROR; ++iCount )
+	{
+	}
+}
+
 void _check_gl_error( const char *file, int line, bool fReport )
 {
+	//Errors are reported by the debug callback.
+	if( fReport && g_GLDiagnostics.IsActive() )
+		return;
+
     GLenum err = glGetError();
  
     while( err != GL_NO_ERROR )
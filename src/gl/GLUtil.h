@@ -3,8 +3,26 @@
 
 void _check_gl_error( const char *file, int line, bool fReport = true );
 
+/**
+*	Clears the GL error flags without reporting them. Not compiled out.
+*	check_gl_error doesn't read the error flags in release builds or when KHR_debug is active, so code that checks glGetError
+*	itself must call this first, or it will see errors generated by earlier calls.
+*/
+void clear_gl_errors();
+
+/*
+*	glGetError synchronizes with the driver, so polling is only done in debug builds.
+*	Errors are reported by CGLDiagnostics when KHR_debug is available, in which case polling is skipped.
+*/
+#ifndef NDEBUG
 #define check_gl_error() _check_gl_error(__FILE__,__LINE__)
+#else
+#define check_gl_error() ( ( void ) 0 )
+#endif
 
-#define ignore_gl_errors() _check_gl_error(__FILE__,__LINE__, false)
+/*
+*	Errors that are expected must be cleared in all builds, so they aren't mistaken for later errors.
+*/
+#define ignore_gl_errors() clear_gl_errors()
 
 #endif //GLUTIL_H
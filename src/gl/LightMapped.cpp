@@ -0,0 +1,67 @@
+#include "entity/CBaseEntity.h"
+
+#include "CGLStateCache.h"
+#include "CShaderInstance.h"
+
+#include "CBaseShader.h"
+
+/**
+*	Draws a lightmapped polygon.
+*	Textures and lightmaps are array textures; the third texture coordinate is the layer.
+*	Permutations handle '{' textures (alpha test), '!' textures (water warp) and the blending render modes.
+*/
+BEGIN_SHADER( LightMapped )
+
+	SHADER_FEATURES( SHADER_FEATURE_ALPHA_TEST | SHADER_FEATURE_WARP | SHADER_FEATURE_RENDERMODE_TEXTURE | SHADER_FEATURE_RENDERMODE_ADDITIVE )
+
+	BEGIN_SHADER_ATTRIBS()
+		SHADER_ATTRIB( vecPosition, VEC3 )
+		SHADER_ATTRIB( vecTexCoord, VEC3 )
+		SHADER_ATTRIB( vecLightmapCoord, VEC3 )
+	END_SHADER_ATTRIBS()
+
+	BEGIN_SHADER_UNIFORMS()
+		SHADER_UNIFORM( tex, SAMPLER_TEXTURE )
+		SHADER_UNIFORM( lightmap, SAMPLER_TEXTURE )
+		SHADER_FEATURE_UNIFORM( renderAmount, FLOAT, SHADER_FEATURE_RENDERMODE_TEXTURE | SHADER_FEATURE_RENDERMODE_ADDITIVE )
+	END_SHADER_UNIFORMS()
+
+	BEGIN_SHADER_OUTPUTS()
+		SHADER_OUTPUT( outColor )
+	END_SHADER_OUTPUTS()
+
+	BEGIN_SHADER_CLASS()
+
+	SHADER_ACTIVATE
+	{
+		const uint32_t uiFeatures = pInstance->GetFeatures();
+
+		//The render mode is part of the permutation, so only the blend function and the amount are set here.
+		if( uiFeatures & SHADER_FEATURE_RENDERMODE_TEXTURE )
+		{
+			g_GLState.Enable( GL_BLEND );
+			g_GLState.BlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+		}
+		else if( uiFeatures & SHADER_FEATURE_RENDERMODE_ADDITIVE )
+		{
+			//The shader scales the color by the amount itself.
+			g_GLState.Enable( GL_BLEND );
+			g_GLState.BlendFunc( GL_ONE, GL_ONE );
+		}
+		else
+		{
+			g_GLState.Disable( GL_BLEND );
+			return;
+		}
+
+		g_GLState.Uniform1f( pInstance->GetUniforms()[ renderAmount ], pEntity->GetRenderAmount() / 255.0f );
+	}
+
+	SHADER_DRAW
+	{
+		glMultiDrawArrays( GL_POLYGON, pFirsts, pCounts, static_cast<GLsizei>( uiNumDraws ) );
+
+		check_gl_error();
+	}
+
+END_SHADER()
\ No newline at end of file
@@ -5,15 +5,24 @@
 */
 BEGIN_SHADER( Polygon )
 
+	SHADER_FEATURES( 0 )
+
 	BEGIN_SHADER_ATTRIBS()
 		SHADER_ATTRIB( LVertexPos2D, VEC2 )
+	END_SHADER_ATTRIBS()
+
+	BEGIN_SHADER_UNIFORMS()
+	END_SHADER_UNIFORMS()
 
+	BEGIN_SHADER_OUTPUTS()
 		SHADER_OUTPUT( outColor )
-	END_SHADER_ATTRIBS()
+	END_SHADER_OUTPUTS()
+
+	BEGIN_SHADER_CLASS()
 
 	SHADER_DRAW
 	{
-		glDrawArrays( GL_POLYGON, 0, uiNumVerts );
+		glMultiDrawArrays( GL_POLYGON, pFirsts, pCounts, static_cast<GLsizei>( uiNumDraws ) );
 
 		check_gl_error();
 	}
@@ -0,0 +1,47 @@
+#ifndef GL_SHADERFEATURES_H
+#define GL_SHADERFEATURES_H
+
+#include <cstdint>
+
+/**
+*	Feature flags that shaders can be compiled with. Each combination of flags that a shader supports is a permutation.
+*	A permutation's sources are compiled with #define <name> 1 for every flag it has, so features are selected
+*	with #ifdef instead of runtime branches.
+*/
+enum ShaderFeature : uint32_t
+{
+	/**
+	*	Discard texels with an alpha below 0.5. Used by '{' textures.
+	*/
+	SHADER_FEATURE_ALPHA_TEST			= 1 << 0,
+
+	/**
+	*	Animate vertices with a water warp. Used by '!' textures.
+	*/
+	SHADER_FEATURE_WARP					= 1 << 1,
+
+	/**
+	*	kRenderTransTexture: alpha blended, scaled by the render amount.
+	*/
+	SHADER_FEATURE_RENDERMODE_TEXTURE	= 1 << 2,
+
+	/**
+	*	kRenderTransAdd: added to the framebuffer, scaled by the render amount.
+	*/
+	SHADER_FEATURE_RENDERMODE_ADDITIVE	= 1 << 3,
+
+	NUM_SHADER_FEATURES = 4
+};
+
+/**
+*	Names of the features as defined in the shader sources, indexed by bit.
+*/
+static const char* const SHADER_FEATURE_NAMES[ NUM_SHADER_FEATURES ] =
+{
+	"ALPHA_TEST",
+	"WARP",
+	"RENDERMODE_TEXTURE",
+	"RENDERMODE_ADDITIVE"
+};
+
+#endif //GL_SHADERFEATURES_H
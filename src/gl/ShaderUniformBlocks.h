@@ -0,0 +1,59 @@
+#ifndef GL_SHADERUNIFORMBLOCKS_H
+#define GL_SHADERUNIFORMBLOCKS_H
+
+#include <glm/mat4x4.hpp>
+
+/**
+*	Uniform blocks shared by all shaders. The structures must match the std140 layout of the blocks in the shader files.
+*/
+
+/**
+*	Binding points of the shared uniform blocks.
+*/
+enum UniformBlockBinding
+{
+	/**
+	*	FrameData block. Updated once per frame.
+	*/
+	UNIFORM_BLOCK_FRAME = 0,
+
+	/**
+	*	ObjectData block. Updated when the object being drawn changes.
+	*/
+	UNIFORM_BLOCK_OBJECT,
+
+	NUM_UNIFORM_BLOCKS
+};
+
+/**
+*	Names of the uniform blocks in the shaders, indexed by binding.
+*/
+static const char* const UNIFORM_BLOCK_NAMES[ NUM_UNIFORM_BLOCKS ] =
+{
+	"FrameData",
+	"ObjectData"
+};
+
+struct FrameUniforms_t
+{
+	glm::mat4x4 matProj;
+	glm::mat4x4 matView;
+
+	/**
+	*	Time since the app started, in seconds.
+	*/
+	float realtime;
+
+	//std140 rounds the block size up to a multiple of 16 bytes.
+	float flPadding[ 3 ];
+};
+
+struct ObjectUniforms_t
+{
+	glm::mat4x4 matModel;
+};
+
+static_assert( sizeof( FrameUniforms_t ) == 144, "FrameUniforms_t does not match the std140 layout of FrameData" );
+static_assert( sizeof( ObjectUniforms_t ) == 64, "ObjectUniforms_t does not match the std140 layout of ObjectData" );
+
+#endif //GL_SHADERUNIFORMBLOCKS_H
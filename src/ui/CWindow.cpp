@@ -1,6 +1,8 @@
 #include <cassert>
 #include <cstdio>
 
+#include "utility/CLogger.h"
+
 #include "CWindowArgs.h"
 
 #include "CWindow.h"
@@ -188,7 +190,7 @@ void CWindow::MakeFullscreen( const bool bFullscreen )
 
 	if( SDL_SetWindowFullscreen( m_pWindow, bFullscreen ? SDL_WINDOW_FULLSCREEN : 0 ) < 0 )
 	{
-		printf( "CWindow::MakeFullscreen: Failed to change fullscreen mode\nSDL error: %s\n", SDL_GetError() );
+		g_Logger.Error( LogCategory::APP, "CWindow::MakeFullscreen: Failed to change fullscreen mode\nSDL error: %s\n", SDL_GetError() );
 	}
 }
 
@@ -4,6 +4,8 @@
 
 #include <GL\glew.h>
 
+#include "utility/CLogger.h"
+
 #include "CWindow.h"
 #include "CWindowArgs.h"
 
@@ -30,7 +32,7 @@ bool CWindowManager::Initialize()
 
 	if( SDL_Init( SDL_INIT_VIDEO ) < 0 )
 	{
-		printf( "SDL could not initialize!\nSDL error: %s\n", SDL_GetError() );
+		g_Logger.Error( LogCategory::APP, "SDL could not initialize!\nSDL error: %s\n", SDL_GetError() );
 		return false;
 	}
 
@@ -38,6 +40,11 @@ bool CWindowManager::Initialize()
 	SDL_GL_SetAttribute( SDL_GL_CONTEXT_MINOR_VERSION, 1 );
 	SDL_GL_SetAttribute( SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE );
 
+#ifndef NDEBUG
+	//Debug contexts report more through KHR_debug.
+	SDL_GL_SetAttribute( SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG );
+#endif
+
 	m_pContextWindow = new CWindow( CWindowArgs().Title( "GL Context" ).Size( 0, 0 ).Flags( SDL_WINDOW_HIDDEN ) );
 
 	if( !m_pContextWindow )
@@ -54,14 +61,14 @@ bool CWindowManager::Initialize()
 
 	if( glewResult != GLEW_OK )
 	{
-		printf( "Failed to initialize GLEW\nGLEW error: %s\n", glewGetErrorString( glewResult ) );
+		g_Logger.Error( LogCategory::APP, "Failed to initialize GLEW\nGLEW error: %s\n", reinterpret_cast<const char*>( glewGetErrorString( glewResult ) ) );
 
 		return false;
 	}
 
 	if( SDL_GL_SetSwapInterval( 1 ) < 0 )
 	{
-		printf( "Warning: Unable to set up VSync\nSDL error: %s\n", SDL_GetError() );
+		g_Logger.Warning( LogCategory::APP, "Warning: Unable to set up VSync\nSDL error: %s\n", SDL_GetError() );
 	}
 
 	m_bInitResult = true;
@@ -119,7 +126,7 @@ CWindow* CWindowManager::WindowCreated( CWindow* pWindow )
 
 	if( !pWindow->IsValid() )
 	{
-		printf( "CWindowManager::CreateWindow: Failed to create window!\n" );
+		g_Logger.Error( LogCategory::APP, "CWindowManager::CreateWindow: Failed to create window!\n" );
 
 		delete pWindow;
 		return nullptr;
@@ -141,7 +148,7 @@ void CWindowManager::DestroyWindow( CWindow* pWindow )
 
 	if( it == m_Windows.end() )
 	{
-		printf( "CWindowManager::DestroyWindow: Window is not managed by this manager!\n" );
+		g_Logger.Error( LogCategory::APP, "CWindowManager::DestroyWindow: Window is not managed by this manager!\n" );
 		return;
 	}
 
@@ -0,0 +1,50 @@
+#include <cassert>
+
+#include "CAtomTable.h"
+
+CAtomTable g_AtomTable;
+
+size_t CAtomTable::GetNumAtoms() const
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	return m_Atoms.size();
+}
+
+const char* CAtomTable::Intern( const char* const pszString )
+{
+	assert( pszString );
+
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	auto it = m_Atoms.find( pszString );
+
+	if( it != m_Atoms.end() )
+		return *it;
+
+	const char* pszAtom = m_Strings.Add( pszString );
+
+	m_Atoms.insert( pszAtom );
+
+	return pszAtom;
+}
+
+const char* CAtomTable::Find( const char* const pszString ) const
+{
+	assert( pszString );
+
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	auto it = m_Atoms.find( pszString );
+
+	return it != m_Atoms.end() ? *it : nullptr;
+}
+
+void CAtomTable::Clear()
+{
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	m_Atoms.clear();
+	m_Strings.Clear();
+}
+
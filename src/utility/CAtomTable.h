@@ -0,0 +1,69 @@
+#ifndef UTILITY_CATOMTABLE_H
+#define UTILITY_CATOMTABLE_H
+
+#include <mutex>
+#include <unordered_set>
+
+#include "common/StringUtils.h"
+
+#include "CStringArena.h"
+
+/**
+*	Interns strings. Every distinct string is stored once; interned strings can be compared by pointer.
+*	Interned strings remain valid until the table is cleared. Thread safe.
+*/
+class CAtomTable final
+{
+private:
+	typedef std::unordered_set<const char*, RawCharHash, RawCharEqualTo> Atoms_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CAtomTable() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CAtomTable() = default;
+
+	/**
+	*	@return The number of interned strings.
+	*/
+	size_t GetNumAtoms() const;
+
+	/**
+	*	Interns a string.
+	*	@param pszString String to intern.
+	*	@return The interned string. The same pointer is returned for every string with the same contents.
+	*/
+	const char* Intern( const char* const pszString );
+
+	/**
+	*	Finds an interned string.
+	*	@param pszString String to find.
+	*	@return The interned string, or null if the string has not been interned.
+	*/
+	const char* Find( const char* const pszString ) const;
+
+	/**
+	*	Removes all strings. Invalidates all interned strings.
+	*/
+	void Clear();
+
+private:
+	mutable std::mutex m_Mutex;
+
+	Atoms_t m_Atoms;
+
+	CStringArena m_Strings;
+
+private:
+	CAtomTable( const CAtomTable& ) = delete;
+	CAtomTable& operator=( const CAtomTable& ) = delete;
+};
+
+extern CAtomTable g_AtomTable;
+
+#endif //UTILITY_CATOMTABLE_H
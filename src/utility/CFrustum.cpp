@@ -0,0 +1,42 @@
+#include <glm/geometric.hpp>
+
+#include "CFrustum.h"
+
+void CFrustum::Update( const glm::mat4x4& viewProjection )
+{
+	//glm matrices are column major, so rows have to be gathered.
+	glm::vec4 rows[ 4 ];
+
+	for( int iRow = 0; iRow < 4; ++iRow )
+	{
+		rows[ iRow ] = glm::vec4( viewProjection[ 0 ][ iRow ], viewProjection[ 1 ][ iRow ], viewProjection[ 2 ][ iRow ], viewProjection[ 3 ][ iRow ] );
+	}
+
+	//A point is inside if -w <= x, y, z <= w in clip space.
+	m_Planes[ PLANE_LEFT ]		= rows[ 3 ] + rows[ 0 ];
+	m_Planes[ PLANE_RIGHT ]		= rows[ 3 ] - rows[ 0 ];
+	m_Planes[ PLANE_BOTTOM ]	= rows[ 3 ] + rows[ 1 ];
+	m_Planes[ PLANE_TOP ]		= rows[ 3 ] - rows[ 1 ];
+	m_Planes[ PLANE_NEAR ]		= rows[ 3 ] + rows[ 2 ];
+	m_Planes[ PLANE_FAR ]		= rows[ 3 ] - rows[ 2 ];
+
+	//Normalize so distances to the planes are in world units.
+	for( auto& plane : m_Planes )
+	{
+		const float flLength = glm::length( glm::vec3( plane ) );
+
+		if( flLength > 0 )
+			plane /= flLength;
+	}
+}
+
+bool CFrustum::IsSphereInside( const Vector& vecCenter, const float flRadius ) const
+{
+	for( const auto& plane : m_Planes )
+	{
+		if( glm::dot( glm::vec3( plane ), vecCenter ) + plane.w < -flRadius )
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,61 @@
+#ifndef UTILITY_CFRUSTUM_H
+#define UTILITY_CFRUSTUM_H
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Mathlib.h"
+
+/**
+*	View frustum, stored as 6 planes facing inwards.
+*/
+class CFrustum final
+{
+public:
+	enum Plane
+	{
+		PLANE_LEFT = 0,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+		PLANE_NEAR,
+		PLANE_FAR,
+
+		NUM_PLANES
+	};
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CFrustum() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CFrustum() = default;
+
+	CFrustum( const CFrustum& other ) = default;
+	CFrustum& operator=( const CFrustum& other ) = default;
+
+	/**
+	*	Extracts the planes from a view projection matrix. The planes are in the space that the matrix transforms from.
+	*	@param viewProjection Projection matrix multiplied by the view matrix.
+	*/
+	void Update( const glm::mat4x4& viewProjection );
+
+	/**
+	*	@return The given plane. xyz is the normal, w the distance. Points for which dot( normal, point ) + w >= 0 are in front of the plane.
+	*/
+	const glm::vec4& GetPlane( const Plane plane ) const { return m_Planes[ plane ]; }
+
+	/**
+	*	@return Whether a sphere is at least partially inside the frustum.
+	*/
+	bool IsSphereInside( const Vector& vecCenter, const float flRadius ) const;
+
+private:
+	glm::vec4 m_Planes[ NUM_PLANES ];
+};
+
+#endif //UTILITY_CFRUSTUM_H
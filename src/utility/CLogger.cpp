@@ -0,0 +1,481 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "common/StringUtils.h"
+
+#include "CLogger.h"
+
+CLogger g_Logger;
+
+/**
+*	How long the background thread sleeps when there is nothing to write. The time doubles every time it wakes up to an empty queue,
+*	so an idle logger doesn't keep waking up.
+*/
+static const std::chrono::milliseconds WRITER_MIN_SLEEP_TIME( 5 );
+static const std::chrono::milliseconds WRITER_MAX_SLEEP_TIME( 250 );
+
+static const char* const CATEGORY_NAMES[ static_cast<size_t>( LogCategory::NUM ) ] =
+{
+	"general",
+	"app",
+	"render",
+	"gl",
+	"bsp",
+	"entity",
+	"filesystem",
+	"wad",
+	"bundle"
+};
+
+static const char* const LEVEL_NAMES[ static_cast<size_t>( LogLevel::NUM ) ] =
+{
+	"verbose",
+	"info",
+	"warning",
+	"error",
+	"none"
+};
+
+CLogger::CLogger()
+	: m_uiEnqueuePos( 0 )
+	, m_uiWrittenPos( 0 )
+	, m_uiDropped( 0 )
+	, m_bRunning( false )
+	, m_iFlushWaiters( 0 )
+	, m_bWriterParked( false )
+{
+	for( size_t uiIndex = 0; uiIndex < NUM_RECORDS; ++uiIndex )
+	{
+		m_Records[ uiIndex ].sequence.store( uiIndex, std::memory_order_relaxed );
+	}
+
+	SetLevel( LogLevel::INFO );
+}
+
+bool CLogger::Initialize()
+{
+	if( IsInitialized() )
+		return true;
+
+	m_bShutdown = false;
+
+	m_Thread = std::thread( &CLogger::WriterThread, this );
+
+	m_bRunning.store( true, std::memory_order_release );
+
+	return true;
+}
+
+void CLogger::Shutdown()
+{
+	if( !IsInitialized() )
+		return;
+
+	//Messages logged from now on are written immediately; the background thread writes what was queued.
+	m_bRunning.store( false, std::memory_order_release );
+
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+
+		m_bShutdown = true;
+	}
+
+	m_Condition.notify_one();
+
+	m_Thread.join();
+}
+
+void CLogger::Flush()
+{
+	if( !IsInitialized() )
+		return;
+
+	const size_t uiTarget = m_uiEnqueuePos.load( std::memory_order_acquire );
+
+	std::unique_lock<std::mutex> lock( m_Mutex );
+
+	++m_iFlushWaiters;
+
+	m_Condition.notify_one();
+
+	m_FlushCondition.wait( lock, [ this, uiTarget ]() { return m_uiWrittenPos.load( std::memory_order_acquire ) >= uiTarget; } );
+
+	--m_iFlushWaiters;
+}
+
+void CLogger::SetLevel( const LogLevel level )
+{
+	for( size_t uiIndex = 0; uiIndex < static_cast<size_t>( LogCategory::NUM ); ++uiIndex )
+	{
+		SetLevel( static_cast<LogCategory>( uiIndex ), level );
+	}
+}
+
+const char* CLogger::GetCategoryName( const LogCategory category )
+{
+	if( category < LogCategory::GENERAL || category >= LogCategory::NUM )
+		return nullptr;
+
+	return CATEGORY_NAMES[ static_cast<size_t>( category ) ];
+}
+
+LogCategory CLogger::GetCategoryByName( const char* const pszName )
+{
+	assert( pszName );
+
+	for( size_t uiIndex = 0; uiIndex < static_cast<size_t>( LogCategory::NUM ); ++uiIndex )
+	{
+		if( strcasecmp( CATEGORY_NAMES[ uiIndex ], pszName ) == 0 )
+			return static_cast<LogCategory>( uiIndex );
+	}
+
+	return LogCategory::NUM;
+}
+
+LogLevel CLogger::GetLevelByName( const char* const pszName )
+{
+	assert( pszName );
+
+	for( size_t uiIndex = 0; uiIndex < static_cast<size_t>( LogLevel::NUM ); ++uiIndex )
+	{
+		if( strcasecmp( LEVEL_NAMES[ uiIndex ], pszName ) == 0 )
+			return static_cast<LogLevel>( uiIndex );
+	}
+
+	return LogLevel::NUM;
+}
+
+CLogger::Record_t* CLogger::BeginRecord()
+{
+	size_t uiPos = m_uiEnqueuePos.load( std::memory_order_relaxed );
+
+	while( true )
+	{
+		Record_t* pRecord = &m_Records[ uiPos & ( NUM_RECORDS - 1 ) ];
+
+		const size_t uiSequence = pRecord->sequence.load( std::memory_order_acquire );
+
+		const intptr_t iDiff = static_cast<intptr_t>( uiSequence ) - static_cast<intptr_t>( uiPos );
+
+		if( iDiff == 0 )
+		{
+			//The record is free; claim it.
+			if( m_uiEnqueuePos.compare_exchange_weak( uiPos, uiPos + 1, std::memory_order_relaxed ) )
+				return pRecord;
+		}
+		else if( iDiff < 0 )
+		{
+			//The record hasn't been written yet; the buffer is full.
+			return nullptr;
+		}
+		else
+		{
+			//Another producer claimed it.
+			uiPos = m_uiEnqueuePos.load( std::memory_order_relaxed );
+		}
+	}
+}
+
+void CLogger::EndRecord( Record_t* pRecord )
+{
+	assert( pRecord );
+
+	const size_t uiPos = pRecord->sequence.load( std::memory_order_relaxed );
+
+	//Hand the record to the background thread.
+	pRecord->sequence.store( uiPos + 1, std::memory_order_release );
+
+	//Only the first producer to find the writer parked wakes it; everyone else stays off the condition variable.
+	if( m_bWriterParked.load( std::memory_order_relaxed ) && m_bWriterParked.exchange( false, std::memory_order_relaxed ) )
+		m_Condition.notify_one();
+}
+
+void CLogger::WriteImmediately( const Record_t& record )
+{
+	char szMessage[ MAX_MESSAGE_LENGTH ];
+
+	FormatRecord( record, szMessage, sizeof( szMessage ) );
+
+	fputs( szMessage, stdout );
+}
+
+void CLogger::PackArg( Record_t& record, const char* const pszValue )
+{
+	const char* const pszString = pszValue ? pszValue : "(null)";
+
+	const size_t uiAvailable = STRING_BUFFER_SIZE - record.uiStringLength;
+
+	Arg_t& arg = record.args[ record.uiNumArgs ];
+
+	record.argTypes[ record.uiNumArgs ] = ArgType::STRING;
+	++record.uiNumArgs;
+
+	arg.uiStringOffset = record.uiStringLength;
+
+	//There's always room for the terminator; earlier strings leave at least one byte.
+	if( uiAvailable == 0 )
+	{
+		arg.uiStringOffset = STRING_BUFFER_SIZE - 1;
+		return;
+	}
+
+	const size_t uiLength = strlen( pszString );
+	const size_t uiCount = uiLength < uiAvailable ? uiLength : uiAvailable - 1;
+
+	memcpy( record.szStrings + record.uiStringLength, pszString, uiCount );
+
+	record.szStrings[ record.uiStringLength + uiCount ] = '\0';
+
+	record.uiStringLength += uiCount + 1;
+}
+
+size_t CLogger::FormatRecord( const Record_t& record, char* pszBuffer, const size_t uiBufferSize )
+{
+	assert( pszBuffer );
+	assert( uiBufferSize > 0 );
+
+	size_t uiLength = 0;
+	size_t uiArg = 0;
+
+	//Leaves room for the terminator.
+	auto append = [ & ]( const char* pszText, size_t uiCount )
+	{
+		if( uiLength + uiCount >= uiBufferSize )
+			uiCount = uiBufferSize - 1 - uiLength;
+
+		memcpy( pszBuffer + uiLength, pszText, uiCount );
+		uiLength += uiCount;
+	};
+
+	const char* pszFormat = record.pszFormat;
+
+	while( *pszFormat )
+	{
+		const char* pszPercent = strchr( pszFormat, '%' );
+
+		if( !pszPercent )
+		{
+			append( pszFormat, strlen( pszFormat ) );
+			break;
+		}
+
+		append( pszFormat, pszPercent - pszFormat );
+
+		if( pszPercent[ 1 ] == '%' )
+		{
+			append( "%", 1 );
+			pszFormat = pszPercent + 2;
+			continue;
+		}
+
+		//Copy flags, width and precision, drop length modifiers; the argument's stored type determines the length.
+		char szSpec[ 32 ];
+		size_t uiSpecLength = 0;
+
+		szSpec[ uiSpecLength++ ] = '%';
+
+		const char* pszChar = pszPercent + 1;
+
+		while( *pszChar && strchr( "-+ #0123456789.", *pszChar ) && uiSpecLength < sizeof( szSpec ) - 4 )
+			szSpec[ uiSpecLength++ ] = *pszChar++;
+
+		while( *pszChar && strchr( "hlLzjtqI64", *pszChar ) )
+			++pszChar;
+
+		const char conversion = *pszChar;
+
+		if( !conversion )
+			break;
+
+		pszFormat = pszChar + 1;
+
+		if( uiArg >= record.uiNumArgs )
+		{
+			append( "<missing>", 9 );
+			continue;
+		}
+
+		const ArgType type = record.argTypes[ uiArg ];
+		const Arg_t& arg = record.args[ uiArg ];
+
+		++uiArg;
+
+		char szValue[ 256 ];
+		int iResult = 0;
+
+		switch( conversion )
+		{
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			{
+				szSpec[ uiSpecLength++ ] = 'l';
+				szSpec[ uiSpecLength++ ] = 'l';
+				szSpec[ uiSpecLength++ ] = conversion;
+				szSpec[ uiSpecLength ] = '\0';
+
+				if( type == ArgType::DOUBLE )
+					iResult = snprintf( szValue, sizeof( szValue ), szSpec, static_cast<long long>( arg.flValue ) );
+				else
+					iResult = snprintf( szValue, sizeof( szValue ), szSpec, static_cast<long long>( arg.iValue ) );
+				break;
+			}
+
+		case 'c':
+			{
+				szSpec[ uiSpecLength++ ] = 'c';
+				szSpec[ uiSpecLength ] = '\0';
+
+				iResult = snprintf( szValue, sizeof( szValue ), szSpec, static_cast<int>( arg.iValue ) );
+				break;
+			}
+
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+			{
+				szSpec[ uiSpecLength++ ] = conversion;
+				szSpec[ uiSpecLength ] = '\0';
+
+				double flValue = arg.flValue;
+
+				if( type == ArgType::SIGNED )
+					flValue = static_cast<double>( arg.iValue );
+				else if( type == ArgType::UNSIGNED )
+					flValue = static_cast<double>( arg.uiValue );
+
+				iResult = snprintf( szValue, sizeof( szValue ), szSpec, flValue );
+				break;
+			}
+
+		case 's':
+			{
+				szSpec[ uiSpecLength++ ] = 's';
+				szSpec[ uiSpecLength ] = '\0';
+
+				const char* pszValue = type == ArgType::STRING ? record.szStrings + arg.uiStringOffset : "<not a string>";
+
+				iResult = snprintf( szValue, sizeof( szValue ), szSpec, pszValue );
+				break;
+			}
+
+		case 'p':
+			{
+				iResult = snprintf( szValue, sizeof( szValue ), "%p", arg.pValue );
+				break;
+			}
+
+		default:
+			{
+				iResult = snprintf( szValue, sizeof( szValue ), "<bad format %c>", conversion );
+				break;
+			}
+		}
+
+		if( iResult > 0 )
+			append( szValue, strlen( szValue ) );
+	}
+
+	pszBuffer[ uiLength ] = '\0';
+
+	return uiLength;
+}
+
+void CLogger::WriterThread()
+{
+	auto sleepTime = WRITER_MIN_SLEEP_TIME;
+
+	while( true )
+	{
+		const bool bWrote = WriteRecords();
+
+		if( m_iFlushWaiters.load( std::memory_order_relaxed ) > 0 )
+		{
+			std::lock_guard<std::mutex> lock( m_Mutex );
+
+			m_FlushCondition.notify_all();
+		}
+
+		if( bWrote )
+		{
+			sleepTime = WRITER_MIN_SLEEP_TIME;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock( m_Mutex );
+
+		if( m_bShutdown )
+		{
+			//Producers may still have been publishing.
+			lock.unlock();
+			WriteRecords();
+			return;
+		}
+
+		//A wakeup that races with parking is missed, which delays the message by at most one sleep.
+		if( sleepTime >= WRITER_MAX_SLEEP_TIME )
+			m_bWriterParked.store( true, std::memory_order_relaxed );
+
+		m_Condition.wait_for( lock, sleepTime );
+
+		m_bWriterParked.store( false, std::memory_order_relaxed );
+
+		sleepTime = std::min( sleepTime * 2, WRITER_MAX_SLEEP_TIME );
+	}
+}
+
+bool CLogger::WriteRecords()
+{
+	char szMessage[ MAX_MESSAGE_LENGTH ];
+
+	bool bWrote = false;
+
+	while( true )
+	{
+		Record_t& record = m_Records[ m_uiDequeuePos & ( NUM_RECORDS - 1 ) ];
+
+		const size_t uiSequence = record.sequence.load( std::memory_order_acquire );
+
+		//Not published yet.
+		if( uiSequence != m_uiDequeuePos + 1 )
+			break;
+
+		FormatRecord( record, szMessage, sizeof( szMessage ) );
+
+		fputs( szMessage, stdout );
+
+		//Give the record back to producers for the next lap.
+		record.sequence.store( m_uiDequeuePos + NUM_RECORDS, std::memory_order_release );
+
+		++m_uiDequeuePos;
+
+		bWrote = true;
+	}
+
+	const size_t uiDropped = m_uiDropped.load( std::memory_order_relaxed );
+
+	if( uiDropped != m_uiReportedDropped )
+	{
+		fprintf( stdout, "CLogger: %u messages were dropped because the log buffer was full\n", static_cast<unsigned int>( uiDropped - m_uiReportedDropped ) );
+
+		m_uiReportedDropped = uiDropped;
+
+		bWrote = true;
+	}
+
+	if( bWrote )
+		fflush( stdout );
+
+	m_uiWrittenPos.store( m_uiDequeuePos, std::memory_order_release );
+
+	return bWrote;
+}
@@ -0,0 +1,435 @@
+#ifndef UTILITY_CLOGGER_H
+#define UTILITY_CLOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+/**
+*	Subsystems that log messages. Every category has its own level.
+*/
+enum class LogCategory
+{
+	GENERAL = 0,
+	APP,
+	RENDER,
+	GL,
+	BSP,
+	ENTITY,
+	FILESYSTEM,
+	WAD,
+	BUNDLE,
+
+	NUM
+};
+
+/**
+*	Severity of a message. Messages below a category's level are discarded by the caller.
+*/
+enum class LogLevel
+{
+	VERBOSE = 0,
+	INFO,
+	WARNING,
+
+	//ERROR is defined by the Windows headers.
+	ERR,
+
+	/**
+	*	Only used as a category level, disables all messages.
+	*/
+	NONE,
+
+	NUM
+};
+
+/**
+*	Asynchronous logger.
+*	Callers write fixed size records containing the format string and the arguments into a lock-free ring buffer;
+*	formatting and writing to stdout happen on a background thread, so logging never waits on the terminal.
+*	The ring buffer is a bounded multi producer queue (Vyukov), any thread can log. If it is full, messages are dropped and counted,
+*	except for warnings and errors, which are written immediately instead.
+*	Format strings must remain valid until the message is written; use string literals.
+*	String arguments are copied into the record and truncated if they don't fit.
+*	Before Initialize and after Shutdown, messages are written immediately on the calling thread.
+*/
+class CLogger final
+{
+public:
+	/**
+	*	Number of records in the ring buffer. Must be a power of 2.
+	*/
+	static const size_t NUM_RECORDS = 2048;
+
+	/**
+	*	Maximum number of arguments per message.
+	*/
+	static const size_t MAX_ARGS = 12;
+
+	/**
+	*	Size of the per record buffer that string arguments are copied into.
+	*/
+	static const size_t STRING_BUFFER_SIZE = 256;
+
+	/**
+	*	Maximum length of a formatted message.
+	*/
+	static const size_t MAX_MESSAGE_LENGTH = 1024;
+
+private:
+	enum class ArgType : uint8_t
+	{
+		SIGNED = 0,
+		UNSIGNED,
+		DOUBLE,
+		POINTER,
+		STRING
+	};
+
+	union Arg_t
+	{
+		int64_t iValue;
+		uint64_t uiValue;
+		double flValue;
+		const void* pValue;
+
+		/**
+		*	Offset into the record's string buffer.
+		*/
+		size_t uiStringOffset;
+	};
+
+	struct Record_t
+	{
+		/**
+		*	Vyukov queue sequence number. Tells producers and the consumer whose turn it is to use the record.
+		*/
+		std::atomic<size_t> sequence;
+
+		LogCategory category;
+		LogLevel level;
+
+		const char* pszFormat;
+
+		size_t uiNumArgs;
+		ArgType argTypes[ MAX_ARGS ];
+		Arg_t args[ MAX_ARGS ];
+
+		size_t uiStringLength;
+		char szStrings[ STRING_BUFFER_SIZE ];
+	};
+
+	static_assert( ( NUM_RECORDS & ( NUM_RECORDS - 1 ) ) == 0, "The number of log records must be a power of 2" );
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CLogger();
+
+	/**
+	*	Destructor. Writes all queued messages.
+	*/
+	~CLogger()
+	{
+		Shutdown();
+	}
+
+	/**
+	*	@return Whether the background thread is running.
+	*/
+	bool IsInitialized() const { return m_bRunning.load( std::memory_order_acquire ); }
+
+	/**
+	*	Starts the background thread.
+	*/
+	bool Initialize();
+
+	/**
+	*	Writes all queued messages and stops the background thread.
+	*/
+	void Shutdown();
+
+	/**
+	*	Blocks until all messages queued so far have been written.
+	*/
+	void Flush();
+
+	LogLevel GetLevel( const LogCategory category ) const
+	{
+		return static_cast<LogLevel>( m_Levels[ static_cast<size_t>( category ) ].load( std::memory_order_relaxed ) );
+	}
+
+	void SetLevel( const LogCategory category, const LogLevel level )
+	{
+		m_Levels[ static_cast<size_t>( category ) ].store( static_cast<int>( level ), std::memory_order_relaxed );
+	}
+
+	/**
+	*	Sets the level of all categories.
+	*/
+	void SetLevel( const LogLevel level );
+
+	/**
+	*	@return Whether messages of the given level are logged for the given category.
+	*/
+	bool IsEnabled( const LogCategory category, const LogLevel level ) const
+	{
+		return level >= GetLevel( category );
+	}
+
+	/**
+	*	@return Number of messages that were dropped because the ring buffer was full.
+	*/
+	size_t GetNumDropped() const { return m_uiDropped.load( std::memory_order_relaxed ); }
+
+	/**
+	*	Logs a message.
+	*	@param category Category of the message.
+	*	@param level Level of the message.
+	*	@param pszFormat printf style format string. Must remain valid until the message is written.
+	*	@param args Arguments. Integers, floating point values, pointers and strings are supported.
+	*/
+	template<typename... ARGS>
+	void Log( const LogCategory category, const LogLevel level, const char* const pszFormat, const ARGS&... args )
+	{
+		static_assert( sizeof...( ARGS ) <= MAX_ARGS, "Too many log arguments" );
+
+		if( !IsEnabled( category, level ) )
+			return;
+
+		Record_t* pRecord = IsInitialized() ? BeginRecord() : nullptr;
+
+		if( !pRecord )
+		{
+			//The buffer is full. Drop the message unless it's important enough to stall for.
+			if( IsInitialized() && level < LogLevel::WARNING )
+			{
+				m_uiDropped.fetch_add( 1, std::memory_order_relaxed );
+				return;
+			}
+
+			Record_t record;
+
+			FillRecord( record, category, level, pszFormat, args... );
+
+			WriteImmediately( record );
+			return;
+		}
+
+		FillRecord( *pRecord, category, level, pszFormat, args... );
+
+		EndRecord( pRecord );
+	}
+
+	template<typename... ARGS>
+	void Verbose( const LogCategory category, const char* const pszFormat, const ARGS&... args )
+	{
+		Log( category, LogLevel::VERBOSE, pszFormat, args... );
+	}
+
+	template<typename... ARGS>
+	void Info( const LogCategory category, const char* const pszFormat, const ARGS&... args )
+	{
+		Log( category, LogLevel::INFO, pszFormat, args... );
+	}
+
+	template<typename... ARGS>
+	void Warning( const LogCategory category, const char* const pszFormat, const ARGS&... args )
+	{
+		Log( category, LogLevel::WARNING, pszFormat, args... );
+	}
+
+	template<typename... ARGS>
+	void Error( const LogCategory category, const char* const pszFormat, const ARGS&... args )
+	{
+		Log( category, LogLevel::ERR, pszFormat, args... );
+	}
+
+	/**
+	*	@return The name of a category, or null if the category is invalid.
+	*/
+	static const char* GetCategoryName( const LogCategory category );
+
+	/**
+	*	@return The category with the given name, or LogCategory::NUM if there is none.
+	*/
+	static LogCategory GetCategoryByName( const char* const pszName );
+
+	/**
+	*	@return The level with the given name, or LogLevel::NUM if there is none.
+	*/
+	static LogLevel GetLevelByName( const char* const pszName );
+
+private:
+	template<typename... ARGS>
+	static void FillRecord( Record_t& record, const LogCategory category, const LogLevel level, const char* const pszFormat, const ARGS&... args )
+	{
+		record.category = category;
+		record.level = level;
+		record.pszFormat = pszFormat;
+		record.uiNumArgs = 0;
+		record.uiStringLength = 0;
+
+		//Pack the arguments in order.
+		const int dummy[] = { 0, ( PackArg( record, args ), 0 )... };
+		( void ) dummy;
+	}
+
+	/**
+	*	Claims the next record in the ring buffer.
+	*	@return The record, or null if the ring buffer is full.
+	*/
+	Record_t* BeginRecord();
+
+	/**
+	*	Publishes a record to the background thread.
+	*/
+	void EndRecord( Record_t* pRecord );
+
+	/**
+	*	Formats and writes a record on the calling thread.
+	*/
+	void WriteImmediately( const Record_t& record );
+
+	template<typename T>
+	static void PackArg( Record_t& record, const T& value )
+	{
+		PackValue( record, value, std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value>() );
+	}
+
+	static void PackArg( Record_t& record, const char* const pszValue );
+
+	static void PackArg( Record_t& record, char* const pszValue )
+	{
+		PackArg( record, static_cast<const char*>( pszValue ) );
+	}
+
+	template<size_t SIZE>
+	static void PackArg( Record_t& record, const char ( &szValue )[ SIZE ] )
+	{
+		PackArg( record, static_cast<const char*>( szValue ) );
+	}
+
+	template<size_t SIZE>
+	static void PackArg( Record_t& record, char ( &szValue )[ SIZE ] )
+	{
+		PackArg( record, static_cast<const char*>( szValue ) );
+	}
+
+	/**
+	*	Integers and enums.
+	*/
+	template<typename T>
+	static void PackValue( Record_t& record, const T& value, std::true_type )
+	{
+		Arg_t& arg = record.args[ record.uiNumArgs ];
+
+		if( std::is_signed<T>::value )
+		{
+			arg.iValue = static_cast<int64_t>( value );
+			record.argTypes[ record.uiNumArgs ] = ArgType::SIGNED;
+		}
+		else
+		{
+			arg.uiValue = static_cast<uint64_t>( value );
+			record.argTypes[ record.uiNumArgs ] = ArgType::UNSIGNED;
+		}
+
+		++record.uiNumArgs;
+	}
+
+	/**
+	*	Floating point values and pointers.
+	*/
+	template<typename T>
+	static void PackValue( Record_t& record, const T& value, std::false_type )
+	{
+		static_assert( std::is_floating_point<T>::value || std::is_pointer<T>::value, "Unsupported log argument type" );
+
+		PackOther( record, value );
+	}
+
+	static void PackOther( Record_t& record, const double flValue )
+	{
+		record.args[ record.uiNumArgs ].flValue = flValue;
+		record.argTypes[ record.uiNumArgs ] = ArgType::DOUBLE;
+		++record.uiNumArgs;
+	}
+
+	static void PackOther( Record_t& record, const void* const pValue )
+	{
+		record.args[ record.uiNumArgs ].pValue = pValue;
+		record.argTypes[ record.uiNumArgs ] = ArgType::POINTER;
+		++record.uiNumArgs;
+	}
+
+	/**
+	*	Formats a record's message.
+	*	@return Length of the message.
+	*/
+	static size_t FormatRecord( const Record_t& record, char* pszBuffer, const size_t uiBufferSize );
+
+	void WriterThread();
+
+	/**
+	*	Writes all published records.
+	*	@return Whether any records were written.
+	*/
+	bool WriteRecords();
+
+private:
+	Record_t m_Records[ NUM_RECORDS ];
+
+	/**
+	*	Next position for producers to claim.
+	*/
+	std::atomic<size_t> m_uiEnqueuePos;
+
+	/**
+	*	Next position for the background thread to write. Only used by the background thread.
+	*/
+	size_t m_uiDequeuePos = 0;
+
+	/**
+	*	Positions before this have been written. Used by Flush.
+	*/
+	std::atomic<size_t> m_uiWrittenPos;
+
+	std::atomic<size_t> m_uiDropped;
+	size_t m_uiReportedDropped = 0;
+
+	std::atomic<int> m_Levels[ static_cast<size_t>( LogCategory::NUM ) ];
+
+	std::thread m_Thread;
+
+	std::atomic<bool> m_bRunning;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::condition_variable m_FlushCondition;
+
+	bool m_bShutdown = false;
+
+	/**
+	*	Number of threads waiting in Flush.
+	*/
+	std::atomic<int> m_iFlushWaiters;
+
+	/**
+	*	Whether the background thread is sleeping for the maximum time. The next published record wakes it up.
+	*/
+	std::atomic<bool> m_bWriterParked;
+
+private:
+	CLogger( const CLogger& ) = delete;
+	CLogger& operator=( const CLogger& ) = delete;
+};
+
+extern CLogger g_Logger;
+
+#endif //UTILITY_CLOGGER_H
@@ -0,0 +1,202 @@
+#include <cassert>
+
+#include "CLogger.h"
+
+#include "CProfiler.h"
+
+CProfiler g_Profiler;
+
+struct CProfiler::Track_t
+{
+	uint32_t uiId;
+	const char* pszName;
+
+	std::unique_ptr<Event_t[]> events;
+
+	/**
+	*	Number of events that have been written. Published with release semantics, so exporting can read them while the owner records.
+	*/
+	std::atomic<size_t> uiCount;
+};
+
+namespace
+{
+/**
+*	Track of the calling thread, if it has recorded anything.
+*/
+thread_local CProfiler::Track_t* t_pThreadTrack = nullptr;
+
+thread_local const char* t_pszThreadName = nullptr;
+}
+
+CProfiler::CProfiler()
+	: m_Epoch( Clock_t::now() )
+	, m_bRecording( false )
+	, m_uiDropped( 0 )
+{
+}
+
+void CProfiler::Start()
+{
+	m_bRecording.store( true, std::memory_order_relaxed );
+}
+
+void CProfiler::Stop()
+{
+	m_bRecording.store( false, std::memory_order_relaxed );
+}
+
+void CProfiler::SetThreadName( const char* const pszName )
+{
+	t_pszThreadName = pszName;
+
+	if( t_pThreadTrack )
+		t_pThreadTrack->pszName = pszName;
+}
+
+CProfiler::Track_t* CProfiler::CreateTrack( const char* const pszName )
+{
+	assert( pszName );
+
+	std::unique_ptr<Track_t> track( new Track_t );
+
+	track->pszName = pszName;
+	track->events.reset( new Event_t[ MAX_EVENTS_PER_THREAD ] );
+	track->uiCount.store( 0, std::memory_order_relaxed );
+
+	Track_t* pTrack = track.get();
+
+	std::lock_guard<std::mutex> lock( m_Mutex );
+
+	pTrack->uiId = static_cast<uint32_t>( m_Tracks.size() + 1 );
+
+	m_Tracks.emplace_back( std::move( track ) );
+
+	return pTrack;
+}
+
+void CProfiler::AddEvent( Track_t* pTrack, const char* const pszName, const uint64_t uiStart, const uint64_t uiEnd )
+{
+	assert( pTrack );
+	assert( pszName );
+
+	//Only the owner writes the count.
+	const size_t uiCount = pTrack->uiCount.load( std::memory_order_relaxed );
+
+	if( uiCount >= MAX_EVENTS_PER_THREAD )
+	{
+		m_uiDropped.fetch_add( 1, std::memory_order_relaxed );
+		return;
+	}
+
+	Event_t& event = pTrack->events[ uiCount ];
+
+	event.pszName = pszName;
+	event.uiStart = uiStart;
+	event.uiEnd = uiEnd;
+
+	pTrack->uiCount.store( uiCount + 1, std::memory_order_release );
+}
+
+bool CProfiler::WriteChromeTrace( const char* const pszFileName )
+{
+	assert( pszFileName );
+
+	FILE* pFile = fopen( pszFileName, "wb" );
+
+	if( !pFile )
+	{
+		g_Logger.Error( LogCategory::GENERAL, "CProfiler::WriteChromeTrace: Couldn't open \"%s\" for writing\n", pszFileName );
+		return false;
+	}
+
+	size_t uiNumEvents = 0;
+
+	fprintf( pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+
+	bool bFirst = true;
+
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+
+		for( const auto& track : m_Tracks )
+		{
+			if( track->pszName )
+			{
+				fprintf( pFile, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",", track->uiId );
+				WriteString( pFile, track->pszName );
+				fprintf( pFile, "}}" );
+
+				bFirst = false;
+			}
+
+			const size_t uiCount = track->uiCount.load( std::memory_order_acquire );
+
+			for( size_t uiIndex = 0; uiIndex < uiCount; ++uiIndex )
+			{
+				const Event_t& event = track->events[ uiIndex ];
+
+				fprintf( pFile, "%s\n{\"name\":", bFirst ? "" : "," );
+				WriteString( pFile, event.pszName );
+
+				//Chrome traces use microseconds.
+				fprintf( pFile, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+					event.uiStart / 1000.0, ( event.uiEnd - event.uiStart ) / 1000.0, track->uiId );
+
+				bFirst = false;
+			}
+
+			uiNumEvents += uiCount;
+		}
+	}
+
+	fprintf( pFile, "\n]}\n" );
+
+	const bool bSuccess = !ferror( pFile );
+
+	fclose( pFile );
+
+	if( !bSuccess )
+	{
+		g_Logger.Error( LogCategory::GENERAL, "CProfiler::WriteChromeTrace: Error writing \"%s\"\n", pszFileName );
+		return false;
+	}
+
+	g_Logger.Info( LogCategory::GENERAL, "Wrote %u profiler events to \"%s\" (%u dropped)\n", uiNumEvents, pszFileName, GetNumDropped() );
+
+	return true;
+}
+
+CProfiler::Track_t* CProfiler::GetThreadTrack()
+{
+	if( !t_pThreadTrack )
+		t_pThreadTrack = CreateTrack( t_pszThreadName ? t_pszThreadName : "Thread" );
+
+	return t_pThreadTrack;
+}
+
+void CProfiler::WriteString( FILE* pFile, const char* pszString )
+{
+	fputc( '\"', pFile );
+
+	for( ; *pszString; ++pszString )
+	{
+		const char character = *pszString;
+
+		if( character == '\"' || character == '\\' )
+		{
+			fputc( '\\', pFile );
+			fputc( character, pFile );
+		}
+		else if( static_cast<unsigned char>( character ) < ' ' )
+		{
+			fprintf( pFile, "\\u%04x", static_cast<unsigned int>( static_cast<unsigned char>( character ) ) );
+		}
+		else
+		{
+			fputc( character, pFile );
+		}
+	}
+
+	fputc( '\"', pFile );
+}
@@ -0,0 +1,210 @@
+#ifndef UTILITY_CPROFILER_H
+#define UTILITY_CPROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+*	Define DISABLE_PROFILER to compile all profiling zones out.
+*/
+#ifndef DISABLE_PROFILER
+#define ENABLE_PROFILER
+#endif
+
+/**
+*	Hierarchical CPU profiler.
+*	Zones are timed with steady_clock and recorded as complete events into a buffer owned by the calling thread, so recording never locks.
+*	Zones nest by time; the trace viewer reconstructs the hierarchy per thread.
+*	Nothing is recorded unless recording has been started; a zone then costs one atomic load.
+*	Recorded events can be exported as Chrome trace JSON, which can be opened in chrome://tracing or Perfetto.
+*	Events measured elsewhere, like GPU timings, can be added to named tracks that are exported next to the threads.
+*/
+class CProfiler final
+{
+public:
+	typedef std::chrono::steady_clock Clock_t;
+
+	/**
+	*	Maximum number of events recorded per thread or track. Events beyond this are dropped and counted.
+	*/
+	static const size_t MAX_EVENTS_PER_THREAD = 1 << 17;
+
+	/**
+	*	Events of a thread or of a named track.
+	*/
+	struct Track_t;
+
+private:
+	struct Event_t
+	{
+		const char* pszName;
+
+		/**
+		*	Start and end time, in nanoseconds since the profiler was created.
+		*/
+		uint64_t uiStart;
+		uint64_t uiEnd;
+	};
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CProfiler();
+
+	/**
+	*	Destructor.
+	*/
+	~CProfiler() = default;
+
+	bool IsRecording() const { return m_bRecording.load( std::memory_order_relaxed ); }
+
+	/**
+	*	Starts recording zones.
+	*/
+	void Start();
+
+	/**
+	*	Stops recording zones. Recorded events are kept until they are exported.
+	*/
+	void Stop();
+
+	/**
+	*	@return Current time, in nanoseconds since the profiler was created.
+	*/
+	uint64_t GetTimestamp() const
+	{
+		return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( Clock_t::now() - m_Epoch ).count() );
+	}
+
+	/**
+	*	Names the calling thread in exported traces. The name must be a string literal.
+	*/
+	void SetThreadName( const char* const pszName );
+
+	/**
+	*	Records a zone on the calling thread.
+	*	@param pszName Name of the zone. Must be a string literal.
+	*	@param uiStart Start time, as returned by GetTimestamp.
+	*	@param uiEnd End time, as returned by GetTimestamp.
+	*/
+	void AddEvent( const char* const pszName, const uint64_t uiStart, const uint64_t uiEnd )
+	{
+		AddEvent( GetThreadTrack(), pszName, uiStart, uiEnd );
+	}
+
+	/**
+	*	Creates a named track. Tracks exist until the profiler is destroyed.
+	*	@param pszName Name of the track. Must be a string literal.
+	*/
+	Track_t* CreateTrack( const char* const pszName );
+
+	/**
+	*	Records a zone on a track. Only one thread may record to a given track.
+	*	@see AddEvent( const char*, uint64_t, uint64_t )
+	*/
+	void AddEvent( Track_t* pTrack, const char* const pszName, const uint64_t uiStart, const uint64_t uiEnd );
+
+	/**
+	*	@return Number of events that were dropped because a track was full.
+	*/
+	size_t GetNumDropped() const { return m_uiDropped.load( std::memory_order_relaxed ); }
+
+	/**
+	*	Writes all recorded events to a Chrome trace JSON file.
+	*	@param pszFileName Name of the file to write.
+	*	@return Whether the file was written.
+	*/
+	bool WriteChromeTrace( const char* const pszFileName );
+
+private:
+	/**
+	*	@return The calling thread's track. Created on first use.
+	*/
+	Track_t* GetThreadTrack();
+
+	static void WriteString( FILE* pFile, const char* pszString );
+
+private:
+	const Clock_t::time_point m_Epoch;
+
+	std::atomic<bool> m_bRecording;
+
+	std::atomic<size_t> m_uiDropped;
+
+	std::mutex m_Mutex;
+
+	/**
+	*	Tracks of all threads that have recorded events, and named tracks. Tracks outlive their threads, so the events can be exported afterwards.
+	*/
+	std::vector<std::unique_ptr<Track_t>> m_Tracks;
+
+private:
+	CProfiler( const CProfiler& ) = delete;
+	CProfiler& operator=( const CProfiler& ) = delete;
+};
+
+extern CProfiler g_Profiler;
+
+/**
+*	Records the time between construction and destruction as a zone.
+*/
+class CProfileZone final
+{
+public:
+	/**
+	*	Constructor.
+	*	@param pszName Name of the zone. Must be a string literal.
+	*/
+	explicit CProfileZone( const char* const pszName )
+		: m_pszName( g_Profiler.IsRecording() ? pszName : nullptr )
+		, m_uiStart( m_pszName ? g_Profiler.GetTimestamp() : 0 )
+	{
+	}
+
+	/**
+	*	Destructor. Records the zone.
+	*/
+	~CProfileZone()
+	{
+		if( m_pszName )
+			g_Profiler.AddEvent( m_pszName, m_uiStart, g_Profiler.GetTimestamp() );
+	}
+
+private:
+	const char* const m_pszName;
+	const uint64_t m_uiStart;
+
+private:
+	CProfileZone( const CProfileZone& ) = delete;
+	CProfileZone& operator=( const CProfileZone& ) = delete;
+};
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCAT_IMPL( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_IMPL( a, b )
+
+/**
+*	Profiles the rest of the enclosing scope.
+*/
+#define PROFILE_SCOPE( pszName ) CProfileZone PROFILE_CONCAT( profileZone_, __LINE__ )( pszName )
+
+/**
+*	Profiles the rest of the enclosing function.
+*/
+#define PROFILE_FUNCTION() PROFILE_SCOPE( __FUNCTION__ )
+
+#define PROFILE_THREAD_NAME( pszName ) g_Profiler.SetThreadName( pszName )
+#else
+#define PROFILE_SCOPE( pszName )
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME( pszName )
+#endif
+
+#endif //UTILITY_CPROFILER_H
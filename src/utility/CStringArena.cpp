@@ -0,0 +1,62 @@
+#include <cassert>
+#include <cstring>
+
+#include "CStringArena.h"
+
+const char* CStringArena::Add( const char* pszString, const size_t uiLength )
+{
+	assert( pszString || uiLength == 0 );
+
+	const size_t uiSize = uiLength + 1;
+
+	char* pszResult;
+
+	//Long strings get their own block so the current block isn't wasted.
+	if( uiSize > BLOCK_SIZE / 4 )
+	{
+		m_Blocks.emplace_back( new char[ uiSize ] );
+
+		pszResult = m_Blocks.back().get();
+	}
+	else
+	{
+		if( uiSize > m_uiBlockRemaining )
+		{
+			m_Blocks.emplace_back( new char[ BLOCK_SIZE ] );
+
+			m_pBlockPosition = m_Blocks.back().get();
+			m_uiBlockRemaining = BLOCK_SIZE;
+		}
+
+		pszResult = m_pBlockPosition;
+
+		m_pBlockPosition += uiSize;
+		m_uiBlockRemaining -= uiSize;
+	}
+
+	if( uiLength )
+		memcpy( pszResult, pszString, uiLength );
+
+	pszResult[ uiLength ] = '\0';
+
+	m_uiMemoryUsage += uiSize;
+
+	return pszResult;
+}
+
+const char* CStringArena::Add( const char* pszString )
+{
+	assert( pszString );
+
+	return Add( pszString, strlen( pszString ) );
+}
+
+void CStringArena::Clear()
+{
+	m_Blocks.clear();
+
+	m_pBlockPosition = nullptr;
+	m_uiBlockRemaining = 0;
+
+	m_uiMemoryUsage = 0;
+}
@@ -0,0 +1,70 @@
+#ifndef UTILITY_CSTRINGARENA_H
+#define UTILITY_CSTRINGARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+*	Append only storage for strings. Strings are packed into large blocks, so storing a string rarely allocates.
+*	Strings remain valid until the arena is cleared. Not thread safe.
+*/
+class CStringArena final
+{
+public:
+	/**
+	*	Size of the blocks that strings are allocated from. Long strings get a block of their own.
+	*/
+	static const size_t BLOCK_SIZE = 16 * 1024;
+
+private:
+	typedef std::vector<std::unique_ptr<char[]>> Blocks_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CStringArena() = default;
+
+	/**
+	*	Destructor.
+	*/
+	~CStringArena() = default;
+
+	/**
+	*	@return The number of bytes used by stored strings, including null terminators.
+	*/
+	size_t GetMemoryUsage() const { return m_uiMemoryUsage; }
+
+	/**
+	*	Stores a copy of a string.
+	*	@param pszString String to store. Does not need to be null terminated.
+	*	@param uiLength Length of the string.
+	*	@return The stored, null terminated string.
+	*/
+	const char* Add( const char* pszString, const size_t uiLength );
+
+	/**
+	*	Stores a copy of a null terminated string.
+	*/
+	const char* Add( const char* pszString );
+
+	/**
+	*	Frees all strings.
+	*/
+	void Clear();
+
+private:
+	Blocks_t m_Blocks;
+
+	char* m_pBlockPosition = nullptr;
+	size_t m_uiBlockRemaining = 0;
+
+	size_t m_uiMemoryUsage = 0;
+
+private:
+	CStringArena( const CStringArena& ) = delete;
+	CStringArena& operator=( const CStringArena& ) = delete;
+};
+
+#endif //UTILITY_CSTRINGARENA_H
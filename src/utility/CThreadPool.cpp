@@ -0,0 +1,75 @@
+#include "CProfiler.h"
+
+#include "CThreadPool.h"
+
+CThreadPool g_ThreadPool;
+
+bool CThreadPool::Initialize( size_t uiNumThreads )
+{
+	if( IsInitialized() )
+		return true;
+
+	if( uiNumThreads == 0 )
+		uiNumThreads = std::thread::hardware_concurrency();
+
+	//hardware_concurrency can return 0 if it can't be determined.
+	if( uiNumThreads == 0 )
+		uiNumThreads = 1;
+
+	m_bShutdown = false;
+
+	m_Threads.reserve( uiNumThreads );
+
+	for( size_t uiIndex = 0; uiIndex < uiNumThreads; ++uiIndex )
+	{
+		m_Threads.emplace_back( &CThreadPool::WorkerThread, this );
+	}
+
+	return true;
+}
+
+void CThreadPool::Shutdown()
+{
+	if( !IsInitialized() )
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock( m_Mutex );
+
+		m_bShutdown = true;
+	}
+
+	m_Condition.notify_all();
+
+	for( auto& thread : m_Threads )
+	{
+		thread.join();
+	}
+
+	m_Threads.clear();
+}
+
+void CThreadPool::WorkerThread()
+{
+	PROFILE_THREAD_NAME( "Worker" );
+
+	while( true )
+	{
+		Task_t task;
+
+		{
+			std::unique_lock<std::mutex> lock( m_Mutex );
+
+			m_Condition.wait( lock, [ this ]() { return m_bShutdown || !m_Tasks.empty(); } );
+
+			//Queued tasks are finished before shutting down.
+			if( m_Tasks.empty() )
+				return;
+
+			task = std::move( m_Tasks.front() );
+			m_Tasks.pop_front();
+		}
+
+		task();
+	}
+}
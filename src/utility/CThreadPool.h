@@ -0,0 +1,112 @@
+#ifndef UTILITY_CTHREADPOOL_H
+#define UTILITY_CTHREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+*	Fixed size pool of worker threads that execute queued tasks in the order they were queued.
+*/
+class CThreadPool final
+{
+private:
+	typedef std::function<void()> Task_t;
+
+public:
+	/**
+	*	Constructor.
+	*/
+	CThreadPool() = default;
+
+	/**
+	*	Destructor. Waits for all queued tasks to finish.
+	*/
+	~CThreadPool()
+	{
+		Shutdown();
+	}
+
+	/**
+	*	@return Whether the pool is initialized.
+	*/
+	bool IsInitialized() const { return !m_Threads.empty(); }
+
+	/**
+	*	@return The number of worker threads.
+	*/
+	size_t GetNumThreads() const { return m_Threads.size(); }
+
+	/**
+	*	Starts the worker threads.
+	*	@param uiNumThreads Number of threads to start. If 0, one thread is started for every hardware thread.
+	*	@return Whether initialization succeeded.
+	*/
+	bool Initialize( size_t uiNumThreads = 0 );
+
+	/**
+	*	Finishes all queued tasks and stops the worker threads.
+	*/
+	void Shutdown();
+
+	/**
+	*	Queues a task. If the pool isn't initialized, the task is executed immediately on the calling thread.
+	*	@param func Function to execute. Must be callable without arguments.
+	*	@return Future that receives the function's result.
+	*/
+	template<typename FUNC>
+	auto Enqueue( FUNC&& func ) -> std::future<decltype( func() )>
+	{
+		typedef decltype( func() ) Result_t;
+
+		//Tasks are copyable, packaged tasks aren't.
+		auto task = std::make_shared<std::packaged_task<Result_t()>>( std::forward<FUNC>( func ) );
+
+		auto future = task->get_future();
+
+		if( !IsInitialized() )
+		{
+			( *task )();
+			return future;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock( m_Mutex );
+
+			m_Tasks.emplace_back( [ task ]() { ( *task )(); } );
+		}
+
+		m_Condition.notify_one();
+
+		return future;
+	}
+
+private:
+	void WorkerThread();
+
+private:
+	std::vector<std::thread> m_Threads;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+
+	std::deque<Task_t> m_Tasks;
+
+	bool m_bShutdown = false;
+
+private:
+	CThreadPool( const CThreadPool& ) = delete;
+	CThreadPool& operator=( const CThreadPool& ) = delete;
+};
+
+/**
+*	Pool used for CPU bound work. I/O has its own threads, see CAsyncFileReader.
+*/
+extern CThreadPool g_ThreadPool;
+
+#endif //UTILITY_CTHREADPOOL_H
@@ -0,0 +1,231 @@
+#include <cstdint>
+
+#include "CTokenizer.h"
+
+#if defined( __AVX2__ )
+#define TOKENIZER_SIMD
+#include <immintrin.h>
+#elif defined( _M_X64 ) || defined( _M_AMD64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+#define TOKENIZER_SIMD
+#include <emmintrin.h>
+#endif
+
+#if defined( TOKENIZER_SIMD ) && defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+/**
+*	COM_Parse stores characters in an int, so characters >= 0x80 are negative and count as whitespace.
+*/
+static inline bool IsWhitespace( const char c )
+{
+	return static_cast<signed char>( c ) <= ' ';
+}
+
+static inline bool IsSingleCharToken( const char c )
+{
+	return c == '{' || c == '}' || c == ')' || c == '(' || c == '\'' || c == ',';
+}
+
+#ifdef TOKENIZER_SIMD
+
+#if defined( __AVX2__ )
+typedef __m256i Block_t;
+
+static const size_t BLOCK_SIZE = 32;
+static const uint32_t BLOCK_MASK = 0xFFFFFFFFU;
+
+static inline Block_t LoadBlock( const char* pData ) { return _mm256_load_si256( reinterpret_cast<const Block_t*>( pData ) ); }
+static inline Block_t Splat( const char c ) { return _mm256_set1_epi8( c ); }
+static inline Block_t CmpEq( const Block_t lhs, const Block_t rhs ) { return _mm256_cmpeq_epi8( lhs, rhs ); }
+static inline Block_t CmpGt( const Block_t lhs, const Block_t rhs ) { return _mm256_cmpgt_epi8( lhs, rhs ); }
+static inline Block_t Or( const Block_t lhs, const Block_t rhs ) { return _mm256_or_si256( lhs, rhs ); }
+static inline uint32_t MoveMask( const Block_t block ) { return static_cast<uint32_t>( _mm256_movemask_epi8( block ) ); }
+#else
+typedef __m128i Block_t;
+
+static const size_t BLOCK_SIZE = 16;
+static const uint32_t BLOCK_MASK = 0xFFFFU;
+
+static inline Block_t LoadBlock( const char* pData ) { return _mm_load_si128( reinterpret_cast<const Block_t*>( pData ) ); }
+static inline Block_t Splat( const char c ) { return _mm_set1_epi8( c ); }
+static inline Block_t CmpEq( const Block_t lhs, const Block_t rhs ) { return _mm_cmpeq_epi8( lhs, rhs ); }
+static inline Block_t CmpGt( const Block_t lhs, const Block_t rhs ) { return _mm_cmpgt_epi8( lhs, rhs ); }
+static inline Block_t Or( const Block_t lhs, const Block_t rhs ) { return _mm_or_si128( lhs, rhs ); }
+static inline uint32_t MoveMask( const Block_t block ) { return static_cast<uint32_t>( _mm_movemask_epi8( block ) ); }
+#endif
+
+static inline size_t FindFirstSetBit( const uint32_t uiMask )
+{
+#ifdef _MSC_VER
+	unsigned long ulIndex;
+	_BitScanForward( &ulIndex, uiMask );
+	return ulIndex;
+#else
+	return static_cast<size_t>( __builtin_ctz( uiMask ) );
+#endif
+}
+
+/**
+*	Finds the first character for which getMask sets a bit. getMask must always set the bit for the null terminator.
+*	Loads are aligned to the block size, so a block never crosses a page boundary and reading the rest of the block
+*	that contains the null terminator can't fault.
+*/
+template<typename GETMASK>
+static inline const char* FindFirst( const char* pszData, const GETMASK& getMask )
+{
+	const size_t uiOffset = reinterpret_cast<uintptr_t>( pszData ) & ( BLOCK_SIZE - 1 );
+
+	const char* pBlock = pszData - uiOffset;
+
+	//Ignore the characters in front of the start position.
+	uint32_t uiMask = getMask( LoadBlock( pBlock ) ) >> uiOffset;
+
+	if( uiMask )
+		return pszData + FindFirstSetBit( uiMask );
+
+	while( true )
+	{
+		pBlock += BLOCK_SIZE;
+
+		uiMask = getMask( LoadBlock( pBlock ) );
+
+		if( uiMask )
+			return pBlock + FindFirstSetBit( uiMask );
+	}
+}
+
+/**
+*	@return Mask of characters that are not whitespace. Like COM_Parse this uses a signed comparison.
+*/
+static inline uint32_t NonWhitespaceMask( const Block_t block )
+{
+	return MoveMask( CmpGt( block, Splat( ' ' ) ) );
+}
+
+static const char* SkipWhitespace( const char* pszData )
+{
+	return FindFirst( pszData, []( const Block_t block )
+	{
+		return NonWhitespaceMask( block ) | MoveMask( CmpEq( block, Splat( '\0' ) ) );
+	} );
+}
+
+static const char* FindQuoteEnd( const char* pszData )
+{
+	return FindFirst( pszData, []( const Block_t block )
+	{
+		return MoveMask( Or( CmpEq( block, Splat( '\"' ) ), CmpEq( block, Splat( '\0' ) ) ) );
+	} );
+}
+
+static const char* FindWordEnd( const char* pszData )
+{
+	return FindFirst( pszData, []( const Block_t block )
+	{
+		//The null terminator counts as whitespace.
+		const uint32_t uiWhitespace = NonWhitespaceMask( block ) ^ BLOCK_MASK;
+
+		const Block_t singles =
+			Or( Or( CmpEq( block, Splat( '{' ) ), CmpEq( block, Splat( '}' ) ) ),
+				Or( Or( CmpEq( block, Splat( '(' ) ), CmpEq( block, Splat( ')' ) ) ),
+					Or( CmpEq( block, Splat( '\'' ) ), CmpEq( block, Splat( ',' ) ) ) ) );
+
+		return uiWhitespace | MoveMask( singles );
+	} );
+}
+
+#else
+
+static const char* SkipWhitespace( const char* pszData )
+{
+	while( *pszData && IsWhitespace( *pszData ) )
+		++pszData;
+
+	return pszData;
+}
+
+static const char* FindQuoteEnd( const char* pszData )
+{
+	while( *pszData && *pszData != '\"' )
+		++pszData;
+
+	return pszData;
+}
+
+static const char* FindWordEnd( const char* pszData )
+{
+	while( !IsWhitespace( *pszData ) && !IsSingleCharToken( *pszData ) )
+		++pszData;
+
+	return pszData;
+}
+
+#endif
+
+CTokenizer::CTokenizer( const char* pszData )
+	: m_pszPosition( pszData ? pszData : "" )
+{
+}
+
+bool CTokenizer::Next( CStringView& token )
+{
+	token = CStringView();
+
+	const char* pszData = m_pszPosition;
+
+	while( true )
+	{
+		pszData = SkipWhitespace( pszData );
+
+		if( !( *pszData ) )
+		{
+			m_pszPosition = pszData;
+			return false;
+		}
+
+		// skip // comments
+		if( pszData[ 0 ] == '/' && pszData[ 1 ] == '/' )
+		{
+			while( *pszData && *pszData != '\n' )
+				++pszData;
+
+			continue;
+		}
+
+		break;
+	}
+
+	const char c = *pszData;
+
+	// handle quoted strings specially
+	if( c == '\"' )
+	{
+		const char* pszStart = pszData + 1;
+		const char* pszEnd = FindQuoteEnd( pszStart );
+
+		token = CStringView( pszStart, pszEnd - pszStart );
+
+		//COM_Parse also skips past the null terminator of an unterminated string; stop at it instead.
+		m_pszPosition = *pszEnd ? pszEnd + 1 : pszEnd;
+
+		return true;
+	}
+
+	// parse single characters
+	if( IsSingleCharToken( c ) )
+	{
+		token = CStringView( pszData, 1 );
+		m_pszPosition = pszData + 1;
+
+		return true;
+	}
+
+	// parse a regular word
+	const char* pszEnd = FindWordEnd( pszData + 1 );
+
+	token = CStringView( pszData, pszEnd - pszData );
+	m_pszPosition = pszEnd;
+
+	return true;
+}
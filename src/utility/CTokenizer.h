@@ -0,0 +1,55 @@
+#ifndef UTILITY_CTOKENIZER_H
+#define UTILITY_CTOKENIZER_H
+
+#include "common/CStringView.h"
+
+/**
+*	Splits a null terminated buffer into tokens without copying them.
+*	Tokens are views into the source buffer, so the buffer must outlive them. Each tokenizer keeps its own position,
+*	so multiple buffers can be tokenized at the same time, from any thread.
+*	Produces exactly the same tokens as COM_Parse:
+*	Characters <= ' ', including characters >= 0x80, are whitespace. // comments run to the end of the line.
+*	Quoted strings run until the next quote or the end of the buffer. { } ( ) ' and , are tokens by themselves.
+*	Whitespace skipping, quote searching and word scanning are done 16 (SSE2) or 32 (AVX2) bytes at a time.
+*/
+class CTokenizer final
+{
+public:
+	/**
+	*	Constructor.
+	*	@param pszData Null terminated buffer to tokenize.
+	*/
+	CTokenizer( const char* pszData );
+
+	/**
+	*	Destructor.
+	*/
+	~CTokenizer() = default;
+
+	/**
+	*	@return The current position in the buffer. This is where the next token will be searched for.
+	*	Equivalent to the pointer returned by COM_Parse.
+	*/
+	const char* GetPosition() const { return m_pszPosition; }
+
+	/**
+	*	@return Whether the end of the buffer has been reached.
+	*/
+	bool IsAtEnd() const { return *m_pszPosition == '\0'; }
+
+	/**
+	*	Parses the next token.
+	*	@param token Token. Empty if there are no more tokens.
+	*	@return Whether a token was parsed. False if the end of the buffer was reached.
+	*/
+	bool Next( CStringView& token );
+
+private:
+	const char* m_pszPosition;
+
+private:
+	CTokenizer( const CTokenizer& ) = delete;
+	CTokenizer& operator=( const CTokenizer& ) = delete;
+};
+
+#endif //UTILITY_CTOKENIZER_H
@@ -0,0 +1,243 @@
+#include <cstdint>
+#include <cstring>
+
+#include "LZ4.h"
+
+/**
+*	Minimum length of a match.
+*/
+static const size_t LZ4_MIN_MATCH = 4;
+
+/**
+*	The last match must start at least this many bytes before the end of the block.
+*/
+static const size_t LZ4_MF_LIMIT = 12;
+
+/**
+*	The last this many bytes of a block are always literals.
+*/
+static const size_t LZ4_LAST_LITERALS = 5;
+
+/**
+*	Largest offset that can be encoded.
+*/
+static const size_t LZ4_MAX_DISTANCE = 65535;
+
+static const size_t LZ4_HASH_BITS = 12;
+
+static inline uint32_t LZ4_Read32( const byte* pData )
+{
+	uint32_t uiValue;
+
+	memcpy( &uiValue, pData, sizeof( uiValue ) );
+
+	return uiValue;
+}
+
+static inline uint32_t LZ4_Hash( const uint32_t uiSequence )
+{
+	return ( uiSequence * 2654435761U ) >> ( 32 - LZ4_HASH_BITS );
+}
+
+/**
+*	Writes a length that didn't fit in the token.
+*/
+static inline bool LZ4_WriteLength( size_t uiLength, byte*& pOut, const byte* pOutEnd )
+{
+	while( uiLength >= 255 )
+	{
+		if( pOut >= pOutEnd )
+			return false;
+
+		*pOut++ = 255;
+		uiLength -= 255;
+	}
+
+	if( pOut >= pOutEnd )
+		return false;
+
+	*pOut++ = static_cast<byte>( uiLength );
+
+	return true;
+}
+
+static inline bool LZ4_ReadLength( size_t& uiLength, const byte*& pIn, const byte* pInEnd )
+{
+	byte value;
+
+	do
+	{
+		if( pIn >= pInEnd )
+			return false;
+
+		value = *pIn++;
+		uiLength += value;
+	}
+	while( value == 255 );
+
+	return true;
+}
+
+/**
+*	Writes a sequence: a token, literals, and if this isn't the last sequence, a match.
+*	@param uiMatchLength Length of the match, or 0 for the last sequence.
+*/
+static bool LZ4_WriteSequence( const byte* pLiterals, const size_t uiLiteralLength, const size_t uiOffset, const size_t uiMatchLength, 
+							   byte*& pOut, const byte* pOutEnd )
+{
+	if( pOut >= pOutEnd )
+		return false;
+
+	byte* pToken = pOut++;
+
+	*pToken = static_cast<byte>( ( uiLiteralLength >= 15 ? 15 : uiLiteralLength ) << 4 );
+
+	if( uiLiteralLength >= 15 && !LZ4_WriteLength( uiLiteralLength - 15, pOut, pOutEnd ) )
+		return false;
+
+	if( static_cast<size_t>( pOutEnd - pOut ) < uiLiteralLength )
+		return false;
+
+	if( uiLiteralLength )
+	{
+		memcpy( pOut, pLiterals, uiLiteralLength );
+		pOut += uiLiteralLength;
+	}
+
+	if( !uiMatchLength )
+		return true;
+
+	if( pOutEnd - pOut < 2 )
+		return false;
+
+	*pOut++ = static_cast<byte>( uiOffset & 0xFF );
+	*pOut++ = static_cast<byte>( ( uiOffset >> 8 ) & 0xFF );
+
+	const size_t uiLength = uiMatchLength - LZ4_MIN_MATCH;
+
+	*pToken |= static_cast<byte>( uiLength >= 15 ? 15 : uiLength );
+
+	if( uiLength >= 15 && !LZ4_WriteLength( uiLength - 15, pOut, pOutEnd ) )
+		return false;
+
+	return true;
+}
+
+size_t LZ4_CompressBound( const size_t uiSize )
+{
+	return uiSize + ( uiSize / 255 ) + 16;
+}
+
+size_t LZ4_Compress( const byte* pSource, const size_t uiSourceSize, byte* pDest, const size_t uiDestSize )
+{
+	byte* pOut = pDest;
+	const byte* const pOutEnd = pDest + uiDestSize;
+
+	size_t uiAnchor = 0;
+
+	if( uiSourceSize > LZ4_MF_LIMIT )
+	{
+		//Positions are stored + 1 so 0 means empty.
+		uint32_t table[ 1 << LZ4_HASH_BITS ] = {};
+
+		const size_t uiMatchLimit = uiSourceSize - LZ4_LAST_LITERALS;
+
+		size_t uiPos = 0;
+
+		while( uiPos < uiSourceSize - LZ4_MF_LIMIT )
+		{
+			const uint32_t uiSequence = LZ4_Read32( pSource + uiPos );
+			const uint32_t uiHash = LZ4_Hash( uiSequence );
+
+			const size_t uiCandidate = table[ uiHash ];
+
+			table[ uiHash ] = static_cast<uint32_t>( uiPos + 1 );
+
+			if( !uiCandidate || 
+				uiPos - ( uiCandidate - 1 ) > LZ4_MAX_DISTANCE || 
+				LZ4_Read32( pSource + uiCandidate - 1 ) != uiSequence )
+			{
+				++uiPos;
+				continue;
+			}
+
+			const size_t uiMatch = uiCandidate - 1;
+
+			size_t uiLength = LZ4_MIN_MATCH;
+
+			while( uiPos + uiLength < uiMatchLimit && pSource[ uiPos + uiLength ] == pSource[ uiMatch + uiLength ] )
+				++uiLength;
+
+			if( !LZ4_WriteSequence( pSource + uiAnchor, uiPos - uiAnchor, uiPos - uiMatch, uiLength, pOut, pOutEnd ) )
+				return 0;
+
+			uiPos += uiLength;
+			uiAnchor = uiPos;
+		}
+	}
+
+	if( !LZ4_WriteSequence( pSource + uiAnchor, uiSourceSize - uiAnchor, 0, 0, pOut, pOutEnd ) )
+		return 0;
+
+	return pOut - pDest;
+}
+
+bool LZ4_Decompress( const byte* pSource, const size_t uiSourceSize, byte* pDest, const size_t uiDestSize )
+{
+	const byte* pIn = pSource;
+	const byte* const pInEnd = pSource + uiSourceSize;
+
+	byte* pOut = pDest;
+	byte* const pOutEnd = pDest + uiDestSize;
+
+	while( pIn < pInEnd )
+	{
+		const byte token = *pIn++;
+
+		size_t uiLiteralLength = token >> 4;
+
+		if( uiLiteralLength == 15 && !LZ4_ReadLength( uiLiteralLength, pIn, pInEnd ) )
+			return false;
+
+		if( static_cast<size_t>( pInEnd - pIn ) < uiLiteralLength || static_cast<size_t>( pOutEnd - pOut ) < uiLiteralLength )
+			return false;
+
+		memcpy( pOut, pIn, uiLiteralLength );
+		pIn += uiLiteralLength;
+		pOut += uiLiteralLength;
+
+		//The last sequence has no match.
+		if( pIn == pInEnd )
+			break;
+
+		if( pInEnd - pIn < 2 )
+			return false;
+
+		const size_t uiOffset = pIn[ 0 ] | ( pIn[ 1 ] << 8 );
+
+		pIn += 2;
+
+		if( uiOffset == 0 || uiOffset > static_cast<size_t>( pOut - pDest ) )
+			return false;
+
+		size_t uiMatchLength = token & 0xF;
+
+		if( uiMatchLength == 15 && !LZ4_ReadLength( uiMatchLength, pIn, pInEnd ) )
+			return false;
+
+		uiMatchLength += LZ4_MIN_MATCH;
+
+		if( static_cast<size_t>( pOutEnd - pOut ) < uiMatchLength )
+			return false;
+
+		//Matches can overlap the output, so copy one byte at a time.
+		const byte* pMatch = pOut - uiOffset;
+
+		for( size_t uiIndex = 0; uiIndex < uiMatchLength; ++uiIndex )
+		{
+			*pOut++ = *pMatch++;
+		}
+	}
+
+	return pOut == pOutEnd;
+}
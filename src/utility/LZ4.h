@@ -0,0 +1,43 @@
+#ifndef UTILITY_LZ4_H
+#define UTILITY_LZ4_H
+
+#include <cstddef>
+
+#include "common/Const.h"
+
+/**
+*	@defgroup LZ4 LZ4 block compression
+*
+*	Minimal implementation of the LZ4 block format. Output is compatible with other LZ4 block decoders.
+*
+*	@{
+*/
+
+/**
+*	@return The maximum compressed size of data of the given size.
+*/
+size_t LZ4_CompressBound( const size_t uiSize );
+
+/**
+*	Compresses a block of data.
+*	@param pSource Data to compress.
+*	@param uiSourceSize Size of the data in bytes.
+*	@param pDest Buffer that receives the compressed data.
+*	@param uiDestSize Size of the buffer in bytes.
+*	@return Compressed size in bytes, or 0 if the compressed data didn't fit in the buffer.
+*/
+size_t LZ4_Compress( const byte* pSource, const size_t uiSourceSize, byte* pDest, const size_t uiDestSize );
+
+/**
+*	Decompresses a block of data. The data is validated so malformed input can't write outside the buffer.
+*	@param pSource Compressed data.
+*	@param uiSourceSize Size of the compressed data in bytes.
+*	@param pDest Buffer that receives the decompressed data.
+*	@param uiDestSize Exact size of the decompressed data in bytes.
+*	@return Whether the data was decompressed and had the expected size.
+*/
+bool LZ4_Decompress( const byte* pSource, const size_t uiSourceSize, byte* pDest, const size_t uiDestSize );
+
+/** @} */
+
+#endif //UTILITY_LZ4_H
@@ -0,0 +1,160 @@
+#include <cstdint>
+#include <cstdlib>
+
+#include "StringToNumber.h"
+
+/**
+*	Powers of ten that can be represented exactly as a double.
+*/
+static const double POWERS_OF_TEN[] =
+{
+	1e0,	1e1,	1e2,	1e3,	1e4,	1e5,	1e6,	1e7,
+	1e8,	1e9,	1e10,	1e11,	1e12,	1e13,	1e14,	1e15,
+	1e16,	1e17,	1e18,	1e19,	1e20,	1e21,	1e22
+};
+
+static const int MAX_EXACT_POWER = 22;
+
+static const int MAX_MANTISSA_DIGITS = 19;
+
+/**
+*	Largest mantissa that can be represented exactly as a double.
+*/
+static const uint64_t MAX_EXACT_MANTISSA = 1ULL << 53;
+
+static inline bool IsDigit( const char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline bool IsSpace( const char c )
+{
+	return c == ' ' || ( c >= '\t' && c <= '\r' );
+}
+
+static const char* ParseDoubleSlow( const char* pszFirst, double& flValue )
+{
+	char* pszEnd;
+
+	flValue = strtod( pszFirst, &pszEnd );
+
+	return pszEnd;
+}
+
+const char* ParseDouble( const char* pszFirst, double& flValue )
+{
+	const char* pszNext = pszFirst;
+
+	while( IsSpace( *pszNext ) )
+		++pszNext;
+
+	bool bNegative = false;
+
+	if( *pszNext == '-' || *pszNext == '+' )
+	{
+		bNegative = *pszNext == '-';
+		++pszNext;
+	}
+
+	//Hexadecimal numbers, infinity and NaN.
+	if( !IsDigit( *pszNext ) && *pszNext != '.' )
+		return ParseDoubleSlow( pszFirst, flValue );
+
+	if( pszNext[ 0 ] == '0' && ( pszNext[ 1 ] == 'x' || pszNext[ 1 ] == 'X' ) )
+		return ParseDoubleSlow( pszFirst, flValue );
+
+	uint64_t uiMantissa = 0;
+	int iNumDigits = 0;
+	int iExponent = 0;
+	bool bHasDigits = false;
+
+	for( ; IsDigit( *pszNext ); ++pszNext )
+	{
+		bHasDigits = true;
+
+		//Leading zeros aren't significant.
+		if( uiMantissa || *pszNext != '0' )
+		{
+			uiMantissa = uiMantissa * 10 + ( *pszNext - '0' );
+			++iNumDigits;
+		}
+	}
+
+	if( *pszNext == '.' )
+	{
+		++pszNext;
+
+		for( ; IsDigit( *pszNext ); ++pszNext )
+		{
+			bHasDigits = true;
+
+			if( uiMantissa || *pszNext != '0' )
+			{
+				uiMantissa = uiMantissa * 10 + ( *pszNext - '0' );
+				++iNumDigits;
+			}
+
+			--iExponent;
+		}
+	}
+
+	if( !bHasDigits )
+	{
+		flValue = 0;
+		return pszFirst;
+	}
+
+	//The mantissa overflowed.
+	if( iNumDigits > MAX_MANTISSA_DIGITS )
+		return ParseDoubleSlow( pszFirst, flValue );
+
+	//The exponent is only consumed if it has at least one digit.
+	if( *pszNext == 'e' || *pszNext == 'E' )
+	{
+		const char* pszExponent = pszNext + 1;
+
+		bool bNegativeExponent = false;
+
+		if( *pszExponent == '-' || *pszExponent == '+' )
+		{
+			bNegativeExponent = *pszExponent == '-';
+			++pszExponent;
+		}
+
+		if( IsDigit( *pszExponent ) )
+		{
+			int iExplicitExponent = 0;
+
+			for( ; IsDigit( *pszExponent ); ++pszExponent )
+			{
+				if( iExplicitExponent < 100000 )
+					iExplicitExponent = iExplicitExponent * 10 + ( *pszExponent - '0' );
+			}
+
+			iExponent += bNegativeExponent ? -iExplicitExponent : iExplicitExponent;
+
+			pszNext = pszExponent;
+		}
+	}
+
+	double flResult;
+
+	if( uiMantissa == 0 )
+		flResult = 0;
+	else if( uiMantissa <= MAX_EXACT_MANTISSA && iExponent >= -MAX_EXACT_POWER && iExponent <= MAX_EXACT_POWER )
+	{
+		//Both operands are exact, so the result is correctly rounded.
+		flResult = static_cast<double>( uiMantissa );
+
+		if( iExponent < 0 )
+			flResult /= POWERS_OF_TEN[ -iExponent ];
+		else
+			flResult *= POWERS_OF_TEN[ iExponent ];
+	}
+	else
+		return ParseDoubleSlow( pszFirst, flValue );
+
+	flValue = bNegative ? -flResult : flResult;
+
+	return pszNext;
+}
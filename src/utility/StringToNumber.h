@@ -0,0 +1,28 @@
+#ifndef UTILITY_STRINGTONUMBER_H
+#define UTILITY_STRINGTONUMBER_H
+
+/**
+*	Parses a decimal floating point number. Produces the same result as strtod, but common inputs are converted without calling into the CRT.
+*	Numbers with up to 19 significant digits and a decimal exponent of at most 22 are converted exactly with a multiplication or division;
+*	everything else is handed to strtod.
+*	@param pszFirst String to parse. Leading whitespace is skipped.
+*	@param flValue Parsed value, or 0 if no number could be parsed.
+*	@return Pointer to the first character after the number, or pszFirst if no number could be parsed.
+*/
+const char* ParseDouble( const char* pszFirst, double& flValue );
+
+/**
+*	Parses a decimal floating point number. Same as ParseDouble, but the result is converted to a float.
+*/
+inline const char* ParseFloat( const char* pszFirst, float& flValue )
+{
+	double flResult;
+
+	const char* pszEnd = ParseDouble( pszFirst, flResult );
+
+	flValue = static_cast<float>( flResult );
+
+	return pszEnd;
+}
+
+#endif //UTILITY_STRINGTONUMBER_H
@@ -8,6 +8,8 @@
 #include "core/Platform.h"
 #include "common/Const.h"
 
+#include "filesystem/CFileData.h"
+
 #include "WadFile.h"
 
 /**
@@ -19,11 +21,12 @@ public:
 	/**
 	*	Constructor.
 	*	@param pszFilename Name of the wad. Excluding path and extension.
-	*	@param pWad Wad to take ownership of. The wad will be freed unless ownership is released by calling Release.
-	*	@see Release
+	*	@param data Wad data to take ownership of. Must have been loaded by LoadWadFile.
+	*	@see LoadWadFile
 	*/
-	CWadFile( const char* const pszFilename, wadinfo_t* pWad )
-		: m_pWad( pWad )
+	CWadFile( const char* const pszFilename, CFileData&& data )
+		: m_Data( std::move( data ) )
+		, m_pWad( reinterpret_cast<wadinfo_t*>( m_Data.GetData() ) )
 	{
 		strncpy( m_szFilename, pszFilename, sizeof( m_szFilename ) );
 
@@ -33,10 +36,7 @@ public:
 	/**
 	*	Destructor.
 	*/
-	~CWadFile()
-	{
-		delete[] m_pWad;
-	}
+	~CWadFile() = default;
 
 	/**
 	*	@return Whether this wad file is still valid.
@@ -53,19 +53,53 @@ public:
 	*/
 	const wadinfo_t* Get() const { return m_pWad; }
 
+	/**
+	*	@return Size of the wad in bytes.
+	*/
+	size_t GetSize() const { return m_Data.GetSize(); }
+
+	/**
+	*	@return Number of maps that are currently using this wad.
+	*/
+	size_t GetRefCount() const { return m_uiRefCount; }
+
+	/**
+	*	@return Value of the wad manager's use counter when this wad was last referenced. Used to evict the least recently used wads first.
+	*/
+	size_t GetLastUsed() const { return m_uiLastUsed; }
+
+	/**
+	*	Adds a reference to this wad.
+	*	@param uiUseCounter Current value of the wad manager's use counter.
+	*/
+	void AddReference( const size_t uiUseCounter )
+	{
+		++m_uiRefCount;
+		m_uiLastUsed = uiUseCounter;
+	}
+
+	/**
+	*	Removes a reference from this wad.
+	*/
+	void RemoveReference()
+	{
+		assert( m_uiRefCount > 0 );
+
+		if( m_uiRefCount > 0 )
+			--m_uiRefCount;
+	}
+
 	/**
 	*	Releases ownership of the wad file.
-	*	@return The wad file, or nullptr if ownership was already released.
+	*	@return The wad data, or invalid data if ownership was already released.
 	*/
-	wadinfo_t* Release()
+	CFileData Release()
 	{
 		memset( m_szFilename, 0, sizeof( m_szFilename ) );
 
-		wadinfo_t* pWad = m_pWad;
-
 		m_pWad = nullptr;
 
-		return pWad;
+		return std::move( m_Data );
 	}
 
 	/**
@@ -149,8 +183,12 @@ public:
 
 private:
 	char m_szFilename[ MAX_PATH_LENGTH ];
+	CFileData m_Data;
 	wadinfo_t* m_pWad;
 
+	size_t m_uiRefCount = 0;
+	size_t m_uiLastUsed = 0;
+
 private:
 	CWadFile( const CWadFile& ) = delete;
 	CWadFile& operator=( const CWadFile& ) = delete;
@@ -2,6 +2,10 @@
 #include <cassert>
 #include <cstdio>
 
+#include "utility/CLogger.h"
+
+#include "filesystem/CAsyncFileReader.h"
+
 #include "CWadFile.h"
 #include "WadIO.h"
 
@@ -14,18 +18,6 @@ CWadManager::~CWadManager()
 	Clear();
 }
 
-void CWadManager::SetBasePath( const char* const pszBasePath )
-{
-	assert( pszBasePath );
-
-	if( !pszBasePath )
-		return;
-
-	strncpy( m_szBasePath, pszBasePath, sizeof( m_szBasePath ) );
-
-	m_szBasePath[ sizeof( m_szBasePath ) -1 ] = '\0';
-}
-
 const CWadFile* CWadManager::FindWadByName( const char* const pszWadName ) const
 {
 	assert( pszWadName );
@@ -43,19 +35,31 @@ const CWadFile* CWadManager::FindWadByName( const char* const pszWadName ) const
 	return it != m_WadFiles.end() ? it->get() : nullptr;
 }
 
-const miptex_t* CWadManager::FindTextureByName( const char* const pszTextureName ) const
+const miptex_t* CWadManager::FindTextureByName( const char* const pszTextureName, const CWadFile** ppWad ) const
 {
 	assert( pszTextureName );
 
+	if( ppWad )
+		*ppWad = nullptr;
+
 	if( !pszTextureName )
 		return nullptr;
 
 	for( const auto& wad : m_WadFiles )
 	{
+		//Cached wads that the current map doesn't use shouldn't provide textures.
+		if( !wad->GetRefCount() )
+			continue;
+
 		if( auto pLump = wad->GetLumpByName( pszTextureName, TYP_LUMPY + TYP_LUMPY_MIPTEX ) )
 		{
 			if( auto pTexture = reinterpret_cast<const miptex_t*>( wad->GetLumpData( pLump ) ) )
+			{
+				if( ppWad )
+					*ppWad = wad.get();
+
 				return pTexture;
+			}
 		}
 	}
 
@@ -69,31 +73,174 @@ CWadManager::AddResult CWadManager::AddWad( const char* const pszWadName )
 	if( !pszWadName || !( *pszWadName ) )
 		return AddResult::INVALID_NAME;
 
-	if( FindWadByName( pszWadName ) )
-		return AddResult::ALREADY_ADDED;
+	//Const cast is safe here, the wads are owned by this manager.
+	if( auto pWad = const_cast<CWadFile*>( FindWadByName( pszWadName ) ) )
+		return ReferenceWad( *pWad );
 
 	char szPath[ MAX_PATH_LENGTH ];
 
-	const int iResult = snprintf( szPath, sizeof( szPath ), "%s/%s%s", m_szBasePath, pszWadName, WAD_FILE_EXT );
-
-	if( iResult < 0 || static_cast<size_t>( iResult ) >= sizeof( szPath ) )
+	if( !GetWadPath( pszWadName, szPath, sizeof( szPath ) ) )
 		return AddResult::INVALID_NAME;
 
-	auto pWad = LoadWadFile( szPath );
+	CFileData wadData;
+
+	auto pending = std::find_if( m_PendingWads.begin(), m_PendingWads.end(),
+	[ = ]( const auto& wad )
+	{
+		return strcasecmp( pszWadName, wad.first.c_str() ) == 0;
+	}
+	);
+
+	if( pending != m_PendingWads.end() )
+	{
+		//Wait for the prefetch to finish.
+		auto future = std::move( pending->second );
+
+		m_PendingWads.erase( pending );
+
+		wadData = LoadWadFile( szPath, future.get() );
+	}
+	else
+	{
+		wadData = LoadWadFile( szPath );
+	}
 
 	//TODO: could've been an I/O error - Solokiller
-	if( !pWad )
+	if( !wadData.IsValid() )
 		return AddResult::FILE_NOT_FOUND;
 
-	m_WadFiles.emplace_back( std::make_unique<CWadFile>( pszWadName, pWad ) );
+	return AddLoadedWad( pszWadName, std::move( wadData ) );
+}
 
-	printf( "Using wad file \"%s%s\"\n", pszWadName, WAD_FILE_EXT );
+CWadManager::AddResult CWadManager::AddWad( const char* const pszWadName, CFileData&& data )
+{
+	assert( pszWadName );
 
-	return AddResult::SUCCESS;
+	if( !pszWadName || !( *pszWadName ) )
+		return AddResult::INVALID_NAME;
+
+	if( auto pWad = const_cast<CWadFile*>( FindWadByName( pszWadName ) ) )
+		return ReferenceWad( *pWad );
+
+	CFileData wadData = LoadWadFile( pszWadName, std::move( data ) );
+
+	if( !wadData.IsValid() )
+		return AddResult::FILE_NOT_FOUND;
+
+	return AddLoadedWad( pszWadName, std::move( wadData ) );
+}
+
+void CWadManager::PrefetchWads( const std::vector<std::string>& wadNames )
+{
+	char szPath[ MAX_PATH_LENGTH ];
+
+	for( const auto& szWadName : wadNames )
+	{
+		if( szWadName.empty() || FindWadByName( szWadName.c_str() ) )
+			continue;
+
+		auto it = std::find_if( m_PendingWads.begin(), m_PendingWads.end(),
+		[ & ]( const auto& wad )
+		{
+			return strcasecmp( szWadName.c_str(), wad.first.c_str() ) == 0;
+		}
+		);
+
+		if( it != m_PendingWads.end() )
+			continue;
+
+		if( !GetWadPath( szWadName.c_str(), szPath, sizeof( szPath ) ) )
+			continue;
+
+		m_PendingWads.emplace_back( szWadName, g_AsyncFileReader.Read( szPath ) );
+	}
+}
+
+void CWadManager::ReleaseWads()
+{
+	//Wads that were prefetched but never added aren't needed anymore.
+	m_PendingWads.clear();
+
+	for( auto& wad : m_WadFiles )
+	{
+		if( wad->GetRefCount() )
+			wad->RemoveReference();
+	}
+}
+
+size_t CWadManager::GetMemoryUsage() const
+{
+	size_t uiUsage = 0;
+
+	for( const auto& wad : m_WadFiles )
+	{
+		uiUsage += wad->GetSize();
+	}
+
+	return uiUsage;
+}
+
+void CWadManager::Trim()
+{
+	size_t uiUsage = GetMemoryUsage();
+
+	while( uiUsage > m_uiMemoryBudget )
+	{
+		auto oldest = m_WadFiles.end();
+
+		for( auto it = m_WadFiles.begin(); it != m_WadFiles.end(); ++it )
+		{
+			if( ( *it )->GetRefCount() )
+				continue;
+
+			if( oldest == m_WadFiles.end() || ( *it )->GetLastUsed() < ( *oldest )->GetLastUsed() )
+				oldest = it;
+		}
+
+		//Everything that's left is in use.
+		if( oldest == m_WadFiles.end() )
+			break;
+
+		uiUsage -= ( *oldest )->GetSize();
+
+		m_WadFiles.erase( oldest );
+	}
 }
 
 void CWadManager::Clear()
 {
+	m_PendingWads.clear();
+
 	m_WadFiles.clear();
 	m_WadFiles.shrink_to_fit();
+}
+
+bool CWadManager::GetWadPath( const char* const pszWadName, char* pszPath, const size_t uiBufferSize )
+{
+	const int iResult = snprintf( pszPath, uiBufferSize, "%s%s", pszWadName, WAD_FILE_EXT );
+
+	return iResult >= 0 && static_cast<size_t>( iResult ) < uiBufferSize;
+}
+
+CWadManager::AddResult CWadManager::ReferenceWad( CWadFile& wad )
+{
+	if( wad.GetRefCount() )
+		return AddResult::ALREADY_ADDED;
+
+	wad.AddReference( ++m_uiUseCounter );
+
+	g_Logger.Info( LogCategory::WAD, "Using cached wad file \"%s%s\"\n", wad.GetFilename(), WAD_FILE_EXT );
+
+	return AddResult::SUCCESS;
+}
+
+CWadManager::AddResult CWadManager::AddLoadedWad( const char* const pszWadName, CFileData&& wadData )
+{
+	m_WadFiles.emplace_back( std::make_unique<CWadFile>( pszWadName, std::move( wadData ) ) );
+
+	m_WadFiles.back()->AddReference( ++m_uiUseCounter );
+
+	g_Logger.Info( LogCategory::WAD, "Using wad file \"%s%s\"\n", pszWadName, WAD_FILE_EXT );
+
+	return AddResult::SUCCESS;
 }
\ No newline at end of file
@@ -1,20 +1,32 @@
 #ifndef WAD_CWADMANAGER_H
 #define WAD_CWADMANAGER_H
 
+#include <future>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "core/Platform.h"
 
+#include "filesystem/CFileData.h"
+
 class CWadFile;
 struct miptex_t;
 
 /**
-*	Manages the list of wads.
+*	Manages the list of wads. Wads are loaded through the filesystem.
+*	Wads stay loaded after the map that used them is freed so the next map can reuse them without reading them again.
+*	Each map holds a reference to the wads it uses; unreferenced wads are evicted by Trim once the memory budget is exceeded.
 */
 class CWadManager final
 {
 public:
+	/**
+	*	Default amount of memory that unreferenced wads may use before they are evicted.
+	*/
+	static const size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
 	enum class AddResult
 	{
 		/**
@@ -40,6 +52,7 @@ public:
 
 private:
 	typedef std::vector<std::unique_ptr<CWadFile>> WadFiles_t;
+	typedef std::vector<std::pair<std::string, std::future<CFileData>>> PendingWads_t;
 
 public:
 	/**
@@ -52,16 +65,6 @@ public:
 	*/
 	~CWadManager();
 
-	/**
-	*	@return The base path that will be searched for wads.
-	*/
-	const char* GetBasePath() const { return m_szBasePath; }
-
-	/**
-	*	Sets the base path.
-	*/
-	void SetBasePath( const char* const pszBasePath );
-
 	/**
 	*	Finds a wad by name and returns it.
 	*	@param pszWadName Name to search for.
@@ -70,30 +73,94 @@ public:
 	const CWadFile* FindWadByName( const char* const pszWadName ) const;
 
 	/**
-	*	Finds a texture by name by searching all wads.
+	*	Finds a texture by name by searching all wads that are referenced by the current map.
 	*	@param pszTextureName Name to search for.
+	*	@param ppWad Optional. If not null, receives the wad that contains the texture.
 	*	@return Texture, or null if the texture couldn't be found.
 	*/
-	const miptex_t* FindTextureByName( const char* const pszTextureName ) const;
+	const miptex_t* FindTextureByName( const char* const pszTextureName, const CWadFile** ppWad = nullptr ) const;
 
 	/**
 	*	Adds a wad. This will load the wad and add it if it exists.
+	*	If the wad is still cached from a previous map, the cached wad is referenced instead.
 	*	@param pszWadName Name of the wad to load. This excludes the path and extension.
 	*	@return AddResult value.
 	*	@see AddResult
 	*/
 	AddResult AddWad( const char* const pszWadName );
 
+	/**
+	*	Adds a wad from data that was already loaded. If a wad with the given name is already loaded, it is used instead.
+	*	@param pszWadName Name of the wad. This excludes the path and extension.
+	*	@param data Wad file data.
+	*	@return AddResult value.
+	*	@see AddResult
+	*/
+	AddResult AddWad( const char* const pszWadName, CFileData&& data );
+
+	/**
+	*	Starts reading the given wads in the background. Wads that are already loaded or being read are skipped.
+	*	AddWad waits for the read to finish instead of reading the wad again.
+	*	@param wadNames Names of the wads to read. This excludes the path and extension.
+	*/
+	void PrefetchWads( const std::vector<std::string>& wadNames );
+
+	/**
+	*	Releases the references that the current map holds on its wads. The wads stay cached until they are trimmed.
+	*/
+	void ReleaseWads();
+
+	/**
+	*	@return The amount of memory that unreferenced wads may use.
+	*/
+	size_t GetMemoryBudget() const { return m_uiMemoryBudget; }
+
+	/**
+	*	Sets the amount of memory that unreferenced wads may use.
+	*/
+	void SetMemoryBudget( const size_t uiMemoryBudget ) { m_uiMemoryBudget = uiMemoryBudget; }
+
+	/**
+	*	@return The amount of memory used by all loaded wads.
+	*/
+	size_t GetMemoryUsage() const;
+
+	/**
+	*	Evicts unreferenced wads, least recently used first, until the memory usage fits in the budget.
+	*/
+	void Trim();
+
 	/**
 	*	Removes all wads.
 	*/
 	void Clear();
 
 private:
-	char m_szBasePath[ MAX_PATH_LENGTH ] = { '\0' };
+	/**
+	*	Builds the path to a wad, relative to the game directory.
+	*	@return Whether the path fit in the buffer.
+	*/
+	static bool GetWadPath( const char* const pszWadName, char* pszPath, const size_t uiBufferSize );
+
+	/**
+	*	Adds a reference to a wad that is already loaded.
+	*/
+	AddResult ReferenceWad( CWadFile& wad );
 
+	/**
+	*	Adds a wad that was loaded by LoadWadFile.
+	*/
+	AddResult AddLoadedWad( const char* const pszWadName, CFileData&& wadData );
+
+private:
 	WadFiles_t m_WadFiles;
 
+	PendingWads_t m_PendingWads;
+
+	size_t m_uiMemoryBudget = DEFAULT_MEMORY_BUDGET;
+
+	size_t m_uiUseCounter = 0;
+
 private:
 	CWadManager( const CWadManager& ) = delete;
 	CWadManager& operator=( const CWadManager& ) = delete;
@@ -14,46 +14,43 @@
 
 #include "common/Const.h"
 #include "utility/ByteSwap.h"
+#include "utility/CLogger.h"
+
+#include "filesystem/CFileSystem.h"
 
 #include "WadIO.h"
 
-wadinfo_t* LoadWadFile( const char* const pszFileName )
+CFileData LoadWadFile( const char* const pszFileName )
 {
 	assert( pszFileName );
 
-	FILE* pFile = fopen( pszFileName, "rb" );
+	return LoadWadFile( pszFileName, g_FileSystem.LoadFile( pszFileName ) );
+}
+
+CFileData LoadWadFile( const char* const pszFileName, CFileData&& data )
+{
+	assert( pszFileName );
 
-	if( !pFile )
+	if( !data.IsValid() )
 	{
-		printf( "LoadWadFile: Couldn't open WAD \"%s\"\n", pszFileName );
-		return nullptr;
+		g_Logger.Error( LogCategory::WAD, "LoadWadFile: Couldn't open WAD \"%s\"\n", pszFileName );
+		return CFileData();
 	}
 
-	fseek( pFile, 0, SEEK_END );
-
-	const size_t size = ftell( pFile );
-
-	fseek( pFile, 0, SEEK_SET );
+	const size_t size = data.GetSize();
 
-	wadinfo_t* pWad = reinterpret_cast<wadinfo_t*>( new byte[ size ] );
-
-	const size_t read = fread( pWad, 1, size, pFile );
-
-	fclose( pFile );
-
-	if( read != size )
+	if( size < sizeof( wadinfo_t ) )
 	{
-		printf( "LoadWadFile: Failed to read WAD file \"%s\" (expected %u, got %u)\n", pszFileName, size, read );
-		delete[] pWad;
-
-		return nullptr;
+		g_Logger.Error( LogCategory::WAD, "LoadWadFile: File \"%s\" is too small to be a WAD file\n", pszFileName );
+		return CFileData();
 	}
 
+	wadinfo_t* pWad = reinterpret_cast<wadinfo_t*>( data.GetData() );
+
 	if( strncmp( WAD2_ID, pWad->identification, 4 ) && strncmp( WAD3_ID, pWad->identification, 4 ) )
 	{
-		printf( "LoadWadFile: File \"%s\" is not a WAD2 or WAD3 file\n", pszFileName );
-		delete[] pWad;
-		return nullptr;
+		g_Logger.Error( LogCategory::WAD, "LoadWadFile: File \"%s\" is not a WAD2 or WAD3 file\n", pszFileName );
+		return CFileData();
 	}
 
 	pWad->infotableofs = LittleValue( pWad->infotableofs );
@@ -71,7 +68,7 @@ wadinfo_t* LoadWadFile( const char* const pszFileName )
 		pLump->size			= LittleValue( pLump->size );
 	}
 
-	return pWad;
+	return std::move( data );
 }
 
 void CleanupWadLumpName( const char* in, char* out, const size_t uiBufferSize )
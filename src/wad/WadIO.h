@@ -1,9 +1,24 @@
 #ifndef WAD_WADIO_H
 #define WAD_WADIO_H
 
+#include "filesystem/CFileData.h"
+
 #include "WadFile.h"
 
-wadinfo_t* LoadWadFile( const char* const pszFileName );
+/**
+*	Loads a wad file through the filesystem.
+*	@param pszFileName Name of the file to load.
+*	@return Wad data. Not valid if the wad could not be loaded.
+*/
+CFileData LoadWadFile( const char* const pszFileName );
+
+/**
+*	Loads a wad file from data that was already read from disk.
+*	@param pszFileName Name of the file the data was read from.
+*	@param data File data.
+*	@return Wad data. Not valid if the data is not a valid wad.
+*/
+CFileData LoadWadFile( const char* const pszFileName, CFileData&& data );
 
 void CleanupWadLumpName( const char* in, char* out, const size_t uiBufferSize );
 